@@ -10,18 +10,77 @@
 #define ACC_BVHTREE_HEADER
 
 #include <array>
+#include <cstdint>
 #include <deque>
+#include <tuple>
 #include <stack>
 #include <cassert>
 #include <algorithm>
-#include <atomic>
-#include <thread>
 #include <limits>
 
+#include "executor.h"
 #include "primitives.h"
 
+/* Width of the collapsed traversal nodes, the children of a node are tested
+ * against a ray or a point with one SIMD instruction per slab. */
+#if defined(_MSC_VER)
+#   include <intrin.h>
+#endif
+
+/* Translation units built with different instruction sets see a different
+ * BVHTree, each variant lives in its own inline namespace so they do not
+ * share symbols. */
+#if defined(__AVX__)
+#   include <immintrin.h>
+#   define ACC_BVH_WIDTH 8
+#   define ACC_BVH_VARIANT bvh_avx8
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#   include <emmintrin.h>
+#   define ACC_BVH_WIDTH 4
+#   define ACC_BVH_VARIANT bvh_sse4
+#else
+#   define ACC_BVH_WIDTH 4
+#   define ACC_BVH_VARIANT bvh_scalar4
+#   define ACC_BVH_SCALAR
+#endif
+
 ACC_NAMESPACE_BEGIN
 
+/* Spreads the lower 10 bits of v to every third bit. */
+inline std::uint32_t expand_bits(std::uint32_t v) {
+    v = (v * 0x00010001u) & 0xFF0000FFu;
+    v = (v * 0x00000101u) & 0x0F00F00Fu;
+    v = (v * 0x00000011u) & 0xC30C30C3u;
+    v = (v * 0x00000005u) & 0x49249249u;
+    return v;
+}
+
+/* 30 bit Morton code of a point given in [0, 1]^3. */
+template <typename Vec3fType>
+inline std::uint32_t morton_code(Vec3fType const & p) {
+    std::uint32_t code = 0;
+    for (int d = 0; d < 3; ++d) {
+        float v = std::min(std::max(p[d] * 1024.0f, 0.0f), 1023.0f);
+        code |= expand_bits(static_cast<std::uint32_t>(v)) << (2 - d);
+    }
+    return code;
+}
+
+/* Index of the lowest set bit, v must not be 0. */
+inline std::size_t first_bit(std::uint64_t v) {
+#if defined(_MSC_VER)
+    unsigned long idx;
+    _BitScanForward64(&idx, v);
+    return idx;
+#else
+    return __builtin_ctzll(v);
+#endif
+}
+
+#define NUM_BINS 64
+
+inline namespace ACC_BVH_VARIANT {
+
 template <typename IdxType, typename Vec3fType>
 class BVHTree {
 public:
@@ -58,13 +117,60 @@ private:
         AABB aabb;
     };
 
+    typedef std::array<std::array<Bin, NUM_BINS>, 3> Bins;
+
+    /* Nodes with at least PARALLEL_SPLIT triangles split their children as
+     * separate tasks, nodes with at least PARALLEL_BINNING triangles are
+     * also binned and partitioned in chunks of BINNING_CHUNK in parallel. */
+    static constexpr IdxType PARALLEL_SPLIT = 4096;
+    static constexpr IdxType PARALLEL_BINNING = 1 << 15;
+    static constexpr IdxType BINNING_CHUNK = 1 << 14;
+
     std::vector<IdxType> indices;
     std::vector<Tri> tris;
 
-    std::atomic<IdxType> num_nodes;
+    /* First order (dipole) expansion of a node's triangles for the fast
+     * winding number, see "Fast Winding Numbers for Soups and Clouds"
+     * by Barill et al. (SIGGRAPH 2018). */
+    struct Dipole {
+        /* Area weighted centroid. */
+        Vec3fType p;
+        /* Sum of area weighted normals. */
+        Vec3fType n;
+        /* Radius of the ball around p containing all triangles. */
+        float r;
+    };
+
+    static constexpr std::size_t WIDTH = ACC_BVH_WIDTH;
+
+    /* Collapsed node used for traversal, children are stored as structure
+     * of arrays. Slots below count are either an inner node (child) or a
+     * leaf holding the triangles [first, last) (child == NAI). */
+    struct alignas(32) WideNode {
+        float min[3][WIDTH];
+        float max[3][WIDTH];
+        IdxType child[WIDTH];
+        IdxType first[WIDTH];
+        IdxType last[WIDTH];
+        IdxType count;
+    };
+
+    /* Ray with the reciprocal direction precomputed for the slab tests. */
+    struct WideRay {
+        float origin[3];
+        float inv_dir[3];
+        float tmin;
+        float tmax;
+    };
+
     std::vector<Node> nodes;
-    typename Node::ID create_node(IdxType first, IdxType last) {
-        typename Node::ID node_id = num_nodes++;
+    std::vector<WideNode> wide_nodes;
+    std::vector<Dipole> dipoles;
+    /* A subtree over n triangles has at most 2n - 1 nodes, so every node
+     * reserves that many ids: the left child follows its parent and the
+     * right child follows the left subtree. The ids therefore do not
+     * depend on the order the tasks run in, compact removes the gaps. */
+    typename Node::ID create_node(typename Node::ID node_id, IdxType first, IdxType last) {
         Node & node = nodes[node_id];
         node.first = first;
         node.last = last;
@@ -75,24 +181,34 @@ private:
         return node_id;
     }
 
+    static IdxType num_chunks(IdxType first, IdxType last);
+    void compute_bins(Node const & node, std::vector<AABB> const & aabbs,
+        Executor const & executor, Bins * bins) const;
+
     std::pair<typename Node::ID, typename Node::ID> sbsplit(typename Node::ID node_id,
-        std::vector<AABB> const & aabbs);
+        std::vector<AABB> const & aabbs, Executor const & executor);
     std::pair<typename Node::ID, typename Node::ID> bsplit(typename Node::ID node_id,
-        std::vector<AABB> const & aabbs);
+        std::vector<AABB> const & aabbs, Executor const & executor);
     std::pair<typename Node::ID, typename Node::ID> ssplit(typename Node::ID node_id,
         std::vector<AABB> const & aabbs);
     void split(typename Node::ID, std::vector<AABB> const & aabbs,
-        std::atomic<int> * num_threads);
+        Executor const & executor);
+    void compact();
 
-    bool intersect(Ray const & ray, typename Node::ID node_id, Hit * hit) const;
-    Vec3fType closest_point(Vec3fType vertex, typename Node::ID node_id) const;
+    void collapse();
+    static WideRay make_wide_ray(Ray const & ray);
+    static unsigned intersect(WideNode const & node, WideRay const & ray, float * tnear);
+    static void distance2(WideNode const & node, Vec3fType const & vertex, float * dist);
+
+    bool intersect(Ray const & ray, IdxType first, IdxType last, Hit * hit) const;
+    Vec3fType closest_point(Vec3fType vertex, IdxType first, IdxType last) const;
 
 public:
     static
     Ptr create(std::vector<IdxType> const & faces,
         std::vector<Vec3fType> const & vertices,
-        int max_threads = std::thread::hardware_concurrency()) {
-        return Ptr(new BVHTree(faces, vertices, max_threads));
+        Executor const & executor = SerialExecutor()) {
+        return Ptr(new BVHTree(faces, vertices, executor));
     }
 
     template <class C>
@@ -104,54 +220,118 @@ public:
      * by Ingo Wald (IEEE Symposium on Interactive Ray Tracing 2007)
      *
      * The mesh should be given as triangle index list and
-     * a vector containing the 3D positions. */
+     * a vector containing the 3D positions. The parallel parts of the
+     * build run on executor, the resulting tree does not depend on it. */
     BVHTree(std::vector<IdxType> const & faces,
         std::vector<Vec3fType> const & vertices,
-        int max_threads = std::thread::hardware_concurrency());
+        Executor const & executor = SerialExecutor());
 
     bool intersect(Ray ray, Hit * hit_ptr = nullptr) const;
     Vec3fType closest_point(Vec3fType vertex, float max_dist = inf) const;
+
+    /* Intersects a packet of rays, hits[i].t is inf for rays without a hit.
+     * Every node is fetched once for the whole packet, which pays off for
+     * coherent rays like the ones shot from a common origin.
+     * Returns the number of rays that hit. */
+    std::size_t intersect(Ray const * rays, std::size_t num_rays, Hit * hits) const;
+
+    /* Precomputes the per node expansions used by winding_number,
+     * has to be called once before querying. */
+    void build_winding_data();
+
+    /* Generalized winding number of the mesh at vertex, close to +-1 inside
+     * and 0 outside (the sign follows the triangle orientation). Nodes
+     * further away than beta times their radius are approximated by their
+     * dipole, everything else is evaluated exactly per triangle. */
+    float winding_number(Vec3fType vertex, float beta = 2.0f) const;
 };
 
 
-#define NUM_BINS 64
 template <typename IdxType, typename Vec3fType>
 void BVHTree<IdxType, Vec3fType>::split(typename Node::ID node,
         std::vector<AABB> const & aabbs,
-        std::atomic<int> * num_threads) {
+        Executor const & executor) {
 
     typename Node::ID left, right;
-    if ((*num_threads -= 1) >= 1) {
-        std::tie(left, right) = sbsplit(node, aabbs);
+    std::tie(left, right) = sbsplit(node, aabbs, executor);
+    if (left == NAI || right == NAI) return;
+
+    /* Large subtrees are split as tasks, small ones on this thread. */
+    if (nodes[node].last - nodes[node].first >= PARALLEL_SPLIT) {
+        executor.run(2, [&] (std::size_t i) {
+            split(i == 0 ? left : right, aabbs, executor);
+        });
+        return;
+    }
+
+    std::deque<typename Node::ID> queue;
+    queue.push_back(left);
+    queue.push_back(right);
+    while (!queue.empty()) {
+        typename Node::ID node = queue.back(); queue.pop_back();
+        std::tie(left, right) = sbsplit(node, aabbs, executor);
         if (left != NAI && right != NAI) {
-            //std::thread other(&BVHTree::split, this, left, std::cref(aabbs), num_threads);
-            std::thread other(&BVHTree::split, this, left, aabbs, num_threads);
-            split(right, aabbs, num_threads);
-            other.join();
+            queue.push_back(left);
+            queue.push_back(right);
         }
-    } else {
-        std::deque<typename Node::ID> queue;
-        queue.push_back(node);
-        while (!queue.empty()) {
-            typename Node::ID node = queue.back(); queue.pop_back();
-            std::tie(left, right) = sbsplit(node, aabbs);
-            if (left != NAI && right != NAI) {
-                queue.push_back(left);
-                queue.push_back(right);
+    }
+}
+
+template <typename IdxType, typename Vec3fType> IdxType
+BVHTree<IdxType, Vec3fType>::num_chunks(IdxType first, IdxType last) {
+    IdxType n = last - first;
+    return n < PARALLEL_BINNING ? 1 : (n + BINNING_CHUNK - 1) / BINNING_CHUNK;
+}
+
+/* Bins the triangles of node along all three axes. */
+template <typename IdxType, typename Vec3fType> void
+BVHTree<IdxType, Vec3fType>::compute_bins(Node const & node,
+        std::vector<AABB> const & aabbs, Executor const & executor, Bins * bins) const {
+
+    IdxType chunks = num_chunks(node.first, node.last);
+    std::vector<Bins> chunk_bins(chunks);
+    executor.run(chunks, [&] (std::size_t c) {
+        Bins & local = chunk_bins[c];
+        for (auto & dim : local) {
+            for (Bin & bin : dim) {
+                bin = {0, {Vec3fType(inf), Vec3fType(-inf)}};
+            }
+        }
+
+        IdxType first = node.first + c * BINNING_CHUNK;
+        IdxType last = chunks == 1 ? node.last : std::min<IdxType>(first + BINNING_CHUNK, node.last);
+        for (std::size_t i = first; i < last; ++i) {
+            AABB const & aabb = aabbs[indices[i]];
+            for (char d = 0; d < 3; ++d) {
+                float min = node.aabb.min[d];
+                float max = node.aabb.max[d];
+                char idx = ((mid(aabb, d) - min) / (max - min)) * (NUM_BINS - 1);
+                local[d][idx].aabb += aabb;
+                local[d][idx].n += 1;
+            }
+        }
+    });
+
+    /* Counts and bounds are exact, the result does not depend on the chunking. */
+    *bins = chunk_bins[0];
+    for (std::size_t c = 1; c < chunks; ++c) {
+        for (int d = 0; d < 3; ++d) {
+            for (std::size_t idx = 0; idx < NUM_BINS; ++idx) {
+                (*bins)[d][idx].n += chunk_bins[c][d][idx].n;
+                (*bins)[d][idx].aabb += chunk_bins[c][d][idx].aabb;
             }
         }
     }
-    *num_threads += 1;
 }
 
 template <typename IdxType, typename Vec3fType>
 std::pair<typename BVHTree<IdxType, Vec3fType>::Node::ID, typename BVHTree<IdxType, Vec3fType>::Node::ID>
 BVHTree<IdxType, Vec3fType>::sbsplit(typename Node::ID node_id,
-        std::vector<AABB> const & aabbs) {
+        std::vector<AABB> const & aabbs, Executor const & executor) {
     Node const & node = nodes[node_id];
     IdxType n = node.last - node.first;
     if (n > NUM_BINS) {
-        return bsplit(node_id, aabbs);
+        return bsplit(node_id, aabbs, executor);
     } else {
         return ssplit(node_id, aabbs);
     }
@@ -160,29 +340,20 @@ BVHTree<IdxType, Vec3fType>::sbsplit(typename Node::ID node_id,
 template <typename IdxType, typename Vec3fType>
 std::pair<typename BVHTree<IdxType, Vec3fType>::Node::ID, typename BVHTree<IdxType, Vec3fType>::Node::ID>
 BVHTree<IdxType, Vec3fType>::bsplit(typename Node::ID node_id,
-        std::vector<AABB> const & aabbs) {
+        std::vector<AABB> const & aabbs, Executor const & executor) {
     Node & node = nodes[node_id];
     IdxType n = node.last - node.first;
 
-    std::array<Bin, NUM_BINS> bins;
+    Bins all_bins;
+    compute_bins(node, aabbs, executor, &all_bins);
+
     std::array<AABB, NUM_BINS> right_aabbs;
-    std::vector<IdxType> bin(n);
+    std::vector<char> bin(n);
 
     float min_cost = inf;
     std::pair<IdxType, char> split;
     for (char d = 0; d < 3; ++d) {
-        float min = node.aabb.min[d];
-        float max = node.aabb.max[d];
-        for (Bin & bin : bins) {
-            bin = {0, {Vec3fType(inf), Vec3fType(-inf)}};
-        }
-        for (std::size_t i = node.first; i < node.last; ++i) {
-            AABB const & aabb = aabbs[indices[i]];
-            char idx = ((mid(aabb, d) - min) / (max - min)) * (NUM_BINS - 1);
-            bins[idx].aabb += aabb;
-            bins[idx].n += 1;
-            bin[i - node.first] = idx;
-        }
+        std::array<Bin, NUM_BINS> const & bins = all_bins[d];
 
         right_aabbs[NUM_BINS - 1] = bins[NUM_BINS - 1].aabb;
         for (std::size_t i = NUM_BINS - 1; i > 0; --i) {
@@ -211,18 +382,18 @@ BVHTree<IdxType, Vec3fType>::bsplit(typename Node::ID node_id,
     IdxType sidx;
     std::tie(d, sidx) = split;
 
+    std::array<Bin, NUM_BINS> const & bins = all_bins[d];
     float min = node.aabb.min[d];
     float max = node.aabb.max[d];
-    for (Bin & bin : bins) {
-        bin = {0, {Vec3fType(inf), Vec3fType(-inf)}};
-    }
-    for (std::size_t i = node.first; i < node.last; ++i) {
-        AABB const & aabb = aabbs[indices[i]];
-        char idx = ((mid(aabb, d) - min) / (max - min)) * (NUM_BINS - 1);
-        bins[idx].aabb += aabb;
-        bins[idx].n += 1;
-        bin[i - node.first] = idx;
-    }
+    IdxType chunks = num_chunks(node.first, node.last);
+    executor.run(chunks, [&] (std::size_t c) {
+        IdxType first = node.first + c * BINNING_CHUNK;
+        IdxType last = chunks == 1 ? node.last : std::min<IdxType>(first + BINNING_CHUNK, node.last);
+        for (std::size_t i = first; i < last; ++i) {
+            AABB const & aabb = aabbs[indices[i]];
+            bin[i - node.first] = ((mid(aabb, d) - min) / (max - min)) * (NUM_BINS - 1);
+        }
+    });
 
     IdxType l = node.first;
     IdxType r = node.last - 1;
@@ -240,9 +411,10 @@ BVHTree<IdxType, Vec3fType>::bsplit(typename Node::ID node_id,
     }
     assert(l == r);
     std::size_t m = bin[(l&r) - node.first] >= sidx ? (l&r) : (l&r) + 1;
+    if (m == node.first || m == node.last) return std::make_pair(NAI, NAI);
 
-    node.left = create_node(node.first, m);
-    node.right = create_node(m, node.last);
+    node.left = create_node(node_id + 1, node.first, m);
+    node.right = create_node(node_id + 2 * (m - node.first), m, node.last);
     for (std::size_t idx = 0; idx < NUM_BINS; ++idx) {
         if (idx < sidx) {
             nodes[node.left].aabb += bins[idx].aabb;
@@ -307,53 +479,272 @@ BVHTree<IdxType, Vec3fType>::ssplit(typename Node::ID node_id, std::vector<AABB>
         }
     );
 
-    node.left = create_node(node.first, i);
-    node.right = create_node(i, node.last);
+    node.left = create_node(node_id + 1, node.first, i);
+    node.right = create_node(node_id + 2 * (i - node.first), i, node.last);
     return std::make_pair(node.left, node.right);
 }
 
 template <typename IdxType, typename Vec3fType>
 BVHTree<IdxType, Vec3fType>::BVHTree(std::vector<IdxType> const & faces,
-    std::vector<Vec3fType> const & vertices, int max_threads) : num_nodes(0) {
+    std::vector<Vec3fType> const & vertices, Executor const & executor) {
 
     std::size_t num_faces = faces.size() / 3;
-    std::vector<AABB> aabbs(num_faces);
+    std::vector<AABB> face_aabbs(num_faces);
     std::vector<Tri> ttris(num_faces);
 
-    /* Initialize vector with upper bound of nodes. */
-    nodes.resize(2 * num_faces - 1);
-
-    /* Initialize root node. */
-    Node & root = nodes[create_node(0, num_faces)];
-    for (std::size_t i = 0; i < aabbs.size(); ++i) {
+    AABB bounds = {Vec3fType(inf), Vec3fType(-inf)};
+    for (std::size_t i = 0; i < num_faces; ++i) {
         ttris[i].a = vertices[faces[i * 3 + 0]];
         ttris[i].b = vertices[faces[i * 3 + 1]];
         ttris[i].c = vertices[faces[i * 3 + 2]];
 
-        calculate_aabb(ttris[i], &aabbs[i]);
-        root.aabb += aabbs[i];
+        calculate_aabb(ttris[i], &face_aabbs[i]);
+        bounds += face_aabbs[i];
     }
-    indices.resize(aabbs.size());
-    for (std::size_t i = 0; i < indices.size(); ++i) {
+
+    /* Sort the triangles along a Morton curve of their centroids, so the
+     * ranges touched while binning are close in memory. Ties keep the
+     * face order, which keeps the build deterministic. */
+    Vec3fType extent = bounds.max - bounds.min;
+    std::vector<std::pair<std::uint32_t, IdxType> > order(num_faces);
+    for (std::size_t i = 0; i < num_faces; ++i) {
+        Vec3fType center = (face_aabbs[i].min + face_aabbs[i].max) * 0.5f;
+        Vec3fType p;
+        for (int d = 0; d < 3; ++d) {
+            p[d] = extent[d] > 0.0f ? (center[d] - bounds.min[d]) / extent[d] : 0.0f;
+        }
+        order[i] = std::make_pair(morton_code(p), IdxType(i));
+    }
+    std::sort(order.begin(), order.end());
+
+    std::vector<AABB> aabbs(num_faces);
+    indices.resize(num_faces);
+    for (std::size_t i = 0; i < num_faces; ++i) {
+        aabbs[i] = face_aabbs[order[i].second];
         indices[i] = i;
     }
 
-    std::atomic<int> num_threads(max_threads);
-    split(0, aabbs, &num_threads);
+    /* Initialize vector with upper bound of nodes. */
+    nodes.resize(2 * num_faces - 1);
+
+    /* Initialize root node. */
+    Node & root = nodes[create_node(0, 0, num_faces)];
+    root.aabb = bounds;
+
+    split(0, aabbs, executor);
 
     tris.resize(ttris.size());
     for (std::size_t i = 0; i < indices.size(); ++i) {
+        indices[i] = order[indices[i]].second;
         tris[i] = ttris[indices[i]];
     }
 
-    nodes.resize(num_nodes);
+    compact();
+    collapse();
+}
+
+/* Renumbers the nodes depth first, removing the ids left unused by
+ * create_node. Children still come after their parent. */
+template <typename IdxType, typename Vec3fType> void
+BVHTree<IdxType, Vec3fType>::compact() {
+    std::vector<Node> compacted;
+    compacted.reserve(nodes.size());
+
+    /* Old id, new id of the parent and whether it is the right child. */
+    std::stack<std::tuple<typename Node::ID, typename Node::ID, bool> > s;
+    s.emplace(0, NAI, false);
+    while (!s.empty()) {
+        typename Node::ID node_id, parent;
+        bool right;
+        std::tie(node_id, parent, right) = s.top(); s.pop();
+
+        typename Node::ID new_id = compacted.size();
+        compacted.push_back(nodes[node_id]);
+        if (parent != NAI) {
+            (right ? compacted[parent].right : compacted[parent].left) = new_id;
+        }
+
+        Node const & node = nodes[node_id];
+        if (node.left != NAI && node.right != NAI) {
+            s.emplace(node.right, new_id, true);
+            s.emplace(node.left, new_id, false);
+        }
+    }
+    nodes.swap(compacted);
+}
+
+/* Collapses the binary tree into WIDTH wide nodes by repeatedly opening
+ * the inner child with the largest surface area, see
+ * "Shallow Bounding Volume Hierarchies for Fast SIMD Ray Tracing of
+ * Incoherent Rays" by Dammertz et al. (EGSR 2008) */
+template <typename IdxType, typename Vec3fType> void
+BVHTree<IdxType, Vec3fType>::collapse() {
+    wide_nodes.clear();
+    wide_nodes.reserve(nodes.size() / (WIDTH / 2) + 1);
+
+    std::vector<std::pair<typename Node::ID, IdxType> > queue;
+    wide_nodes.emplace_back();
+    queue.emplace_back(0, 0);
+    while (!queue.empty()) {
+        typename Node::ID node_id;
+        IdxType wide_id;
+        std::tie(node_id, wide_id) = queue.back(); queue.pop_back();
+
+        std::array<typename Node::ID, WIDTH> children;
+        std::size_t count = 0;
+        Node const & node = nodes[node_id];
+        if (node.left != NAI && node.right != NAI) {
+            children[count++] = node.left;
+            children[count++] = node.right;
+        } else {
+            children[count++] = node_id;
+        }
+
+        while (count < WIDTH) {
+            std::size_t best = count;
+            float best_area = -inf;
+            for (std::size_t i = 0; i < count; ++i) {
+                Node const & child = nodes[children[i]];
+                if (child.left == NAI || child.right == NAI) continue;
+                float area = surface_area(child.aabb);
+                if (area > best_area) {
+                    best_area = area;
+                    best = i;
+                }
+            }
+            if (best == count) break;
+
+            Node const & child = nodes[children[best]];
+            children[best] = child.left;
+            children[count++] = child.right;
+        }
+
+        WideNode wide;
+        wide.count = count;
+        for (std::size_t i = 0; i < WIDTH; ++i) {
+            for (int d = 0; d < 3; ++d) {
+                wide.min[d][i] = i < count ? nodes[children[i]].aabb.min[d] : inf;
+                wide.max[d][i] = i < count ? nodes[children[i]].aabb.max[d] : -inf;
+            }
+            wide.child[i] = NAI;
+            wide.first[i] = 0;
+            wide.last[i] = 0;
+            if (i >= count) continue;
+
+            Node const & child = nodes[children[i]];
+            if (child.left != NAI && child.right != NAI) {
+                wide.child[i] = wide_nodes.size();
+                wide_nodes.emplace_back();
+                queue.emplace_back(children[i], wide.child[i]);
+            } else {
+                wide.first[i] = child.first;
+                wide.last[i] = child.last;
+            }
+        }
+        wide_nodes[wide_id] = wide;
+    }
+}
+
+template <typename IdxType, typename Vec3fType>
+typename BVHTree<IdxType, Vec3fType>::WideRay
+BVHTree<IdxType, Vec3fType>::make_wide_ray(Ray const & ray) {
+    WideRay wide_ray;
+    for (int d = 0; d < 3; ++d) {
+        wide_ray.origin[d] = ray.origin[d];
+        wide_ray.inv_dir[d] = 1.0f / ray.dir[d];
+    }
+    wide_ray.tmin = std::max(ray.tmin, 0.0f);
+    wide_ray.tmax = ray.tmax;
+    return wide_ray;
+}
+
+/* Slab test of all children against the ray, returns a bit mask of the
+ * hit children and writes their entry distances to tnear. NaNs produced
+ * by rays parallel to a slab are ignored like in the scalar test. */
+template <typename IdxType, typename Vec3fType> unsigned
+BVHTree<IdxType, Vec3fType>::intersect(WideNode const & node, WideRay const & ray, float * tnear) {
+    unsigned mask;
+#if defined(ACC_BVH_SCALAR)
+    mask = 0;
+    for (std::size_t i = 0; i < WIDTH; ++i) {
+        float tmin = ray.tmin, tmax = ray.tmax;
+        for (int d = 0; d < 3; ++d) {
+            float t1 = (node.min[d][i] - ray.origin[d]) * ray.inv_dir[d];
+            float t2 = (node.max[d][i] - ray.origin[d]) * ray.inv_dir[d];
+            tmin = std::max(tmin, std::min(std::min(t1, t2), inf));
+            tmax = std::min(tmax, std::max(std::max(t1, t2), -inf));
+        }
+        tnear[i] = tmin;
+        mask |= (tmin <= tmax) << i;
+    }
+#elif ACC_BVH_WIDTH == 8
+    __m256 tmin = _mm256_set1_ps(ray.tmin);
+    __m256 tmax = _mm256_set1_ps(ray.tmax);
+    for (int d = 0; d < 3; ++d) {
+        __m256 origin = _mm256_set1_ps(ray.origin[d]);
+        __m256 inv_dir = _mm256_set1_ps(ray.inv_dir[d]);
+        __m256 t1 = _mm256_mul_ps(_mm256_sub_ps(_mm256_load_ps(node.min[d]), origin), inv_dir);
+        __m256 t2 = _mm256_mul_ps(_mm256_sub_ps(_mm256_load_ps(node.max[d]), origin), inv_dir);
+        /* min/max return the second operand if either is NaN. */
+        tmin = _mm256_max_ps(_mm256_min_ps(t1, t2), tmin);
+        tmax = _mm256_min_ps(_mm256_max_ps(t1, t2), tmax);
+    }
+    _mm256_storeu_ps(tnear, tmin);
+    mask = _mm256_movemask_ps(_mm256_cmp_ps(tmin, tmax, _CMP_LE_OQ));
+#else
+    __m128 tmin = _mm_set1_ps(ray.tmin);
+    __m128 tmax = _mm_set1_ps(ray.tmax);
+    for (int d = 0; d < 3; ++d) {
+        __m128 origin = _mm_set1_ps(ray.origin[d]);
+        __m128 inv_dir = _mm_set1_ps(ray.inv_dir[d]);
+        __m128 t1 = _mm_mul_ps(_mm_sub_ps(_mm_load_ps(node.min[d]), origin), inv_dir);
+        __m128 t2 = _mm_mul_ps(_mm_sub_ps(_mm_load_ps(node.max[d]), origin), inv_dir);
+        /* min/max return the second operand if either is NaN. */
+        tmin = _mm_max_ps(_mm_min_ps(t1, t2), tmin);
+        tmax = _mm_min_ps(_mm_max_ps(t1, t2), tmax);
+    }
+    _mm_storeu_ps(tnear, tmin);
+    mask = _mm_movemask_ps(_mm_cmple_ps(tmin, tmax));
+#endif
+    return mask & ((1u << node.count) - 1u);
+}
+
+/* Squared distances from vertex to the boxes of all children. */
+template <typename IdxType, typename Vec3fType> void
+BVHTree<IdxType, Vec3fType>::distance2(WideNode const & node, Vec3fType const & vertex, float * dist) {
+#if defined(ACC_BVH_SCALAR)
+    for (std::size_t i = 0; i < WIDTH; ++i) {
+        dist[i] = 0.0f;
+        for (int d = 0; d < 3; ++d) {
+            float delta = std::max(std::max(node.min[d][i] - vertex[d], vertex[d] - node.max[d][i]), 0.0f);
+            dist[i] += delta * delta;
+        }
+    }
+#elif ACC_BVH_WIDTH == 8
+    __m256 sum = _mm256_setzero_ps();
+    for (int d = 0; d < 3; ++d) {
+        __m256 v = _mm256_set1_ps(vertex[d]);
+        __m256 delta = _mm256_max_ps(_mm256_max_ps(_mm256_sub_ps(_mm256_load_ps(node.min[d]), v),
+            _mm256_sub_ps(v, _mm256_load_ps(node.max[d]))), _mm256_setzero_ps());
+        sum = _mm256_add_ps(sum, _mm256_mul_ps(delta, delta));
+    }
+    _mm256_storeu_ps(dist, sum);
+#else
+    __m128 sum = _mm_setzero_ps();
+    for (int d = 0; d < 3; ++d) {
+        __m128 v = _mm_set1_ps(vertex[d]);
+        __m128 delta = _mm_max_ps(_mm_max_ps(_mm_sub_ps(_mm_load_ps(node.min[d]), v),
+            _mm_sub_ps(v, _mm_load_ps(node.max[d]))), _mm_setzero_ps());
+        sum = _mm_add_ps(sum, _mm_mul_ps(delta, delta));
+    }
+    _mm_storeu_ps(dist, sum);
+#endif
 }
 
 template <typename IdxType, typename Vec3fType> bool
-BVHTree<IdxType, Vec3fType>::intersect(Ray const & ray, typename Node::ID node_id, Hit * hit) const {
-    Node const & node = nodes[node_id];
+BVHTree<IdxType, Vec3fType>::intersect(Ray const & ray, IdxType first, IdxType last, Hit * hit) const {
     bool ret = false;
-    for (std::size_t i = node.first; i < node.last; ++i) {
+    for (std::size_t i = first; i < last; ++i) {
         float t;
         Vec3fType bcoords;
         if (acc::intersect(ray, tris[i], &t, &bcoords)) {
@@ -372,38 +763,42 @@ BVHTree<IdxType, Vec3fType>::intersect(Ray ray, Hit * hit_ptr) const {
     Hit hit;
     hit.t = inf;
 
-    typename Node::ID node_id = 0;
-    std::stack<typename Node::ID> s;
-    while (true) {
-        Node const & node = nodes[node_id];
-        if (node.left != NAI && node.right != NAI) {
-            float tmin_left, tmin_right;
-            bool left = acc::intersect(ray, nodes[node.left].aabb, &tmin_left);
-            bool right = acc::intersect(ray, nodes[node.right].aabb, &tmin_right);
-            if (left && right) {
-                if (tmin_left < tmin_right) {
-                    s.push(node.right);
-                    node_id = node.left;
-                } else {
-                    s.push(node.left);
-                    node_id = node.right;
-                }
-            } else {
-                if (right) node_id = node.right;
-                if (left) node_id = node.left;
-            }
+    WideRay wide_ray = make_wide_ray(ray);
 
-            if (!left && !right) {
-                if (s.empty()) break;
-                node_id = s.top(); s.pop();
+    /* Entries keep their entry distance, so nodes behind a closer hit
+     * found in the meantime are skipped when popped. */
+    std::stack<std::pair<float, IdxType> > s;
+    s.emplace(wide_ray.tmin, 0);
+    while (!s.empty()) {
+        float t;
+        IdxType wide_id;
+        std::tie(t, wide_id) = s.top(); s.pop();
+        if (t > wide_ray.tmax) continue;
+
+        WideNode const & node = wide_nodes[wide_id];
+        alignas(32) float tnear[WIDTH];
+        unsigned mask = intersect(node, wide_ray, tnear);
+
+        /* Push far to near, the nearest inner child is popped first. */
+        std::array<std::size_t, WIDTH> order;
+        std::size_t num_inner = 0;
+        for (std::size_t i = 0; i < WIDTH; ++i) {
+            if (!(mask & (1u << i))) continue;
+            if (node.child[i] == NAI) {
+                if (intersect(ray, node.first[i], node.last[i], &hit)) {
+                    ray.tmax = hit.t;
+                    wide_ray.tmax = hit.t;
+                }
+                continue;
             }
-        } else {
-            if (intersect(ray, node_id, &hit)) {
-                ray.tmax = hit.t;
+            std::size_t j = num_inner++;
+            for (; j > 0 && tnear[order[j - 1]] < tnear[i]; --j) {
+                order[j] = order[j - 1];
             }
-
-            if (s.empty()) break;
-            node_id = s.top(); s.pop();
+            order[j] = i;
+        }
+        for (std::size_t j = 0; j < num_inner; ++j) {
+            s.emplace(tnear[order[j]], node.child[order[j]]);
         }
     }
 
@@ -417,17 +812,88 @@ BVHTree<IdxType, Vec3fType>::intersect(Ray ray, Hit * hit_ptr) const {
     }
 }
 
-template <typename IdxType, typename Vec3fType> Vec3fType
-BVHTree<IdxType, Vec3fType>::closest_point(Vec3fType vertex, typename Node::ID node_id) const {
-    Node const & node = nodes[node_id];
+template <typename IdxType, typename Vec3fType> std::size_t
+BVHTree<IdxType, Vec3fType>::intersect(Ray const * rays, std::size_t num_rays, Hit * hits) const {
+    constexpr std::size_t PACKET_SIZE = 64;
+
+    std::size_t num_hits = 0;
+    for (std::size_t offset = 0; offset < num_rays; offset += PACKET_SIZE) {
+        std::size_t n = std::min(PACKET_SIZE, num_rays - offset);
+
+        std::array<Ray, PACKET_SIZE> packet;
+        std::array<WideRay, PACKET_SIZE> wide_rays;
+        for (std::size_t r = 0; r < n; ++r) {
+            packet[r] = rays[offset + r];
+            wide_rays[r] = make_wide_ray(packet[r]);
+            hits[offset + r].t = inf;
+        }
+
+        /* Every entry carries the rays that hit its box, the others
+         * are not tested again further down. */
+        std::stack<std::pair<IdxType, std::uint64_t> > s;
+        s.emplace(0, n == PACKET_SIZE ? ~std::uint64_t(0) : (std::uint64_t(1) << n) - 1);
+        while (!s.empty()) {
+            IdxType wide_id = s.top().first;
+            std::uint64_t active = s.top().second;
+            s.pop();
+
+            WideNode const & node = wide_nodes[wide_id];
+            std::array<std::uint64_t, WIDTH> child_active = {};
+            std::array<float, WIDTH> child_tnear;
+            child_tnear.fill(inf);
+            for (; active != 0; active &= active - 1) {
+                std::size_t r = first_bit(active);
+                alignas(32) float tnear[WIDTH];
+                for (unsigned mask = intersect(node, wide_rays[r], tnear); mask != 0; mask &= mask - 1) {
+                    std::size_t i = first_bit(mask);
+                    child_active[i] |= std::uint64_t(1) << r;
+                    child_tnear[i] = std::min(child_tnear[i], tnear[i]);
+                }
+            }
+
+            /* Leaves are intersected right away, inner children are
+             * pushed far to near by the closest entry of any ray. */
+            std::array<std::size_t, WIDTH> order;
+            std::size_t num_inner = 0;
+            for (std::size_t i = 0; i < WIDTH; ++i) {
+                if (child_active[i] == 0) continue;
+                if (node.child[i] == NAI) {
+                    for (std::uint64_t rays = child_active[i]; rays != 0; rays &= rays - 1) {
+                        std::size_t r = first_bit(rays);
+                        Hit & hit = hits[offset + r];
+                        if (intersect(packet[r], node.first[i], node.last[i], &hit)) {
+                            packet[r].tmax = hit.t;
+                            wide_rays[r].tmax = hit.t;
+                        }
+                    }
+                    continue;
+                }
+                std::size_t j = num_inner++;
+                for (; j > 0 && child_tnear[order[j - 1]] < child_tnear[i]; --j) {
+                    order[j] = order[j - 1];
+                }
+                order[j] = i;
+            }
+            for (std::size_t j = 0; j < num_inner; ++j) {
+                s.emplace(node.child[order[j]], child_active[order[j]]);
+            }
+        }
 
+        for (std::size_t r = 0; r < n; ++r) {
+            num_hits += hits[offset + r].t < inf;
+        }
+    }
+    return num_hits;
+}
+
+template <typename IdxType, typename Vec3fType> Vec3fType
+BVHTree<IdxType, Vec3fType>::closest_point(Vec3fType vertex, IdxType first, IdxType last) const {
     Vec3fType closest;
     float dist = inf;
 
-    for (std::size_t i = node.first; i < node.last; ++i) {
+    for (std::size_t i = first; i < last; ++i) {
         Vec3fType closest_tri = acc::closest_point(vertex, tris[i]);
-		float     dist_tri    = glm::length2(closest_tri - vertex);
-		//.square_norm();
+        float dist_tri = glm::length2(closest_tri - vertex);
         if (dist_tri < dist) {
             closest = closest_tri;
             dist = dist_tri;
@@ -443,51 +909,144 @@ BVHTree<IdxType, Vec3fType>::closest_point(Vec3fType vertex, float max_dist) con
     float dist = max_dist * max_dist;
     Vec3fType closest;
 
-    typename Node::ID node_id = 0;
-    std::stack<typename Node::ID> s;
-    while (true) {
-        Node const & node = nodes[node_id];
-        if (node.left != NAI && node.right != NAI) {
-            Vec3fType closest_left = acc::closest_point(vertex, nodes[node.left].aabb);
-            Vec3fType closest_right = acc::closest_point(vertex, nodes[node.right].aabb);
-			float     dmin_left     = glm::length2(closest_left - vertex);
-			float dmin_right = glm::length2(closest_right - vertex);//.square_norm();
-            bool left = dmin_left < dist;
-            bool right = dmin_right < dist;
-            if (left && right) {
-                if (dmin_left < dmin_right) {
-                    s.push(node.right);
-                    node_id = node.left;
-                } else {
-                    s.push(node.left);
-                    node_id = node.right;
+    std::stack<std::pair<float, IdxType> > s;
+    s.emplace(0.0f, 0);
+    while (!s.empty()) {
+        float dmin;
+        IdxType wide_id;
+        std::tie(dmin, wide_id) = s.top(); s.pop();
+        if (dmin >= dist) continue;
+
+        WideNode const & node = wide_nodes[wide_id];
+        alignas(32) float dists[WIDTH];
+        distance2(node, vertex, dists);
+
+        /* Leaves are evaluated right away to shrink dist,
+         * inner children are pushed far to near. */
+        std::array<std::size_t, WIDTH> order;
+        std::size_t num_inner = 0;
+        for (std::size_t i = 0; i < node.count; ++i) {
+            if (dists[i] >= dist) continue;
+            if (node.child[i] == NAI) {
+                Vec3fType closest_leaf = closest_point(vertex, node.first[i], node.last[i]);
+                float dist_leaf = glm::length2(closest_leaf - vertex);
+                if (dist_leaf < dist) {
+                    dist = dist_leaf;
+                    closest = closest_leaf;
                 }
-            } else {
-                if (right) node_id = node.right;
-                if (left) node_id = node.left;
+                continue;
             }
-
-            if (!left && !right) {
-                if (s.empty()) break;
-                node_id = s.top(); s.pop();
+            std::size_t j = num_inner++;
+            for (; j > 0 && dists[order[j - 1]] < dists[i]; --j) {
+                order[j] = order[j - 1];
             }
+            order[j] = i;
+        }
+        for (std::size_t j = 0; j < num_inner; ++j) {
+            s.emplace(dists[order[j]], node.child[order[j]]);
+        }
+    }
+
+    return closest;
+}
+
+template <typename IdxType, typename Vec3fType> void
+BVHTree<IdxType, Vec3fType>::build_winding_data() {
+    dipoles.resize(nodes.size());
+
+    /* Children are always created after their parent,
+     * so walking the ids backwards visits them first. */
+    for (std::size_t i = nodes.size(); i-- > 0;) {
+        Node const & node = nodes[i];
+        Dipole & dipole = dipoles[i];
+        Vec3fType center = (node.aabb.min + node.aabb.max) * 0.5f;
+
+        if (node.left != NAI && node.right != NAI) {
+            Dipole const & left = dipoles[node.left];
+            Dipole const & right = dipoles[node.right];
+            float area_left = glm::length(left.n);
+            float area_right = glm::length(right.n);
+            float area = area_left + area_right;
+
+            dipole.n = left.n + right.n;
+            dipole.p = area > 0.0f
+                ? (left.p * area_left + right.p * area_right) / area : center;
+            dipole.r = std::max(glm::length(left.p - dipole.p) + left.r,
+                glm::length(right.p - dipole.p) + right.r);
         } else {
-            Vec3fType closest_leaf = closest_point(vertex, node_id);
-			float     dist_leaf    = glm::length2(closest_leaf - vertex);
-			//.square_norm();
-            if (dist_leaf < dist) {
-                dist = dist_leaf;
-                closest = closest_leaf;
+            Vec3fType p(0.0f);
+            Vec3fType n(0.0f);
+            float area = 0.0f;
+            for (std::size_t j = node.first; j < node.last; ++j) {
+                Tri const & tri = tris[j];
+                Vec3fType tri_n = glm::cross(tri.b - tri.a, tri.c - tri.a) * 0.5f;
+                float tri_area = glm::length(tri_n);
+                p += (tri.a + tri.b + tri.c) * (tri_area / 3.0f);
+                n += tri_n;
+                area += tri_area;
             }
 
-            if (s.empty()) break;
-            node_id = s.top(); s.pop();
+            dipole.n = n;
+            dipole.p = area > 0.0f ? p / area : center;
+            dipole.r = 0.0f;
+            for (std::size_t j = node.first; j < node.last; ++j) {
+                Tri const & tri = tris[j];
+                dipole.r = std::max(dipole.r, std::max(glm::length(tri.a - dipole.p),
+                    std::max(glm::length(tri.b - dipole.p), glm::length(tri.c - dipole.p))));
+            }
         }
     }
+}
 
-    return closest;
+template <typename IdxType, typename Vec3fType> float
+BVHTree<IdxType, Vec3fType>::winding_number(Vec3fType vertex, float beta) const {
+    assert(dipoles.size() == nodes.size());
+
+    /* Solid angle of a triangle as seen from vertex (Van Oosterom and Strackee). */
+    auto solid_angle = [&vertex] (Tri const & tri) -> float {
+        Vec3fType a = tri.a - vertex;
+        Vec3fType b = tri.b - vertex;
+        Vec3fType c = tri.c - vertex;
+        float la = glm::length(a);
+        float lb = glm::length(b);
+        float lc = glm::length(c);
+        float numerator = glm::dot(a, glm::cross(b, c));
+        float denominator = la * lb * lc + glm::dot(a, b) * lc
+            + glm::dot(b, c) * la + glm::dot(c, a) * lb;
+        return 2.0f * std::atan2(numerator, denominator);
+    };
+
+    float omega = 0.0f;
+
+    typename Node::ID node_id = 0;
+    std::stack<typename Node::ID> s;
+    while (true) {
+        Node const & node = nodes[node_id];
+        Dipole const & dipole = dipoles[node_id];
+        Vec3fType d = dipole.p - vertex;
+        float dist = glm::length(d);
+
+        if (dist > beta * dipole.r) {
+            omega += glm::dot(d, dipole.n) / (dist * dist * dist);
+        } else if (node.left != NAI && node.right != NAI) {
+            s.push(node.right);
+            node_id = node.left;
+            continue;
+        } else {
+            for (std::size_t i = node.first; i < node.last; ++i) {
+                omega += solid_angle(tris[i]);
+            }
+        }
+
+        if (s.empty()) break;
+        node_id = s.top(); s.pop();
+    }
+
+    return omega / (4.0f * 3.14159265358979323846f);
 }
 
+} /* namespace ACC_BVH_VARIANT */
+
 ACC_NAMESPACE_END
 
 #endif /* ACC_BVHTREE_HEADER */
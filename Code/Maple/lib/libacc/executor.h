@@ -0,0 +1,43 @@
+/*
+ * Copyright (C) 2015, Nils Moehrle
+ * All rights reserved.
+ *
+ * This software may be modified and distributed under the terms
+ * of the BSD 3-Clause license. See the LICENSE.txt file for details.
+ */
+
+#ifndef ACC_EXECUTOR_HEADER
+#define ACC_EXECUTOR_HEADER
+
+#include <cstddef>
+#include <functional>
+
+#include "defines.h"
+
+ACC_NAMESPACE_BEGIN
+
+/* Runs the parallel parts of a tree build on the application's thread
+ * pool instead of threads owned by the tree. run has to execute every
+ * task index in [0, num_tasks) and return once all of them are done,
+ * tasks may call run again (nested fork join). */
+class Executor {
+public:
+    virtual ~Executor() = default;
+    virtual void run(std::size_t num_tasks,
+        std::function<void(std::size_t)> const & task) const = 0;
+};
+
+/* Runs every task on the calling thread. */
+class SerialExecutor : public Executor {
+public:
+    void run(std::size_t num_tasks,
+        std::function<void(std::size_t)> const & task) const override {
+        for (std::size_t i = 0; i < num_tasks; ++i) {
+            task(i);
+        }
+    }
+};
+
+ACC_NAMESPACE_END
+
+#endif /* ACC_EXECUTOR_HEADER */
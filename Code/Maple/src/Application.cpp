@@ -9,6 +9,7 @@
 #include "Engine/Profiler.h"
 #include "Engine/Timestep.h"
 #include "Engine/JobSystem.h"
+#include "Engine/Threading.h"
 
 #include "Scene/Component/Bindless.h"
 #include "Scene/Component/BoundingBox.h"
@@ -38,6 +39,7 @@
 #include "RHI/Texture.h"
 #include "Scene/SystemBuilder.inl"
 
+#include <chrono>
 #include <imgui.h>
 
 //maple::Application* app;
@@ -58,6 +60,27 @@ namespace maple
 		JobSystem::init(std::thread::hardware_concurrency() - 2);
 	}
 
+	Application::~Application()
+	{
+		setPipelined(false);
+
+		//nothing posts anymore, queued callbacks are dropped and their futures see a broken promise.
+		eventQueue.drain([](MainThreadTask *task) { delete task; });
+
+		auto release = [](MainThreadTask *task) {
+			while (task != nullptr)
+			{
+				auto next = task->next.load(std::memory_order_relaxed);
+				delete task;
+				task = next;
+			}
+		};
+		release(recycledTasks);
+		release(freeTasks.exchange(nullptr, std::memory_order_acquire));
+		recycledTasks = nullptr;
+		recycledTail  = nullptr;
+	}
+
 	auto Application::init() -> void
 	{
 		PROFILE_FUNCTION();
@@ -84,6 +107,7 @@ namespace maple
 		renderDevice->init();
 
 		timer.start();
+		simulationLock = std::unique_lock<std::mutex>(builder->simulation, std::defer_lock);
 		renderGraph->init(window->getWidth(), window->getHeight());
 
 		imGuiManager = std::make_shared<ImGuiSystem>(false);
@@ -102,6 +126,14 @@ namespace maple
 		while (!window->isClose())
 		{
 			PROFILE_FRAMEMARKER();
+			//in pipelined mode the previous frame is recorded meanwhile, until the snapshot of this one is extracted.
+			simulationLock.lock();
+			if (sceneManager->isSwitchingScene())
+			{
+				//the recorded frame still references the entities of the old scene.
+				waitForRender();
+				presentFrame();
+			}
 			Input::getInput()->resetPressed();
 			Timestep timestep = timer.stop() / 1000000.f;
 			if (!minimized)
@@ -110,11 +142,16 @@ namespace maple
 				sceneManager->apply();
 				executeAll();
 				onUpdate(timestep);
+				renderGraph->extract(sceneManager->getCurrentScene());
+				simulationLock.unlock();
 				onRender();
 				frames++;
 				profiler.frameCount++;
 			}
-			graphicsContext->clearUnused();
+			JobSystem::endFrame();
+			profiler.scratchHighWaterMark = JobSystem::getScratchStats().highWaterMark;
+			if (!pipelined)
+				graphicsContext->clearUnused();
 			lastFrameTime += timestep;
 			if (lastFrameTime - secondTimer > 1.0f)        //tick later
 			{
@@ -126,6 +163,7 @@ namespace maple
 			}
 		}
 
+		setPipelined(false);
 		appDelegate->onDestory();
 		return 0;
 	}
@@ -172,13 +210,107 @@ namespace maple
 		PROFILE_FUNCTION();
 		if (!minimized)
 		{
+			//the previous frame should be presented before its swap chain slot is reused
+			//and before cached pipelines or frame buffers it references are released.
+			waitForRender();
+			presentFrame();
+			if (pipelined)
+				graphicsContext->clearUnused();
 			renderDevice->begin();
 			renderGraph->beginScene(sceneManager->getCurrentScene());
-			builder->execute();
-			imGuiManager->onRender(sceneManager->getCurrentScene());
-			renderDevice->present(); 
-			window->swapBuffers();
-			renderGraph->pingPong();
+			recorded = true;
+			if (pipelined)
+			{
+				std::lock_guard<std::mutex> lock(renderMutex);
+				renderPending = true;
+				renderCondition.notify_all();
+			}
+			else
+			{
+				builder->execute();
+				presentFrame();
+			}
+		}
+	}
+
+	auto Application::presentFrame() -> void
+	{
+		if (!recorded)
+			return;
+		PROFILE_FUNCTION();
+		recorded = false;
+		imGuiManager->onRender(sceneManager->getCurrentScene());
+		renderDevice->present();
+		window->swapBuffers();
+		renderGraph->pingPong();
+	}
+
+	auto Application::renderLoop() -> void
+	{
+		PROFILE_SETTHREADNAME("RenderThread");
+		std::unique_lock<std::mutex> lock(renderMutex);
+		for (;;)
+		{
+			renderCondition.wait(lock, [this]() { return renderPending || renderExit; });
+			if (!renderPending)
+				return;
+
+			lock.unlock();
+			builder->executePipelined();
+			lock.lock();
+			renderPending = false;
+			renderCondition.notify_all();
+		}
+	}
+
+	auto Application::setPipelined(bool pipelined) -> void
+	{
+#ifdef MAPLE_OPENGL
+		if (pipelined)
+		{
+			LOGW("pipelined rendering needs the vulkan backend, the OpenGL context belongs to the main thread");
+			return;
+		}
+#endif
+		if (this->pipelined == pipelined)
+			return;
+
+		this->pipelined = pipelined;
+		if (pipelined)
+		{
+			renderExit   = false;
+			renderThread = std::thread([this]() { renderLoop(); });
+			threading::setName(renderThread, "RenderThread");
+		}
+		else
+		{
+			//the recorded frame is presented by the next onRender.
+			waitForRender();
+			{
+				std::lock_guard<std::mutex> lock(renderMutex);
+				renderExit = true;
+			}
+			renderCondition.notify_all();
+			renderThread.join();
+		}
+	}
+
+	auto Application::waitForRender() -> void
+	{
+		std::unique_lock<std::mutex> lock(renderMutex);
+		if (!renderPending)
+			return;
+
+		PROFILE_FUNCTION();
+		//called during the update (resize, scene switch), the systems still to record may need the simulation lock.
+		const bool simulating = simulationLock.owns_lock();
+		if (simulating)
+			simulationLock.unlock();
+		renderCondition.wait(lock, [this]() { return !renderPending; });
+		if (simulating)
+		{
+			lock.unlock();
+			simulationLock.lock();
 		}
 	}
 
@@ -212,6 +344,8 @@ namespace maple
 		PROFILE_FUNCTION();
 		
 		minimized = w == 0 || h == 0;
+		waitForRender();
+		presentFrame();
 		
 		if (w == 0 || h == 0)
 			return;
@@ -226,34 +360,106 @@ namespace maple
 		graphicsContext->waitIdle();
 	}
 
+	auto Application::acquireTask() -> MainThreadTask *
+	{
+		// each producer thread takes the whole shared free list at once, so there is no ABA on pop.
+		struct LocalTasks
+		{
+			MainThreadTask *head = nullptr;
+			~LocalTasks()
+			{
+				while (head != nullptr)
+				{
+					auto next = head->next.load(std::memory_order_relaxed);
+					delete head;
+					head = next;
+				}
+			}
+		};
+		static thread_local LocalTasks local;
+
+		if (local.head == nullptr)
+			local.head = freeTasks.exchange(nullptr, std::memory_order_acquire);
+
+		if (local.head == nullptr)
+			return new MainThreadTask();
+
+		auto task  = local.head;
+		local.head = task->next.load(std::memory_order_relaxed);
+		return task;
+	}
+
+	auto Application::recycleTask(MainThreadTask *task) -> void
+	{
+		task->next.store(recycledTasks, std::memory_order_relaxed);
+		if (recycledTasks == nullptr)
+			recycledTail = task;
+		recycledTasks = task;
+	}
+
 	auto Application::postOnMainThread(const std::function<bool()> &mainCallback) -> std::future<bool>
 	{
 		PROFILE_FUNCTION();
-		std::promise<bool> promise;
-		std::future<bool>  future = promise.get_future();
-
-		std::lock_guard<std::mutex> locker(executeMutex);
-		eventQueue.emplace(std::move(promise), mainCallback);
+		auto task      = acquireTask();
+		task->callback = mainCallback;
+		task->promise.emplace();
+		auto future = task->promise->get_future();
+		eventQueue.push(task);
 		return future;
 	}
 
+	auto Application::postOnMainThreadDetached(std::function<void()> mainCallback) -> void
+	{
+		PROFILE_FUNCTION();
+		auto task      = acquireTask();
+		task->detached = std::move(mainCallback);
+		eventQueue.push(task);
+	}
+
 	auto Application::executeAll() -> void
 	{
 		PROFILE_FUNCTION();
-		std::pair<std::promise<bool>, std::function<bool(void)>> func;
+		const auto start = std::chrono::steady_clock::now();
 		for (;;)
 		{
+			MainThreadTask *released = nullptr;
+			auto            task     = eventQueue.pop(released);
+			if (released != nullptr)
+				recycleTask(released);
+			if (task == nullptr)
+				break;
+
+			// the popped node stays in the queue as its stub, so move everything out of it now.
+			auto callback = std::move(task->callback);
+			auto detached = std::move(task->detached);
+			auto promise  = std::move(task->promise);
+			task->callback = nullptr;
+			task->detached = nullptr;
+			task->promise.reset();
+
+			if (detached)
+				detached();
+			else if (callback && promise)
+				promise->set_value(callback());
+
+			if (mainThreadBudget > 0.0f)
 			{
-				std::lock_guard<std::mutex> lock(executeMutex);
-				if (eventQueue.empty())
+				const std::chrono::duration<float, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+				if (elapsed.count() >= mainThreadBudget)
 					break;
-				func = std::move(eventQueue.front());
-				eventQueue.pop();
 			}
-			if (func.second)
+		}
+
+		// hand the recycled nodes back to the producers, only this thread pushes so the CAS can not ABA.
+		if (recycledTasks != nullptr)
+		{
+			auto head = freeTasks.load(std::memory_order_relaxed);
+			do
 			{
-				func.first.set_value(func.second());
-			}
+				recycledTail->next.store(head, std::memory_order_relaxed);
+			} while (!freeTasks.compare_exchange_weak(head, recycledTasks, std::memory_order_release, std::memory_order_relaxed));
+			recycledTasks = nullptr;
+			recycledTail  = nullptr;
 		}
 	}
 
@@ -3,14 +3,22 @@
 //////////////////////////////////////////////////////////////////////////////
 
 #pragma once
+#include <condition_variable>
+#include <functional>
+#include <future>
 #include <list>
 #include <memory>
+#include <mutex>
+#include <optional>
+#include <thread>
 
 #include "Engine/Core.h"
+#include "Engine/JobSystem.h"
 #include "Engine/Renderer/RenderGraph.h"
 #include "Engine/Timestep.h"
 #include "Event/EventDispatcher.h"
 #include "ImGui/ImGuiSystem.h"
+#include "Others/MpscQueue.h"
 #include "Others/Timer.h"
 #include "RHI/GraphicsContext.h"
 #include "RHI/RenderDevice.h"
@@ -41,12 +49,35 @@ namespace maple
 	{
 	public:
 		Application(AppDelegate* appDelegate);
+		virtual ~Application();
 
 		auto start()->int32_t;
 		auto setSceneActive(bool active) -> void;
 		auto postOnMainThread(const std::function<bool()>& mainCallback)->std::future<bool>;
+		/**
+		 * fire-and-forget variant, skips the promise/future shared state.
+		 */
+		auto postOnMainThreadDetached(std::function<void()> mainCallback) -> void;
 		auto executeAll() -> void;
 
+		/**
+		 * time budget for executeAll in milliseconds, 0 means drain the whole queue every frame.
+		 * at least one callback runs per frame, the rest stay queued for the next frames.
+		 */
+		inline auto setMainThreadBudget(float milliseconds) -> void
+		{
+			mainThreadBudget = milliseconds;
+		}
+
+		/**
+		 * pipelined mode : the main thread extracts frame N into the RenderSnapshot after its update, then a render
+		 * thread records frame N while the main thread updates frame N+1. systems sharing state with the update
+		 * still wait for it through the simulation lock, see SystemBuilder::executePipelined.
+		 * ImGui and present stay on the main thread, after the update of frame N+1. vulkan only.
+		 */
+		auto setPipelined(bool pipelined) -> void;
+		auto waitForRender() -> void;
+
 		virtual auto init() -> void;
 		virtual auto onUpdate(const Timestep& delta) -> void;
 		virtual auto onRender() -> void;
@@ -74,6 +105,11 @@ namespace maple
 			return sceneActive;
 		}
 
+		inline auto isPipelined() const
+		{
+			return pipelined;
+		}
+
 		inline auto& getEditorState() const
 		{
 			return state;
@@ -125,6 +161,20 @@ namespace maple
 		static Application* app;
 
 	protected:
+		struct MainThreadTask
+		{
+			std::atomic<MainThreadTask *>     next{nullptr};
+			std::function<bool()>             callback;
+			std::function<void()>             detached;
+			std::optional<std::promise<bool>> promise;
+		};
+
+		auto acquireTask() -> MainThreadTask *;
+		auto recycleTask(MainThreadTask *task) -> void;
+
+		auto renderLoop() -> void;
+		auto presentFrame() -> void;
+
 		std::unique_ptr<NativeWindow>    window;
 		std::unique_ptr<SceneManager>	 sceneManager;
 		std::shared_ptr<ImGuiSystem>     imGuiManager;
@@ -139,13 +189,25 @@ namespace maple
 		uint64_t        updates = 0;
 		uint64_t        frames = 0;
 		float           secondTimer = 0.0f;
+		float           mainThreadBudget = 0.0f;
 		bool            sceneActive = true;
 		bool            editor = false;
 		bool 			 minimized = false;
+		bool            pipelined = false;
 		EditorState     state = EditorState::Paused;
-		std::mutex      executeMutex;
 
-		std::queue<std::pair<std::promise<bool>, std::function<bool()>>> eventQueue;
+		std::thread                  renderThread;
+		std::mutex                   renderMutex;
+		std::condition_variable      renderCondition;
+		bool                         renderPending = false;        //handed to the render thread and not recorded yet
+		bool                         renderExit    = false;
+		bool                         recorded      = false;        //recorded, waits for ImGui and present
+		std::unique_lock<std::mutex> simulationLock;
+
+		MpscQueue<MainThreadTask>       eventQueue;
+		std::atomic<MainThreadTask *>   freeTasks{nullptr};
+		MainThreadTask *                recycledTasks = nullptr;
+		MainThreadTask *                recycledTail  = nullptr;
 	};
 
 };        // namespace maple
@@ -0,0 +1,17 @@
+//////////////////////////////////////////////////////////////////////////////
+// This file is part of the Maple Engine                              		//
+//////////////////////////////////////////////////////////////////////////////
+#include "Core.h"
+
+#include <cstdio>
+#include <cstdlib>
+
+// MapleCore only, the engine uses Core.cpp. tools and tests have no window to ask whether to ignore the assertion.
+namespace maple
+{
+	auto printStackTrace(const std::string &input) -> void
+	{
+		fprintf(stderr, "assertion failed in %s, aborting\n", input.c_str());
+		std::abort();
+	}
+}        // namespace maple
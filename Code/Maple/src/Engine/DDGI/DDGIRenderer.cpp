@@ -483,7 +483,7 @@ namespace maple
 				pass.descriptors[0]->setTexture("uIrradiance", internal.irradiance[writeIdx]);
 				pass.descriptors[0]->setTexture("uDepth", internal.depth[writeIdx]);
 				pass.descriptors[0]->setUniform("DDGIUBO", "ddgi", &uniform);
-				auto pos = glm::vec4(cameraView.cameraTransform->getWorldPosition(), 1.f);
+				auto pos = glm::vec4(cameraView.position, 1.f);
 				pass.descriptors[0]->setUniform("UniformBufferObject", "cameraPosition", &pos);
 				pass.descriptors[0]->setUniform("UniformBufferObject", "viewProjInv", glm::value_ptr(glm::inverse(cameraView.projView)));
 
@@ -4,18 +4,26 @@
 
 #include "GlobalDistanceField.h"
 #include "MeshDistanceField.h"
+#include "SDFAtlas.h"
+#include "SDFCache.h"
+#include "SDFCascadeScheduler.h"
+#include "SDFChunks.h"
+#include "SDFStreaming.h"
 
 #include "Engine/Mesh.h"
+#include "Engine/Renderer/RenderSnapshot.h"
 #include "Engine/Renderer/RendererData.h"
 
 #include "Engine/Core.h"
 #include "Engine/GBuffer.h"
+#include "Engine/JobSystem.h"
 #include "Engine/Renderer/Renderer.h"
 #include "Engine/Renderer/SkyboxRenderer.h"
 
 #include "ImGui/ImGuiHelpers.h"
 #include "Math/BoundingBox.h"
 #include "Math/BoundingSphere.h"
+#include "Math/DynamicAABBTree.h"
 #include "Math/MathUtils.h"
 
 #include "RHI/DescriptorPool.h"
@@ -29,6 +37,7 @@
 
 #include "Scene/Component/MeshRenderer.h"
 #include "Scene/Component/Transform.h"
+#include "Scene/Entity/Entity.h"
 
 #include "IO/File.h"
 
@@ -37,7 +46,11 @@
 #include <glm/glm.hpp>
 #include <imgui.h>
 #include "ImGui/ImNotification.h"
+#include <algorithm>
+#include <limits>
 #include <map>
+#include <unordered_map>
+#include <unordered_set>
 
 namespace maple::sdf
 {
@@ -79,19 +92,18 @@ namespace maple::sdf
 			return position.x + position.y * resolution.x + position.z * resolution.x * resolution.y;
 		};
 
-		constexpr int32_t CONSTS_SDF_RASTERIZE_MODEL_MAX_COUNT = 28;
+		constexpr int32_t CONSTS_SDF_RASTERIZE_MODEL_MAX_COUNT = chunks::MaxChunkModels;
 		constexpr int32_t CONSTS_SDF_RASTERIZE_MODEL_SET_MAX_COUNT = 512;
 		constexpr int32_t CONSTS_SDF_RASTERIZE_HEIGHTFIELD_MAX_COUNT = 2;
 		constexpr int32_t CONSTS_SDF_RASTERIZE_GROUP_SIZE = 8;
-		constexpr int32_t CONSTS_SDF_RASTERIZE_CHUNK_SIZE = 32;
+		constexpr int32_t CONSTS_SDF_RASTERIZE_CHUNK_SIZE = chunks::ChunkSize;
 		constexpr int32_t CONSTS_SDF_RASTERIZE_MIP_FACTOR = 4;
 		constexpr int32_t CONSTS_SDF_MIP_GROUP_SIZE = 4;
-		constexpr int32_t CONSTS_SDF_RASTERIZE_CHUNK_MARGIN = 4;
 		constexpr int32_t CONSTS_SDF_MIP_FLOODS = CONSTS_SDF_RASTERIZE_MIP_FACTOR + 1;
-		constexpr int16_t RASTERIZE_CHUNK_KEY_HASH_RESOLUTION = CONSTS_SDF_RASTERIZE_CHUNK_SIZE;
 
 		struct GlobalSDFMipmapPushConsts
 		{
+			glm::ivec3 cascadeTexelOffset;        // toroidal origin of the destination, in destination texels
 			int32_t globalSDFResolution;
 			int32_t mipmapcoordScale;
 			int32_t cascadeTexOffsetX;
@@ -103,61 +115,16 @@ namespace maple::sdf
 		{
 			glm::mat4 worldToVolume;
 			glm::mat4 volumeToWorld;
-			glm::vec3 volumeToUVWMul;
-			float     mipOffset;
+			glm::vec3 volumeToUVWMul;        // volume space to atlas page uvw
+			uint32_t  atlasPage;
 			glm::vec3 volumeToUVWAdd;
 			float     decodeMul;
 			glm::vec3 volumeLocalBoundsExtent;
 			float     decodeAdd;
-		};
-
-		struct Chunk
-		{
-			bool dynamic;
-			uint16_t modelsCount;
-			uint32_t models[CONSTS_SDF_RASTERIZE_MODEL_MAX_COUNT];
-
-			Chunk()
-			{
-				modelsCount = 0;
-				dynamic = false;
-			}
-		};
-
-		struct ChunkKey
-		{
-			uint32_t   hash;
-			int32_t    layer;
-			glm::ivec3 coord;
-
-			inline auto nextLayer()
-			{
-				layer++;
-				hash += RASTERIZE_CHUNK_KEY_HASH_RESOLUTION * RASTERIZE_CHUNK_KEY_HASH_RESOLUTION * RASTERIZE_CHUNK_KEY_HASH_RESOLUTION;
-			}
-
-			friend auto operator==(const ChunkKey& a, const ChunkKey& b)
-			{
-				return a.hash == b.hash && a.coord == b.coord && a.layer == b.layer;
-			}
-		};
-
-		struct HashFunc
-		{
-			size_t operator()(const ChunkKey& i) const
-			{
-				return i.hash;
-			}
-		};
-
-		struct CascadeData
-		{
-			glm::vec3                                       position;
-			float                                           voxelSize;
-			BoundingBox                                     bounds;
-			std::unordered_set<ChunkKey, HashFunc> nonEmptyChunks;
-			std::unordered_set<ChunkKey, HashFunc> staticChunks;
-			std::set<std::string>                           objects;
+			glm::vec3 uvwMin;        // outer texel centers of the region, replaces ClampToEdge
+			float     padding0;
+			glm::vec3 uvwMax;
+			float     padding1;
 		};
 
 		struct ModelsData
@@ -166,8 +133,8 @@ namespace maple::sdf
 			float     maxDistance;
 			glm::vec3 cascadecoordToPosAdd;
 			int32_t   cascadeResolution;
+			glm::ivec3 cascadeTexelOffset;
 			int32_t   cascadeIndex;
-			glm::vec3 padding;
 		};
 
 		struct RasterizeConsts
@@ -177,8 +144,6 @@ namespace maple::sdf
 			uint32_t   objects[CONSTS_SDF_RASTERIZE_MODEL_MAX_COUNT];
 		};
 
-		std::unordered_map<ChunkKey, Chunk, HashFunc> chunksCache;
-
 		inline auto getQuality(Quality quality, int32_t& resolution, int32_t& cascadesCount)
 		{
 			switch (quality)
@@ -190,25 +155,33 @@ namespace maple::sdf
 			}
 		}
 
-		inline auto getChunkId(float voxelSize, const BoundingBox& cascadeBounds, const BoundingBox& objectBounds, glm::ivec3& objectChunkMin, glm::ivec3& objectChunkMax)
+		// the mesh sdf mip a cascade samples.
+		inline auto getCascadeMip(int32_t cascadeIndex) -> uint32_t
 		{
-			BoundingBox objectBoundsCascade;
-			const float objectMargin = voxelSize * CONSTS_SDF_RASTERIZE_CHUNK_MARGIN;
-			auto        cascadeBoundsBias = cascadeBounds;
-			cascadeBoundsBias.min += 0.1f;
-			cascadeBoundsBias.max -= 0.1f;
-			objectBoundsCascade.min = objectBounds.min - objectMargin;
-			objectBoundsCascade.max = objectBounds.max + objectMargin;
-			glm::clamp(objectBoundsCascade.min, cascadeBoundsBias.min, cascadeBoundsBias.max);
-			glm::clamp(objectBoundsCascade.max, cascadeBoundsBias.min, cascadeBoundsBias.max);
-
-			objectBoundsCascade.min -= cascadeBoundsBias.min;
-			objectBoundsCascade.max -= cascadeBoundsBias.min;        //relative to cascade bounds.*/
-			const float chunkSize = voxelSize * CONSTS_SDF_RASTERIZE_CHUNK_SIZE;
-			objectChunkMin = { objectBoundsCascade.min / chunkSize };        //compute chunk id.
-			objectChunkMax = { objectBoundsCascade.max / chunkSize };
+			return std::min(cascadeIndex, 2);
 		}
 
+		/**
+		 * bakes run in the background, every job works on its own copy of the inputs
+		 * so the registry can change while they are running. results are applied on the main thread.
+		 */
+		struct PendingBake
+		{
+			entt::entity                   entity;
+			std::string                    name;
+			std::shared_ptr<Mesh>          mesh;
+			component::MeshDistanceField   field;
+			bool                           baked = false;
+		};
+
+		struct BakeTask
+		{
+			JobSystem::Context       context;
+			baker::BakeProgress      progress;
+			Timer                    timer;
+			std::vector<PendingBake> pending;
+		};
+
 	}        // namespace
 
 	namespace global::component
@@ -217,12 +190,27 @@ namespace maple::sdf
 		{
 			Quality                   quality = Quality::Test;
 			int32_t                   resolution = 0;
-			std::vector<CascadeData>  cascadeData;
+			std::vector<chunks::CascadeData> cascadeData;
 			Texture3D::Ptr            mipTempTexture;
 			uint32_t                  objectsBufferCount = 0;
-			std::vector<Texture::Ptr> sdfTextrues;
 			StorageBuffer::Ptr        sdfBuffer;
+
+			std::shared_ptr<atlas::MeshSDFAtlas>          atlas;
+			std::shared_ptr<streaming::ResidencyManager> streaming;
+			std::shared_ptr<query::DistanceQuery>        query;
 			int32_t                   rasterizeChunks = 0;
+			chunks::ChunkGrid         chunks;
+			scheduler::CascadeScheduler scheduler;
+
+			struct ObjectProxy
+			{
+				int32_t     proxy;
+				BoundingBox bounds;        // world bounds the cascades last saw, dirtied again when the object moves away
+			};
+
+			// every loaded mesh distance field, the cascades gather their objects with a box query. shared with the cpu queries.
+			std::shared_ptr<DynamicAABBTree>              objectTree = std::make_shared<DynamicAABBTree>();
+			std::unordered_map<entt::entity, ObjectProxy> objectProxies;
 
 			std::vector<ObjectRasterizeData> objects;
 
@@ -253,8 +241,39 @@ namespace maple::sdf
 			float   stepScale = 1;
 
 			bool needBake = false;
+
+			std::shared_ptr<BakeTask> bakeTask;
 		};
 
+		// the chunks under both the old and the new bounds see a different set of objects.
+		inline auto updateObjectProxy(GlobalDistanceField& globalSDF, entt::entity entity, const sdf::component::MeshDistanceField& sdf, const maple::component::Transform& transform)
+		{
+			const auto bounds = sdf.aabb.transform(transform.getWorldMatrix());
+			if (auto iter = globalSDF.objectProxies.find(entity); iter != globalSDF.objectProxies.end())
+			{
+				chunks::invalidateChunks(globalSDF.cascadeData, iter->second.bounds);
+				globalSDF.objectTree->moveProxy(iter->second.proxy, chunks::getObjectBounds(bounds));
+				iter->second.bounds = bounds;
+			}
+			else
+			{
+				globalSDF.objectProxies.emplace(entity, GlobalDistanceField::ObjectProxy{ globalSDF.objectTree->createProxy(chunks::getObjectBounds(bounds), entt::to_integral(entity)), bounds });
+			}
+			chunks::invalidateChunks(globalSDF.cascadeData, bounds);
+			globalSDF.query->updateObject(entt::to_integral(entity), sdf.bakedPath, transform.getWorldMatrix());
+		}
+
+		inline auto removeObjectProxy(GlobalDistanceField& globalSDF, entt::entity entity)
+		{
+			if (auto iter = globalSDF.objectProxies.find(entity); iter != globalSDF.objectProxies.end())
+			{
+				chunks::invalidateChunks(globalSDF.cascadeData, iter->second.bounds);
+				globalSDF.objectTree->destroyProxy(iter->second.proxy);
+				globalSDF.query->removeObject(entt::to_integral(entity));
+				globalSDF.objectProxies.erase(iter);
+			}
+		}
+
 		struct SDFVisualizer
 		{
 			std::shared_ptr<Shader>                     shader;
@@ -327,40 +346,76 @@ namespace maple::sdf
 	{
 		inline auto system(ioc::Registry registry, sdf::global::component::GlobalDistanceField& globalSDF, maple::component::RendererData& data, const global::component::GlobalDistanceFieldPublic& sdfPublic)
 		{
-			if (globalSDF.needBake)
+			if (globalSDF.needBake && globalSDF.bakeTask == nullptr)
 			{
-				JobSystem::Context context;
-				Timer              timer;
-				timer.start();
-
 				auto group = registry.getRegistry().view<
 					maple::component::NameComponent,
 					maple::component::MeshRenderer,
-					maple::component::Transform,
 					component::MeshDistanceField
 				>();
 
-				for (auto entity : group)
+				globalSDF.bakeTask = std::make_shared<BakeTask>();
+				auto& pending = globalSDF.bakeTask->pending;
+
+				for (auto [entity, name, mesh, sdf] : group.each())
 				{
-					JobSystem::execute(context, [=](JobSystem::JobDispatchArgs args) {
-						auto [name, mesh, transform, sdf] = group.get(entity);
-						if (sdf.buffer == nullptr && !File::fileExists(sdf.bakedPath))
-						{
-							LOGI("Baking MeshDistanceField : {} ", name.name);
-							sdf::baker::bake(mesh.mesh, sdfPublic.config, sdf, transform);
-						}
+					// bake resolves through the content addressed cache, unchanged meshes are not baked again.
+					if (sdf.atlas == nullptr)
+						pending.push_back({ entity, name.name, mesh.mesh, sdf });
+				}
+
+				for (uint32_t i = 0; i < pending.size(); i++)
+				{
+					JobSystem::execute(globalSDF.bakeTask->context, [task = globalSDF.bakeTask, config = sdfPublic.config, i](JobSystem::JobDispatchArgs args) {
+						auto& bake = task->pending[i];
+						if (task->progress.isCancelled())
+							return;
+						bake.baked = sdf::baker::bake(baker::makeGeometry(bake.mesh->getName(), bake.mesh->getVertex(), bake.mesh->getIndex()), config, bake.field, &task->progress);
 						});
 				}
-				JobSystem::wait(context);
+			}
+
+			if (globalSDF.bakeTask != nullptr && !JobSystem::isBusy(globalSDF.bakeTask->context))
+			{
+				auto task = std::move(globalSDF.bakeTask);
+				globalSDF.needBake = false;
+
+				sdf::cache::collectGarbage();
+
+				if (task->progress.isCancelled())
+				{
+					ImNotification::makeNotification("GlobalSDF", "Baking MeshDistanceFields Cancelled", ImNotification::Type::Warning);
+					return;
+				}
+
+				for (auto& bake : task->pending)
+				{
+					if (bake.baked && registry.getRegistry().valid(bake.entity))
+					{
+						if (auto sdf = registry.getRegistry().try_get<component::MeshDistanceField>(bake.entity))
+							*sdf = bake.field;
+					}
+				}
+
+				auto group = registry.getRegistry().view<
+					maple::component::NameComponent,
+					maple::component::MeshRenderer,
+					maple::component::Transform,
+					component::MeshDistanceField
+				>();
+
 				for (auto [entity, name, mesh, transform, sdf] : group.each())
 				{
+					if (sdf.atlas != nullptr)
+						continue;
 					ImNotification::makeNotification("GlobalSDF", "Loading MeshDistanceField : " + sdf.bakedPath, ImNotification::Type::Info);
-					sdf::baker::load(sdf, data.commandBuffer);
+					// only the coarsest mip, finer ones are streamed in as the cascades need them.
+					if (globalSDF.atlas->load(sdf, data.commandBuffer, std::numeric_limits<uint32_t>::max()))
+						global::component::updateObjectProxy(globalSDF, entity, sdf, transform);
 				}
-				auto elapsed = timer.stop();
+				auto elapsed = task->timer.stop();
 				LOGI("total cost : {}", elapsed);
 				ImNotification::makeNotification("GlobalSDF", "Loaded All MeshDistanceFields, Please Click Run DDGI! ", ImNotification::Type::Success, 10000);
-				globalSDF.needBake = false;
 			}
 		}
 	}        // namespace generate_sdf
@@ -369,7 +424,7 @@ namespace maple::sdf
 	{
 		inline auto system(ioc::Registry registry,
 			sdf::global::component::GlobalDistanceField& globalSDF,
-			maple::global::component::SceneTransformChanged& changed)
+			const maple::component::RenderSnapshot& snapshot)
 		{
 			auto meshGroup = registry.getRegistry().view<
 				maple::component::MeshRenderer,
@@ -380,42 +435,30 @@ namespace maple::sdf
 			if (meshGroup.begin() == meshGroup.end())
 				return;
 
-			if (changed.dirty)
+			const auto& frame = snapshot.front();
+			if (frame.transformChanged)
 			{
-				for (auto id : changed.entities)
+				for (auto id : frame.changedEntities)
 				{
 					if (meshGroup.contains(id))
 					{
 						auto [render, transform, sdf] = meshGroup.get(id);
-						auto        objectBounds = sdf.aabb.transform(transform.getWorldMatrix());
-						BoundingBox objectBoundsCascade;
-						for (auto& cascade : globalSDF.cascadeData)
-						{
-							glm::ivec3 objectChunkMin;
-							glm::ivec3 objectChunkMax;
-							getChunkId(cascade.voxelSize, cascade.bounds, objectBounds, objectChunkMin, objectChunkMax);
-
-							ChunkKey key;
-							key.layer = 0;
-
-							for (key.coord.z = objectChunkMin.z; key.coord.z <= objectChunkMax.z; key.coord.z++)
-							{
-								for (key.coord.y = objectChunkMin.y; key.coord.y <= objectChunkMax.y; key.coord.y++)
-								{
-									for (key.coord.x = objectChunkMin.x; key.coord.x <= objectChunkMax.x; key.coord.x++)
-									{
-										key.hash = flatten(key.coord, glm::ivec3{ RASTERIZE_CHUNK_KEY_HASH_RESOLUTION });
-										cascade.staticChunks.erase(key);
-									}
-								}
-							}
-						}
+						if (sdf.atlas != nullptr)
+							global::component::updateObjectProxy(globalSDF, id, sdf, transform);
 					}
 				}
 			}
 		}        // namespace chunk_calculate
 	}            // namespace on_scene_changed
 
+	namespace delegates
+	{
+		inline auto onMeshDistanceFieldDestroy(component::MeshDistanceField& sdf, Entity entity, global::component::GlobalDistanceField& globalSDF) -> void
+		{
+			global::component::removeObjectProxy(globalSDF, entity.getHandle());
+		}
+	}        // namespace delegates
+
 	namespace on_imgui
 	{
 		inline auto system(ioc::Registry registry, global::component::GlobalDistanceField& globalSDF,
@@ -428,7 +471,15 @@ namespace maple::sdf
 
 			if (ImGui::Begin("GlobalDistanceField"))
 			{
-				if (ImGui::Button("Generate"))
+				if (globalSDF.bakeTask != nullptr)
+				{
+					ImGui::ProgressBar(globalSDF.bakeTask->progress.getProgress());
+					if (ImGui::Button("Cancel"))
+					{
+						globalSDF.bakeTask->progress.cancel();
+					}
+				}
+				else if (ImGui::Button("Generate"))
 				{
 					globalSDF.needBake = true;
 					for (auto entity : meshGroup)
@@ -456,12 +507,106 @@ namespace maple::sdf
 				}
 				ImGuiHelper::property("SDF GI Distance", sdfPublic.giDistance, 1, 15000, ImGuiHelper::PropertyFlag::DragFloat);
 				ImGuiHelper::property("Global Scale", sdfPublic.gloalScale, 0.001, 10, ImGuiHelper::PropertyFlag::DragFloat);
+				ImGuiHelper::property("SDF Streaming Budget (MB)", sdfPublic.streamingBudget, 16, 256, ImGuiHelper::PropertyFlag::DragFloat);
+				ImGuiHelper::property("SDF Update Budget (ms)", sdfPublic.updateBudget, 0.25, 16, ImGuiHelper::PropertyFlag::DragFloat);
 				ImGui::Columns(1);
+
+				const auto& allocator = globalSDF.atlas->getAllocator();
+				const auto& pageSize = allocator.getPageSize();
+				ImGui::Text("SDF Atlas : %u regions, %u / %u pages, %.1f%% used", allocator.getAllocationCount(), allocator.getPageCount(), atlas::MaxPages,
+					allocator.getPageCount() == 0 ? 0.f : 100.f * allocator.getUsedTexels() / (float(pageSize.x) * pageSize.y * pageSize.z * allocator.getPageCount()));
+
+				const auto& stats = globalSDF.streaming->getStats();
+				ImGui::Text("SDF Streaming : %.1f / %.1f MB, %u of %u fields waiting, %u reads in flight, %u streamed in, %u evicted",
+					stats.residentBytes / float(1 << 20), stats.budgetBytes / float(1 << 20), stats.waiting, stats.fields, stats.inflight, stats.streamedIn, stats.evicted);
+				for (uint32_t mip = 0; mip < container::MaxMips; mip++)
+				{
+					if (stats.residentLevels[mip] > 0)
+						ImGui::Text("    %u fields resident from mip %u", stats.residentLevels[mip], mip);
+				}
+
+				ImGui::Text("SDF Queries : %u objects, %.1f MB resident", globalSDF.query->getObjectCount(), globalSDF.query->getResidentBytes() / float(1 << 20));
+
+				const auto& schedule = globalSDF.scheduler.getStats();
+				ImGui::Text("SDF Updates : %.2f / %.2f ms estimated, %u of %u frames over budget",
+					schedule.spentMs, schedule.budgetMs, schedule.overBudgetFrames, schedule.frames);
+				for (uint32_t i = 0; i < globalSDF.cascadeData.size(); i++)
+				{
+					const auto& cascade = schedule.cascades[i];
+					ImGui::Text("    cascade %u : %u updates (%u partial, %u forced), %u chunks rasterized, %u deferred, stale %u / %u frames (worst %u)",
+						i, cascade.updates, cascade.partialUpdates, cascade.forcedUpdates, cascade.rasterized, cascade.deferred,
+						cascade.staleFrames, globalSDF.scheduler.maxStaleFrames[i], cascade.maxStaleFrames);
+				}
 			}
 			ImGui::End();
 		}
 	}        // namespace on_imgui
 
+	namespace stream_sdf
+	{
+		inline auto system(ioc::Registry registry,
+			global::component::GlobalDistanceField& sdfData,
+			const global::component::GlobalDistanceFieldPublic& sdfPublic,
+			maple::component::RendererData& renderData)
+		{
+			auto group = registry.getRegistry().view<
+				maple::component::MeshRenderer,
+				maple::component::Transform,
+				component::MeshDistanceField
+			>();
+
+			if (sdfData.cascadeData.empty())
+				return;
+
+			const float minObjectRadius = sdfPublic.minObjectRadius * sdfPublic.gloalScale;
+			const auto  viewPosition = sdfData.cascadeData[0].position;
+
+			// same object selection as merge_sdf, against the cascades placed last frame. cascades grow outwards,
+			// so the first one an object is found in is the finest that samples it.
+			std::unordered_map<const atlas::Entry*, std::vector<entt::entity>> requested;
+			std::unordered_set<entt::entity>                                   selected;
+			for (int32_t cascadeIndex = 0; cascadeIndex < sdfData.cascadeData.size(); cascadeIndex++)
+			{
+				const auto& cascade = sdfData.cascadeData[cascadeIndex];
+				sdfData.objectTree->query(cascade.bounds, [&](int32_t proxy) {
+					const auto entity = static_cast<entt::entity>(sdfData.objectTree->getUserData(proxy));
+					if (!group.contains(entity))
+						return true;
+
+					auto [render, transform, sdf] = group.get(entity);
+					if (sdf.atlas == nullptr || selected.count(entity) > 0)
+						return true;
+
+					BoundingBox    objectBounds = sdf.aabb.transform(transform.getWorldMatrix());
+					BoundingSphere sphereBox = objectBounds;
+					if (sphereBox.radius >= minObjectRadius && cascade.bounds.intersectsWithSphere(sphereBox))
+					{
+						selected.emplace(entity);
+						requested[sdf.atlas.get()].emplace_back(entity);
+						sdfData.streaming->request(sdf.atlas, getCascadeMip(cascadeIndex), glm::distance(viewPosition, objectBounds.center()));
+					}
+					return true;
+				});
+			}
+
+			sdfData.streaming->setBudget(static_cast<uint64_t>(sdfPublic.streamingBudget) << 20);
+
+			// only requested fields change level or are evicted while a cascade still samples them.
+			for (const auto* entry : sdfData.streaming->update(*sdfData.atlas, renderData.commandBuffer))
+			{
+				if (auto iter = requested.find(entry); iter != requested.end())
+				{
+					for (const auto entity : iter->second)
+					{
+						auto& transform = group.get<maple::component::Transform>(entity);
+						auto& sdf = group.get<component::MeshDistanceField>(entity);
+						chunks::invalidateChunks(sdfData.cascadeData, sdf.aabb.transform(transform.getWorldMatrix()));
+					}
+				}
+			}
+		}
+	}        // namespace stream_sdf
+
 	namespace merge_sdf
 	{
 		// how many distance represented in a voxel.
@@ -475,10 +620,6 @@ namespace maple::sdf
 		{
 			auto objectBounds = sdfBounds.transform(transform.getWorldMatrix());
 
-			glm::ivec3 objectChunkMin;
-			glm::ivec3 objectChunkMax;
-			getChunkId(voxelSize, cascadeBounds, objectBounds, objectChunkMin, objectChunkMax);
-
 			BoundingBox localVolumeBounds = sdfBounds;
 			glm::vec3   volumeCenter = localVolumeBounds.center();
 
@@ -486,10 +627,11 @@ namespace maple::sdf
 			glm::mat4 worldToVolume = worldToLocal * glm::translate(glm::mat4(1.f), -volumeCenter);
 			glm::mat4 volumeToWorld = glm::inverse(worldToVolume);
 
-			int32_t mipLevelIndex = std::min(cascadeLevel, 2);
+			// falls back to the finest resident mip while the wanted one is still streaming.
+			const auto& region = sdf.atlas->getRegion(getCascadeMip(cascadeLevel));
 
-			glm::vec3 volumeToUVWMul = sdf.localToUVWMul;
-			glm::vec3 volumeToUVWAdd = sdf.localToUVWAdd + volumeCenter * sdf.localToUVWMul;
+			glm::vec3 volumeToUVWMul = sdf.localToUVWMul * region.uvwMul;
+			glm::vec3 volumeToUVWAdd = (sdf.localToUVWAdd + volumeCenter * sdf.localToUVWMul) * region.uvwMul + region.uvwAdd;
 
 			uint16_t objectIndex = sdfData.objectsBufferCount++;
 
@@ -499,39 +641,13 @@ namespace maple::sdf
 			objectData.volumeLocalBoundsExtent = localVolumeBounds.size() / 2.f;
 			objectData.volumeToUVWMul = volumeToUVWMul;
 			objectData.volumeToUVWAdd = volumeToUVWAdd;
-			objectData.mipOffset = (float)mipLevelIndex;
+			objectData.atlasPage = region.allocation.page;
 			objectData.decodeMul = sdf.maxDistance;
 			objectData.decodeAdd = -sdf.maxDistance;
+			objectData.uvwMin = region.uvwMin;
+			objectData.uvwMax = region.uvwMax;
 
-			ChunkKey key;
-			bool              dynamicObj = false;
-
-			for (key.coord.z = objectChunkMin.z; key.coord.z <= objectChunkMax.z; key.coord.z++)
-			{
-				for (key.coord.y = objectChunkMin.y; key.coord.y <= objectChunkMax.y; key.coord.y++)
-				{
-					for (key.coord.x = objectChunkMin.x; key.coord.x <= objectChunkMax.x; key.coord.x++)
-					{
-						key.layer = 0;
-						key.hash = flatten(key.coord, glm::ivec3{ RASTERIZE_CHUNK_KEY_HASH_RESOLUTION });
-						auto& chunk = chunksCache[key];
-						chunk.dynamic |= false;        //assume every thing is static.
-
-						// Move to the next layer if chunk has overflown
-						while (chunk.modelsCount == CONSTS_SDF_RASTERIZE_MODEL_MAX_COUNT)
-						{
-							key.nextLayer();
-							chunk = chunksCache[key];
-						}
-						chunk.models[chunk.modelsCount++] = objectIndex;
-					}
-				}
-			}
-
-			if (!dynamicObj)
-			{
-				sdfData.sdfTextrues.emplace_back(sdf.buffer);
-			}
+			chunks::addObjectToChunks(sdfData.chunks, voxelSize, cascadeBounds, objectBounds, objectIndex);
 		}
 
 		inline auto fillFlood(uint32_t mipDispatchGroups,
@@ -573,15 +689,15 @@ namespace maple::sdf
 		}
 
 		inline auto system(ioc::Registry registry,
-			maple::component::CameraView& cameraView,
+			const maple::component::CameraView& cameraView,
 			maple::global::component::RenderDevice& renderDevice,
 			maple::component::RendererData& renderData,
 			global::component::GlobalDistanceField& sdfData,
 			global::component::GlobalDistanceFieldPublic& sdfPublic,
-			const global::component::SDFVisualizer& visualizer,
-			const maple::global::component::Profiler& profiler)
+			const global::component::SDFVisualizer& visualizer)
 		{
 			sdfPublic.sdfSet = visualizer.descriptors[0];
+			sdfPublic.query = sdfData.query;
 
 			auto group = registry.getRegistry().view<
 				maple::component::MeshRenderer,
@@ -612,13 +728,13 @@ namespace maple::sdf
 
 				if (sdfPublic.texture == nullptr || sdfPublic.texture->getWidth() != width)
 				{
-					sdfPublic.texture = Texture3D::create(width, sdfResolution, sdfResolution, { TextureFormat::R16F, TextureFilter::Linear, TextureWrap::ClampToEdge });
+					sdfPublic.texture = Texture3D::create(width, sdfResolution, sdfResolution, { TextureFormat::R16F, TextureFilter::Linear, TextureWrap::Repeat });
 				}
 
 				width = resolutionMip * cascadesCount;
 				if (sdfPublic.mipTexture == nullptr || sdfPublic.mipTexture->getWidth() != width)
 				{
-					sdfPublic.mipTexture = Texture3D::create(width, resolutionMip, resolutionMip, { TextureFormat::R16F, TextureFilter::Linear, TextureWrap::ClampToEdge });
+					sdfPublic.mipTexture = Texture3D::create(width, resolutionMip, resolutionMip, { TextureFormat::R16F, TextureFilter::Linear, TextureWrap::Repeat });
 					sdfData.mipTempTexture = Texture3D::create(resolutionMip, resolutionMip, resolutionMip, { TextureFormat::R16F, TextureFilter::Linear, TextureWrap::ClampToEdge });
 				}
 			}
@@ -635,10 +751,10 @@ namespace maple::sdf
 				renderDevice.device->clearRenderTarget(sdfData.mipTempTexture, renderData.commandBuffer, glm::vec4(1.f));
 			}
 
-			auto      viewPosition = glm::vec3(0.f);        //cameraView.cameraTransform->getWorldPosition();
-			glm::vec3 viewDirection = maple::FORWARD;        //cameraView.cameraTransform->getForwardDirection();
+			// the cascades follow the camera, scrolling by whole chunks as it moves.
+			auto      viewPosition = cameraView.valid ? cameraView.position : glm::vec3(0.f);
+			glm::vec3 viewDirection = cameraView.valid ? glm::normalize(glm::vec3(glm::inverse(cameraView.view) * glm::vec4(maple::FORWARD, 0.f))) : maple::FORWARD;
 			{
-				glm::vec3       viewDirection = maple::FORWARD;
 				const float     cascade0Distance = distanceExtent * cascadesDistanceScales[0];
 				const glm::vec2 viewRayHit = math::lineHitsAABB(viewPosition, viewPosition + viewDirection * (cascade0Distance * 2.0f), viewPosition - cascade0Distance, viewPosition + cascade0Distance);
 				const float     viewOriginOffset = (float)viewRayHit.y * cascade0Distance * 0.6f;
@@ -647,36 +763,59 @@ namespace maple::sdf
 
 			const int32_t rasterizeChunks = (int32_t)std::ceilf((float)sdfResolution / (float)CONSTS_SDF_RASTERIZE_CHUNK_SIZE);
 			sdfData.rasterizeChunks = rasterizeChunks;
+			MAPLE_ASSERT(sdfResolution % (2 * CONSTS_SDF_RASTERIZE_CHUNK_SIZE) == 0, "toroidal cascades scroll by whole chunks around a centered view");
 			const bool useCache = !updated;
 
-			const uint64_t cascadeFrequencies[] = { 2, 3, 5, 11 };
+			auto getCascadeVoxelSize = [&](int32_t cascadeIndex) {
+				return distanceExtent * cascadesDistanceScales[cascadeIndex] * 2 / (float)sdfResolution;
+			};
+			auto getMinChunk = [&](float voxelSize) {
+				return glm::ivec3(glm::floor(viewPosition / (voxelSize * CONSTS_SDF_RASTERIZE_CHUNK_SIZE))) - rasterizeChunks / 2;
+			};
+
+			std::vector<scheduler::CascadeRequest> requests(cascadesCount);
 			for (int32_t cascadeIndex = 0; cascadeIndex < cascadesCount; cascadeIndex++)
 			{
-				// Reduce frequency of the updates
-				if (useCache && (profiler.frameCount % cascadeFrequencies[cascadeIndex]) != 0)
+				const auto& cascade = sdfData.cascadeData[cascadeIndex];
+				const float voxelSize = getCascadeVoxelSize(cascadeIndex);
+				auto&       request = requests[cascadeIndex];
+				request.forced = !useCache || cascade.voxelSize != voxelSize;
+				request.enteringChunks = chunks::getEnteringChunks(cascade.minChunk, getMinChunk(voxelSize), rasterizeChunks);
+				request.dirtyChunks = static_cast<uint32_t>(cascade.dirtyChunks.size());
+			}
+
+			sdfData.scheduler.budgetMs = sdfPublic.updateBudget;
+			for (const int32_t cascadeIndex : sdfData.scheduler.schedule(requests))
+			{
+				const auto maxChunks = sdfData.scheduler.getChunkBudget(cascadeIndex);
+				if (maxChunks == 0)
 					continue;
 
 				auto& cascade = sdfData.cascadeData[cascadeIndex];
 				const float cascadeDistance = distanceExtent * cascadesDistanceScales[cascadeIndex];
 				const float cascadeMaxDistance = cascadeDistance * 2;
-				const float cascadeVoxelSize = cascadeMaxDistance / (float)sdfResolution;                //how many distance represented in a voxel.
+				const float cascadeVoxelSize = getCascadeVoxelSize(cascadeIndex);                        //how many distance represented in a voxel.
 				const float cascadeChunkSize = cascadeVoxelSize * CONSTS_SDF_RASTERIZE_CHUNK_SIZE;        // 32 voxel as a chunk.
 
-				const glm::vec3 center = glm::floor(viewPosition / cascadeChunkSize) * cascadeChunkSize;
-				BoundingBox     cascadeBounds(center - cascadeDistance, center + cascadeDistance);
-				const float     minObjectRadius = sdfPublic.minObjectRadius * sdfPublic.gloalScale;
+				const glm::ivec3 minChunk = getMinChunk(cascadeVoxelSize);
+				const glm::vec3  center = glm::vec3(minChunk + rasterizeChunks / 2) * cascadeChunkSize;
+				BoundingBox      cascadeBounds(center - cascadeDistance, center + cascadeDistance);
+				const float      minObjectRadius = sdfPublic.minObjectRadius * sdfPublic.gloalScale;
 
+				// a new voxel size moves every chunk, the ones holding data are cleared unless they are rasterized again.
+				const bool rescaled = useCache && cascade.voxelSize != cascadeVoxelSize;
+				if (!useCache || rescaled)
 				{
-					chunksCache.clear();
-					sdfData.sdfTextrues.clear();
+					chunks::resetCascade(cascade, minChunk, rasterizeChunks);
 				}
-
-				if (!(useCache && math::equals(cascade.position, center, glm::vec3(cascadeVoxelSize))))
+				const bool scrolled = useCache && !rescaled && cascade.minChunk != minChunk;
+				if (scrolled)
 				{
-					cascade.objects.clear();
-					cascade.staticChunks.clear();
+					chunks::scrollCascade(cascade, minChunk, rasterizeChunks);
 				}
 
+				sdfData.chunks.reset(rasterizeChunks, minChunk);
+
 				cascade.position = center;
 				cascade.voxelSize = cascadeVoxelSize;
 				cascade.bounds = cascadeBounds;
@@ -684,21 +823,28 @@ namespace maple::sdf
 				sdfData.objectsBufferCount = 0;
 				std::vector<ObjectRasterizeData> data;
 
-				for (auto entity : group.each())
-				{
-					auto [_, render, transform, sdf] = entity;
-					if (sdf.buffer == nullptr)
-						return;
+				// the stored boxes are fattened, the exact sphere test still decides.
+				sdfData.objectTree->query(cascadeBounds, [&](int32_t proxy) {
+					const auto entity = static_cast<entt::entity>(sdfData.objectTree->getUserData(proxy));
+					if (!group.contains(entity))
+						return true;
+
+					auto [render, transform, sdf] = group.get(entity);
+					if (sdf.atlas == nullptr)
+						return true;
 					BoundingBox    objectBounds = sdf.aabb.transform(transform.getWorldMatrix());
 					BoundingSphere sphereBox = objectBounds;
 					if (cascade.bounds.intersectsWithSphere(sphereBox) && sphereBox.radius >= minObjectRadius)
 					{
 						chunkCalculate(render, transform, sdf, cascade.voxelSize, cascadeBounds, sdf.aabb, sdfData, sdfPublic, data, cascadeIndex);
 					}
-				}
+					return true;
+				});
 
 				constexpr int32_t chunkDispatchGroups = CONSTS_SDF_RASTERIZE_CHUNK_SIZE / CONSTS_SDF_RASTERIZE_GROUP_SIZE;        //4
 
+				if (sizeof(ObjectRasterizeData) * data.size() > sdfData.sdfBuffer->getSize())
+					sdfData.sdfBuffer->resize(sizeof(ObjectRasterizeData) * data.size());
 				sdfData.sdfBuffer->setData(sizeof(ObjectRasterizeData) * data.size(), data.data());
 				sdfData.clearSets->setTexture("uGlobalSDF", sdfPublic.texture);
 				RasterizeConsts consts{};
@@ -707,124 +853,63 @@ namespace maple::sdf
 				{
 					glm::ivec3 chunkCoord;
 					int32_t    cascadeOffset;
+					glm::ivec3 cascadeTexelOffset;
+					int32_t    cascadeResolution;
 				};
-				PushConsts pushConsts = { {}, cascadeIndex * sdfData.resolution };
-
-				{
-					for (auto it = cascade.nonEmptyChunks.begin(); it != cascade.nonEmptyChunks.end();)
-					{        //when chunk merge or expand (like move object), so clear that chunk..
-						if (chunksCache.count(*it) > 0)
-						{
-							++it;
-							continue;
-						}
-
-						it = cascade.nonEmptyChunks.erase(it);
-						if (it == cascade.nonEmptyChunks.end())
-							break;
-
-						consts.chunkcoord = it->coord * CONSTS_SDF_RASTERIZE_CHUNK_SIZE;
-						Renderer::dispatch(
-							renderData.commandBuffer,
-							chunkDispatchGroups,
-							chunkDispatchGroups,
-							chunkDispatchGroups, sdfData.clearPipeline.get(), &pushConsts, { sdfData.clearSets });
-						anyChunkDispatch = true;
-					}
-				}
+				PushConsts pushConsts = { {}, cascadeIndex * sdfData.resolution, cascade.texelOffset, sdfData.resolution };
 
-				for (auto it = chunksCache.begin(); it != chunksCache.end(); ++it)
-				{
-					if (it->first.layer == 0)
-					{
-						if (it->second.dynamic)
-						{
-							cascade.staticChunks.erase(it->first);
-						}
-						else if (cascade.staticChunks.count(it->first) > 0)
-						{
-							auto key = it->first;
-							while (chunksCache.erase(key) > 0)
-								key.nextLayer();
-						}
-						else
-						{
-							cascade.staticChunks.emplace(it->first);
-						}
-					}
-				}
+				std::vector<chunks::ChunkDispatch> dispatches;
+				const auto deferred = chunks::planChunkDispatches(cascade, sdfData.chunks, rasterizeChunks, maxChunks, dispatches);
 
 				ModelsData modelData;
 				modelData.cascadecoordToPosMul = cascadeBounds.size() / (float)sdfData.resolution;
 				modelData.cascadecoordToPosAdd = cascadeBounds.min + cascadeVoxelSize * 0.5f; //convert to voxel center.
 				modelData.maxDistance = cascadeMaxDistance;
 				modelData.cascadeResolution = sdfData.resolution;
+				modelData.cascadeTexelOffset = cascade.texelOffset;
 				modelData.cascadeIndex = cascadeIndex;
 
 				sdfData.sets[cascadeIndex]->setStorageBuffer("SDFObjectData", sdfData.sdfBuffer);
 				sdfData.sets[cascadeIndex]->setTexture("uGlobalSDF", sdfPublic.texture);
 				sdfData.sets[cascadeIndex]->setUniformBufferData("ModelsRasterizeData", &modelData, true);
-				sdfData.sets[cascadeIndex]->setTexture("uMeshSDF", sdfData.sdfTextrues);
+				sdfData.sets[cascadeIndex]->setTexture("uMeshSDF", sdfData.atlas->getPages());
 
-				for (const auto& chunk : chunksCache)
+				uint32_t rasterized = 0;
+				for (const auto& dispatch : dispatches)
 				{
-					if (chunk.first.layer == 0)        //first layer..
+					if (dispatch.type == chunks::ChunkDispatch::Type::Clear)
 					{
-						cascade.nonEmptyChunks.emplace(chunk.first);
-						consts.chunkcoord = chunk.first.coord * CONSTS_SDF_RASTERIZE_CHUNK_SIZE;
-						consts.objectsCount = chunk.second.modelsCount;
-						if (chunk.second.modelsCount > 0)
-						{
-							memcpy(consts.objects, chunk.second.models, sizeof(uint32_t) * consts.objectsCount);
-							Renderer::dispatch(
-								renderData.commandBuffer,
-								chunkDispatchGroups,
-								chunkDispatchGroups,
-								chunkDispatchGroups, sdfData.pipelineNoRead.get(), &consts, { sdfData.sets[cascadeIndex] });
-						}
-						else
-						{
-							pushConsts.chunkCoord = chunk.first.coord * CONSTS_SDF_RASTERIZE_CHUNK_SIZE;
-							//clear..
-							Renderer::dispatch(
-								renderData.commandBuffer,
-								chunkDispatchGroups,
-								chunkDispatchGroups,
-								chunkDispatchGroups, sdfData.clearPipeline.get(), &pushConsts, { sdfData.clearSets });
-						}
-
-						anyChunkDispatch = true;
+						pushConsts.chunkCoord = dispatch.coord * CONSTS_SDF_RASTERIZE_CHUNK_SIZE;
+						Renderer::dispatch(
+							renderData.commandBuffer,
+							chunkDispatchGroups,
+							chunkDispatchGroups,
+							chunkDispatchGroups, sdfData.clearPipeline.get(), &pushConsts, { sdfData.clearSets });
 					}
-				}
-
-				for (const auto& chunk : chunksCache)
-				{
-					//additive layers, combine with existing chunk data
-					if (chunk.first.layer != 0 && chunk.second.modelsCount > 0)
+					else
 					{
-						cascade.nonEmptyChunks.emplace(chunk.first);
-						consts.objectsCount = chunk.second.modelsCount;
-						consts.chunkcoord = chunk.first.coord * CONSTS_SDF_RASTERIZE_CHUNK_SIZE;
-						memcpy(consts.objects, chunk.second.models, sizeof(uint32_t) * consts.objectsCount);
-
-						if (chunk.second.modelsCount != 0)
-						{
-							Renderer::dispatch(
-								renderData.commandBuffer,
-								chunkDispatchGroups,
-								chunkDispatchGroups,
-								chunkDispatchGroups, sdfData.pipeline.get(), &consts, { sdfData.sets[cascadeIndex] });
-
-							anyChunkDispatch = true;
-						}
+						consts.chunkcoord = dispatch.coord * CONSTS_SDF_RASTERIZE_CHUNK_SIZE;
+						consts.objectsCount = dispatch.chunk->modelsCount;
+						memcpy(consts.objects, dispatch.chunk->models, sizeof(uint32_t) * consts.objectsCount);
+						Renderer::dispatch(
+							renderData.commandBuffer,
+							chunkDispatchGroups,
+							chunkDispatchGroups,
+							chunkDispatchGroups,
+							dispatch.type == chunks::ChunkDispatch::Type::Rasterize ? sdfData.pipelineNoRead.get() : sdfData.pipeline.get(),
+							&consts, { sdfData.sets[cascadeIndex] });
+						rasterized++;
 					}
+					anyChunkDispatch = true;
 				}
+				sdfData.scheduler.complete(cascadeIndex, rasterized, deferred);
 
-				if (anyChunkDispatch || updated)
+				if (anyChunkDispatch || updated || scrolled || rescaled)
 				{
 					const int32_t mipDispatchGroups = math::divideAndRoundUp(resolutionMip, CONSTS_SDF_MIP_GROUP_SIZE);
 
 					GlobalSDFMipmapPushConsts pushConsts{
+						cascade.texelOffset / CONSTS_SDF_RASTERIZE_MIP_FACTOR,
 						sdfResolution,
 						CONSTS_SDF_RASTERIZE_MIP_FACTOR,
 						cascadeIndex * sdfResolution,
@@ -835,7 +920,7 @@ namespace maple::sdf
 					sdfData.set0->setTexture("uGlobalMipSDF", sdfPublic.mipTexture);
 					Renderer::dispatch(renderData.commandBuffer, mipDispatchGroups, mipDispatchGroups, mipDispatchGroups, sdfData.pipelineMip.get(), &pushConsts, { sdfData.set0 });
 
-					if (!chunksCache.empty())
+					if (!sdfData.chunks.empty())
 					{
 						fillFlood(mipDispatchGroups, cascadeIndex, resolutionMip, pushConsts, sdfData, sdfPublic, renderData);
 					}
@@ -843,6 +928,7 @@ namespace maple::sdf
 					sdfPublic.sdfCommonData.cascadeVoxelSize[cascadeIndex] = cascadeVoxelSize;
 					sdfPublic.sdfCommonData.cascadePosDistance[cascadeIndex] = {
 						center, cascadeDistance };
+					sdfPublic.sdfCommonData.cascadeUVOffset[cascadeIndex] = glm::vec4(glm::vec3(cascade.texelOffset) / (float)sdfResolution, 0.f);
 				}
 			}
 		}
@@ -852,8 +938,11 @@ namespace maple::sdf
 	{
 		builder->registerGlobalComponent<global::component::GlobalDistanceField>([](auto& field) {
 			field.sdfBuffer = StorageBuffer::create(CONSTS_SDF_RASTERIZE_MODEL_SET_MAX_COUNT * sizeof(ObjectRasterizeData), nullptr, { false, MemoryUsage::MEMORY_USAGE_CPU_TO_GPU });
-			field.shader = Shader::create("shaders/SDF/SDFRasterizeModel.shader", { {"uMeshSDF", CONSTS_SDF_RASTERIZE_MODEL_SET_MAX_COUNT} });
-			field.shaderNoRead = Shader::create("shaders/SDF/SDFRasterizeModelNoRead.shader", { {"uMeshSDF", CONSTS_SDF_RASTERIZE_MODEL_SET_MAX_COUNT} });
+			field.atlas = std::make_shared<atlas::MeshSDFAtlas>();
+			field.streaming = std::make_shared<streaming::ResidencyManager>();
+			field.query = std::make_shared<query::DistanceQuery>(field.objectTree);
+			field.shader = Shader::create("shaders/SDF/SDFRasterizeModel.shader", { {"uMeshSDF", atlas::MaxPages} });
+			field.shaderNoRead = Shader::create("shaders/SDF/SDFRasterizeModelNoRead.shader", { {"uMeshSDF", atlas::MaxPages} });
 
 			PipelineInfo info;
 			//######################################################
@@ -867,7 +956,7 @@ namespace maple::sdf
 			//#####################################################
 			for (auto i = 0; i < 4; i++)
 			{
-				field.sets[i] = DescriptorSet::create({ 0, field.shader.get(), 1, nullptr, CONSTS_SDF_RASTERIZE_MODEL_SET_MAX_COUNT });
+				field.sets[i] = DescriptorSet::create({ 0, field.shader.get(), 1, nullptr, atlas::MaxPages });
 			}
 
 			field.shaderMip = Shader::create("shaders/SDF/GlobalSDFMipmap.shader");
@@ -887,7 +976,9 @@ namespace maple::sdf
 			field.clearSets = DescriptorSet::create({ 0, field.clearShader.get() });
 			});
 		builder->registerGlobalComponent<global::component::GlobalDistanceFieldPublic>();
+		builder->onDestory<component::MeshDistanceField, delegates::onMeshDistanceFieldDestroy>();
 		builder->registerWithinQueue<generate_sdf::system>(render);
+		builder->registerWithinQueue<stream_sdf::system>(render);
 		builder->registerWithinQueue<merge_sdf::system>(render);
 		builder->registerWithinQueue<on_scene_changed::system>(begin);
 		builder->registerOnImGui<on_imgui::system>();
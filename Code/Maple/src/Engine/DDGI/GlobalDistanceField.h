@@ -6,6 +6,7 @@
 #include "RHI/DescriptorSet.h"
 #include "RHI/Texture.h"
 #include "SDFBaker.h"
+#include "SDFQuery.h"
 #include "IoC/SystemBuilder.h"
 #include "SurfaceAtlasTile.h"
 
@@ -24,6 +25,7 @@ namespace maple::sdf
 		float     resolution;
 		float     nearPlane;
 		float     farPlane;
+		glm::vec4 cascadeUVOffset[4];        //toroidal origin of every cascade in its own uvw
 	};
 
 	namespace global::component
@@ -37,6 +39,9 @@ namespace maple::sdf
 			GlobalSDFData          sdfCommonData;
 			GlobalSurfaceAtlasData globalSurfaceAtlasData{};
 			float                  giDistance = 4000;
+			float                  streamingBudget = 128;        // MB of mesh sdf mips kept in the atlas
+			float                  updateBudget    = 2;          // ms of estimated cascade rasterization per frame
+			std::shared_ptr<query::DistanceQuery> query;         // cpu distance and ray queries over the loaded mesh distance fields
 			Texture3D::Ptr         texture;
 			Texture3D::Ptr         mipTexture;
 		};
@@ -461,7 +461,7 @@ namespace maple::sdf
 					auto [entity, render, transform, sdf] = obj;
 					BoundingBox    objectBounds = sdf.aabb.transform(transform.getWorldMatrix());
 					BoundingSphere sphereBox = objectBounds;
-					auto           objToView = glm::distance(objectBounds.center(), cameraView.cameraTransform->getWorldPosition());
+					auto           objToView = glm::distance(objectBounds.center(), cameraView.position);
 
 					if (sphereBox.radius >= minObjectRadius && objToView < distance)
 					{
@@ -625,7 +625,7 @@ namespace maple::sdf
 					surface.cullingDescriptor->setStorageBuffer("SDFCullObjectBuffer", surfacePublic.culledObjectsBuffer);
 
 					// Cull objects into chunks (1 thread per chunk)
-					field.globalSurfaceAtlasData.cameraPos = cameraView.cameraTransform->getWorldPosition();
+					field.globalSurfaceAtlasData.cameraPos = cameraView.position;
 					field.globalSurfaceAtlasData.culledObjectsCapacity = surface.objectsBufferCapacity;
 					field.globalSurfaceAtlasData.resolution = surface.resolution;
 					field.globalSurfaceAtlasData.chunkSize = giDistance / GLOBAL_SURFACE_ATLAS_CHUNKS_RESOLUTION;
@@ -943,7 +943,7 @@ namespace maple::sdf
 						if (surface.vertexBufferArray.empty())
 							continue;
 
-						surface.deferredLightDescriptor->setUniform("UniformBufferObject", "cameraPos", glm::value_ptr(glm::vec4(cameraView.cameraTransform->getWorldPosition(), surface.shadowBias)), true);
+						surface.deferredLightDescriptor->setUniform("UniformBufferObject", "cameraPos", glm::value_ptr(glm::vec4(cameraView.position, surface.shadowBias)), true);
 						surface.deferredLightDescriptor->setUniform("UniformBufferObject", "light", &light.lightData, true);
 						surface.deferredLightDescriptor->setUniform("UniformBufferObject", "data", &sdfPublic.sdfCommonData, true);
 						surface.deferredLightDescriptor->update(renderData.commandBuffer);
@@ -1036,7 +1036,7 @@ namespace maple::sdf
 					surface.indirectLightDescriptor->setTexture("uNormalSampler", surfacePublic.surfaceGBuffer1);
 					surface.indirectLightDescriptor->setTexture("uPBRSampler", surfacePublic.surfaceGBuffer2);
 					surface.indirectLightDescriptor->setUniformBufferData("DDGIUBO", &uniform);
-					auto cameraPos = glm::vec4(cameraView.cameraTransform->getWorldPosition(), volume.intensity);
+					auto cameraPos = glm::vec4(cameraView.position, volume.intensity);
 					surface.indirectLightDescriptor->setUniform("UniformBufferObject", "cameraPos", glm::value_ptr(cameraPos));
 					surface.indirectLightDescriptor->update(renderData.commandBuffer);
 					surface.vertexBufferArray.clear();
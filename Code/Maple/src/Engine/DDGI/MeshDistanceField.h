@@ -3,18 +3,17 @@
 //////////////////////////////////////////////////////////////////////////////
 #pragma once
 #include "Math/BoundingBox.h"
+#include "SDFAtlas.h"
 #include "SDFBaker.h"
 #include <memory>
 
 namespace maple
 {
-	class Texture3D;
-
 	namespace sdf::component
 	{
 		struct MeshDistanceField
 		{
-			std::shared_ptr<Texture3D> buffer;
+			std::shared_ptr<atlas::Entry> atlas;        // regions in the MeshSDFAtlas, null until loaded
 
 			std::string bakedPath;
 			BoundingBox aabb;//padded...
@@ -0,0 +1,132 @@
+//////////////////////////////////////////////////////////////////////////////
+// This file is part of the Maple Engine                              		//
+//////////////////////////////////////////////////////////////////////////////
+
+#include "SDFAtlas.h"
+#include "MeshDistanceField.h"
+#include "SDFContainer.h"
+
+#include "RHI/CommandBuffer.h"
+#include "RHI/Texture.h"
+
+namespace maple
+{
+	namespace sdf::atlas
+	{
+		auto MeshSDFAtlas::makeRegion(const Allocation &allocation) const -> Region
+		{
+			const glm::vec3 page   = allocator.getPageSize();
+			const glm::vec3 offset = allocation.offset;
+			const glm::vec3 size   = allocation.size;
+
+			Region region;
+			region.allocation = allocation;
+			region.uvwMul     = size / page;
+			region.uvwAdd     = offset / page;
+			region.uvwMin     = (offset + 0.5f) / page;
+			region.uvwMax     = (offset + size - 0.5f) / page;
+			return region;
+		}
+
+		auto MeshSDFAtlas::load(component::MeshDistanceField &field, const CommandBuffer *cmd, uint32_t residentMip) -> bool
+		{
+			container::MappedFile file;
+			std::string           error;
+			if (!file.open(field.bakedPath, error))
+			{
+				LOGE("invalid MeshDistanceField {} : {}", field.bakedPath, error);
+				return false;
+			}
+
+			const auto &header = file.getHeader();
+
+			// regions go back to the allocator when the last copy of the field releases them.
+			std::shared_ptr<Entry> entry(new Entry(), [atlas = weak_from_this()](Entry *entry) {
+				if (auto self = atlas.lock())
+				{
+					for (auto mip = entry->residentMip; mip < entry->mips.size(); mip++)
+						self->allocator.free(entry->mips[mip].allocation);
+				}
+				delete entry;
+			});
+
+			entry->path = field.bakedPath;
+			for (uint32_t mipLevel = 0; mipLevel < header.mipCount; mipLevel++)
+			{
+				const auto &desc = header.mips[mipLevel];
+				entry->mips.emplace_back().allocation.size = {desc.width, desc.height, desc.depth};
+			}
+			entry->residentMip = header.mipCount;
+
+			const CommandBuffer *cmd1 = cmd;
+			CommandBuffer::Ptr   onceCmd;
+			if (cmd == nullptr)
+			{
+				onceCmd = CommandBuffer::create();
+				onceCmd->init(true);
+				onceCmd->beginRecording();
+				cmd1 = onceCmd.get();
+			}
+
+			const auto           firstMip = std::min(residentMip, header.mipCount - 1);
+			std::vector<uint8_t> decoded;
+			for (auto mipLevel = header.mipCount; mipLevel-- > firstMip;)
+			{
+				if (!upload(*entry, mipLevel, file.getMip(mipLevel, decoded), cmd1))
+				{
+					const auto &size = entry->mips[mipLevel].allocation.size;
+					LOGW("MeshDistanceField atlas is full, can not place {} mip {} ({}x{}x{})", field.bakedPath, mipLevel, size.x, size.y, size.z);
+					break;
+				}
+			}
+
+			if (cmd == nullptr)
+			{
+				onceCmd->endSingleTimeCommands();
+			}
+
+			if (entry->residentMip == header.mipCount)
+				return false;
+
+			// the file is authoritative, a field restored from an older scene may carry stale bounds.
+			const BoundingBox aabb{header.aabbMin, header.aabbMax};
+			field.aabb          = aabb;
+			field.localToUVWMul = 1.f / aabb.size();
+			field.localToUVWAdd = -aabb.min / aabb.size();
+			field.maxDistance   = header.maxDistance;
+			field.atlas         = entry;
+			return true;
+		}
+
+		auto MeshSDFAtlas::upload(Entry &entry, uint32_t mipLevel, const void *data, const CommandBuffer *cmd) -> bool
+		{
+			MAPLE_ASSERT(mipLevel + 1 == entry.residentMip, "mips become resident from coarse to fine");
+
+			Allocation allocation;
+			if (!allocator.allocate(entry.mips[mipLevel].allocation.size, allocation))
+				return false;
+
+			while (allocation.page >= pages.size())
+			{
+				const auto &size = allocator.getPageSize();
+				pages.emplace_back(Texture3D::create(size.x, size.y, size.z, {TextureFormat::R16, TextureFilter::Linear, TextureWrap::ClampToEdge}));
+			}
+
+			std::static_pointer_cast<Texture3D>(pages[allocation.page])->updateRegion(cmd, data, allocation.offset.x, allocation.offset.y, allocation.offset.z, allocation.size.x, allocation.size.y, allocation.size.z);
+
+			entry.mips[mipLevel] = makeRegion(allocation);
+			entry.residentMip    = mipLevel;
+			return true;
+		}
+
+		auto MeshSDFAtlas::evict(Entry &entry) -> bool
+		{
+			if (entry.residentMip + 1 >= entry.mips.size())
+				return false;
+
+			allocator.free(entry.mips[entry.residentMip].allocation);
+			entry.residentMip++;
+			return true;
+		}
+	};        // namespace sdf::atlas
+}        // namespace maple
@@ -0,0 +1,113 @@
+//////////////////////////////////////////////////////////////////////////////
+// This file is part of the Maple Engine                              		//
+//////////////////////////////////////////////////////////////////////////////
+#pragma once
+#include "Engine/Core.h"
+#include "SDFAtlasAllocator.h"
+
+#include <glm/glm.hpp>
+#include <algorithm>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace maple
+{
+	class Texture;
+	class CommandBuffer;
+
+	namespace sdf::component
+	{
+		struct MeshDistanceField;
+	}
+
+	/**
+	 * packs every mesh distance field and its mips into a few large volumes (pages),
+	 * so the rasterizer binds the pages once instead of one texture per object.
+	 */
+	namespace sdf::atlas
+	{
+		/**
+		 * where one mip of a field lives. uvwMul/Add map the field's 0..1 uvw into the page,
+		 * uvwMin/Max are the outer texel centers, clamping to them matches the old per texture ClampToEdge.
+		 */
+		struct Region
+		{
+			Allocation allocation;
+			glm::vec3  uvwMul;
+			glm::vec3  uvwAdd;
+			glm::vec3  uvwMin;
+			glm::vec3  uvwMax;
+		};
+
+		/**
+		 * regions of one field, released back to the atlas when the last copy of the field goes away.
+		 * levels finer than residentMip stay in the baked file until sdf::streaming brings them in,
+		 * their region only carries the size.
+		 */
+		struct Entry
+		{
+			std::string         path;
+			std::vector<Region> mips;
+			uint32_t            residentMip = 0;
+			bool                streaming   = false;        // a finer level is being read
+			bool                tracked     = false;        // listed by sdf::streaming, it holds a streamed level
+
+			// the requested level, or the finest resident one when it is not in the atlas.
+			inline auto getRegion(uint32_t mip) const -> const Region &
+			{
+				return mips[std::min<size_t>(std::max(mip, residentMip), mips.size() - 1)];
+			}
+
+			inline auto getMipBytes(uint32_t mip) const -> uint64_t
+			{
+				const auto &size = mips[mip].allocation.size;
+				return uint64_t(size.x) * size.y * size.z * sizeof(uint16_t);
+			}
+		};
+
+		class MAPLE_EXPORT MeshSDFAtlas : public std::enable_shared_from_this<MeshSDFAtlas>
+		{
+		  public:
+			/**
+			 * maps the field's baked file and copies the mips from the coarsest down to residentMip into regions of
+			 * the pages, creating pages on demand. on success field.atlas holds the regions and the bounds are
+			 * refreshed from the file.
+			 */
+			auto load(component::MeshDistanceField &field, const CommandBuffer *cmd, uint32_t residentMip = 0) -> bool;
+
+			/**
+			 * makes mipLevel resident from its file payload, it has to be the level right above entry.residentMip.
+			 * returns false when the atlas has no room for it.
+			 */
+			auto upload(Entry &entry, uint32_t mipLevel, const void *data, const CommandBuffer *cmd) -> bool;
+
+			/**
+			 * releases the finest resident level, the coarsest one always stays. returns false when nothing was released.
+			 */
+			auto evict(Entry &entry) -> bool;
+
+			inline auto getResidentBytes() const -> uint64_t
+			{
+				return allocator.getUsedTexels() * sizeof(uint16_t);
+			}
+
+			// bound as one array, indexed by Region::allocation.page.
+			inline auto &getPages() const
+			{
+				return pages;
+			}
+
+			inline auto &getAllocator() const
+			{
+				return allocator;
+			}
+
+		  private:
+			auto makeRegion(const Allocation &allocation) const -> Region;
+
+			AtlasAllocator                          allocator;
+			std::vector<std::shared_ptr<Texture>>   pages;
+		};
+	};        // namespace sdf::atlas
+}        // namespace maple
@@ -0,0 +1,126 @@
+//////////////////////////////////////////////////////////////////////////////
+// This file is part of the Maple Engine                              		//
+//////////////////////////////////////////////////////////////////////////////
+
+#include "SDFAtlasAllocator.h"
+
+namespace maple
+{
+	namespace sdf::atlas
+	{
+		namespace
+		{
+			inline auto toBlocks(const glm::uvec3 &size)
+			{
+				return (size + glm::uvec3(BlockSize - 1)) / BlockSize;
+			}
+		}        // namespace
+
+		AtlasAllocator::AtlasAllocator(const glm::uvec3 &pageSize, uint32_t maxPages) :
+		    pageSize(pageSize), blockCount(toBlocks(pageSize)), maxPages(maxPages)
+		{
+		}
+
+		auto AtlasAllocator::allocate(const glm::uvec3 &size, Allocation &allocation) -> bool
+		{
+			const auto blocks = toBlocks(size);
+			if (glm::any(glm::equal(size, glm::uvec3(0))) || glm::any(glm::greaterThan(blocks, blockCount)))
+				return false;
+
+			glm::uvec3 position;
+			uint32_t   page = 0;
+			for (; page < pages.size(); page++)
+			{
+				if (fit(page, blocks, position))
+					break;
+			}
+
+			if (page == pages.size())
+			{
+				if (pages.size() == maxPages)
+					return false;
+				pages.emplace_back(blockCount.x * blockCount.y * blockCount.z, 0);
+				position = glm::uvec3(0);
+			}
+
+			allocation.page   = page;
+			allocation.offset = position * BlockSize;
+			allocation.size   = size;
+			mark(allocation, 1);
+			usedBlocks += blocks.x * blocks.y * blocks.z;
+			allocations++;
+			return true;
+		}
+
+		auto AtlasAllocator::free(const Allocation &allocation) -> void
+		{
+			const auto blocks = toBlocks(allocation.size);
+			mark(allocation, 0);
+			usedBlocks -= blocks.x * blocks.y * blocks.z;
+			allocations--;
+		}
+
+		auto AtlasAllocator::fit(uint32_t page, const glm::uvec3 &blocks, glm::uvec3 &position) -> bool
+		{
+			// summed[x, y, z] holds the occupied blocks in [0, x) * [0, y) * [0, z).
+			const glm::uvec3 s = blockCount + 1u;
+			summed.assign(s.x * s.y * s.z, 0);
+
+			auto at = [&](uint32_t x, uint32_t y, uint32_t z) -> uint32_t & {
+				return summed[x + y * s.x + z * s.x * s.y];
+			};
+
+			const auto &occupancy = pages[page];
+			for (uint32_t z = 1; z < s.z; z++)
+			{
+				for (uint32_t y = 1; y < s.y; y++)
+				{
+					for (uint32_t x = 1; x < s.x; x++)
+					{
+						const uint32_t used = occupancy[(x - 1) + (y - 1) * blockCount.x + (z - 1) * blockCount.x * blockCount.y];
+						at(x, y, z)         = used + at(x - 1, y, z) + at(x, y - 1, z) + at(x, y, z - 1) - at(x - 1, y - 1, z) - at(x - 1, y, z - 1) - at(x, y - 1, z - 1) + at(x - 1, y - 1, z - 1);
+					}
+				}
+			}
+
+			if (at(blockCount.x, blockCount.y, blockCount.z) + blocks.x * blocks.y * blocks.z > blockCount.x * blockCount.y * blockCount.z)
+				return false;
+
+			for (uint32_t z = 0; z + blocks.z <= blockCount.z; z++)
+			{
+				for (uint32_t y = 0; y + blocks.y <= blockCount.y; y++)
+				{
+					for (uint32_t x = 0; x + blocks.x <= blockCount.x; x++)
+					{
+						const uint32_t x1 = x + blocks.x, y1 = y + blocks.y, z1 = z + blocks.z;
+
+						const uint32_t used = at(x1, y1, z1) - at(x, y1, z1) - at(x1, y, z1) - at(x1, y1, z) + at(x, y, z1) + at(x, y1, z) + at(x1, y, z) - at(x, y, z);
+						if (used == 0)
+						{
+							position = {x, y, z};
+							return true;
+						}
+					}
+				}
+			}
+			return false;
+		}
+
+		auto AtlasAllocator::mark(const Allocation &allocation, uint8_t value) -> void
+		{
+			const auto begin = allocation.offset / BlockSize;
+			const auto end   = begin + toBlocks(allocation.size);
+			auto &     page  = pages[allocation.page];
+			for (uint32_t z = begin.z; z < end.z; z++)
+			{
+				for (uint32_t y = begin.y; y < end.y; y++)
+				{
+					for (uint32_t x = begin.x; x < end.x; x++)
+					{
+						page[x + y * blockCount.x + z * blockCount.x * blockCount.y] = value;
+					}
+				}
+			}
+		}
+	};        // namespace sdf::atlas
+}        // namespace maple
@@ -0,0 +1,76 @@
+//////////////////////////////////////////////////////////////////////////////
+// This file is part of the Maple Engine                              		//
+//////////////////////////////////////////////////////////////////////////////
+#pragma once
+#include "Engine/Core.h"
+
+#include <glm/glm.hpp>
+#include <vector>
+
+namespace maple
+{
+	// the cpu side of sdf::atlas, no rhi types so tools and tests can use it.
+	namespace sdf::atlas
+	{
+		static constexpr uint32_t BlockSize = 8;        // allocation granularity in texels
+		static constexpr uint32_t PageSize  = 256;
+		static constexpr uint32_t MaxPages  = 8;
+
+		struct Allocation
+		{
+			uint32_t   page = 0;
+			glm::uvec3 offset{};        // texels
+			glm::uvec3 size{};          // texels, as requested
+		};
+
+		/**
+		 * cpu side first fit allocator over a block occupancy grid per page.
+		 * a summed volume table of the occupancy is rebuilt per allocation, so testing whether a box is free is O(1)
+		 * and one allocation costs two passes over the blocks of a page. results only depend on the call order.
+		 */
+		class MAPLE_EXPORT AtlasAllocator
+		{
+		  public:
+			AtlasAllocator(const glm::uvec3 &pageSize = glm::uvec3(PageSize), uint32_t maxPages = MaxPages);
+
+			/**
+			 * returns false when no page (existing or new, up to maxPages) has room for size.
+			 */
+			auto allocate(const glm::uvec3 &size, Allocation &allocation) -> bool;
+			auto free(const Allocation &allocation) -> void;
+
+			inline auto getPageSize() const -> const glm::uvec3 &
+			{
+				return pageSize;
+			}
+
+			inline auto getPageCount() const -> uint32_t
+			{
+				return static_cast<uint32_t>(pages.size());
+			}
+
+			// texels covered by live allocations, rounded up to blocks.
+			inline auto getUsedTexels() const -> uint64_t
+			{
+				return usedBlocks * BlockSize * BlockSize * BlockSize;
+			}
+
+			inline auto getAllocationCount() const -> uint32_t
+			{
+				return allocations;
+			}
+
+		  private:
+			auto fit(uint32_t page, const glm::uvec3 &blocks, glm::uvec3 &position) -> bool;
+			auto mark(const Allocation &allocation, uint8_t value) -> void;
+
+			glm::uvec3                        pageSize;
+			glm::uvec3                        blockCount;
+			uint32_t                          maxPages;
+			std::vector<std::vector<uint8_t>> pages;
+			std::vector<uint32_t>             summed;
+			uint64_t                          usedBlocks  = 0;
+			uint32_t                          allocations = 0;
+		};
+	};        // namespace sdf::atlas
+}        // namespace maple
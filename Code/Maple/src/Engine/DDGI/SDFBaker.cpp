@@ -4,41 +4,58 @@
 
 #include "SDFBaker.h"
 #include "MeshDistanceField.h"
+#include "SDFCache.h"
+#include "SDFContainer.h"
 
 #include "Engine/Core.h"
-#include "Engine/Mesh.h"
+#include "Engine/JobSystem.h"
+#include "Engine/Profiler.h"
+#include "Engine/Vertex.h"
 #include "Math/MathUtils.h"
 #include "Others/Console.h"
 #include "Others/Timer.h"
-#include "RHI/CommandBuffer.h"
-#include "RHI/Texture.h"
-#include "Scene/Component/Transform.h"
 #include <bvh_tree.h>
 #include <glm/gtc/packing.hpp>
 
-#include "IO/Serialization.h"
-#include <cereal/archives/binary.hpp>
-#include <cereal/types/vector.hpp>
-#include <fstream>
+#include <algorithm>
+#include <filesystem>
+#include <limits>
+#include <thread>
 
 namespace maple
 {
 	namespace sdf::baker
 	{
-		inline auto getMipLevels(int32_t width, int32_t height, int32_t depth)
+		/**
+		 * runs the parallel parts of the bvh build as JobSystem jobs, so baking many meshes at once does not spawn threads.
+		 */
+		class JobExecutor : public acc::Executor
+		{
+		  public:
+			auto run(std::size_t numTasks, const std::function<void(std::size_t)> &task) const -> void override
+			{
+				JobSystem::Context context;
+				JobSystem::dispatch(context, static_cast<uint32_t>(numTasks), 1, [&](JobSystem::JobDispatchArgs args) {
+					task(args.jobIndex);
+				});
+				JobSystem::wait(context);
+			}
+		};
+
+		/**
+		 * quantizes a normalized distance to half without increasing its magnitude, so lower bounds stay lower bounds.
+		 */
+		inline auto packConservative(float distance) -> uint16_t
 		{
-			int32_t result = 1;
-			while (width > 1 || height > 1 || depth > 1)
+			const float stored = (distance + 1.f) / 2.f;
+			uint16_t    half   = glm::packHalf1x16(stored);
+			const float packed = glm::unpackHalf1x16(half) * 2.f - 1.f;
+			if (std::abs(packed) > std::abs(distance))
 			{
-				if (width > 1)
-					width >>= 1;
-				if (height > 1)
-					height >>= 1;
-				if (depth > 1)
-					depth >>= 1;
-				result++;
+				// stored is in [0, 1], moving the bits towards 0.5 shrinks the magnitude.
+				half = stored > 0.5f ? half - 1 : half + 1;
 			}
-			return result;
+			return half;
 		}
 
 		/**
@@ -49,12 +66,26 @@ namespace maple
 			return position.x + position.y * resolution.x + position.z * resolution.x * resolution.y;
 		};
 
-		auto bake(const std::shared_ptr<Mesh> &mesh, const SDFBakerConfig &config, component::MeshDistanceField &field, const maple::component::Transform &transform) -> void
+		auto makeGeometry(const std::string &name, const std::vector<Vertex> &vertices, const std::vector<uint32_t> &indices) -> MeshGeometry
 		{
-			auto meshAABB = mesh->getBoundingBox();
+			MeshGeometry geometry;
+			geometry.name    = name;
+			geometry.indices = indices;
+			geometry.positions.resize(vertices.size());
+			std::transform(vertices.begin(), vertices.end(), geometry.positions.begin(), [](const auto &v) {
+				return v.pos;
+			});
+			return geometry;
+		}
+
+		auto bake(const MeshGeometry &geometry, const SDFBakerConfig &config, component::MeshDistanceField &field, BakeProgress *progress) -> bool
+		{
+			BoundingBox meshAABB;
+			for (auto &position : geometry.positions)
+				meshAABB.merge(position);
 
 			glm::uvec3 sdfSize{};
-			const auto bbExtents = meshAABB->size();
+			const auto bbExtents = meshAABB.size();
 			for (int32_t component = 0; component < 3; component++)
 			{
 				float targetRes    = bbExtents[component] / config.targetTexelPerMeter;
@@ -62,25 +93,42 @@ namespace maple
 				sdfSize[component] = glm::clamp(targetRes, (float) config.minResolution, (float) config.maxResolution);
 			}
 
-			std::vector<glm::vec3> positions;
-			positions.resize(mesh->getVertex().size());
+			BoundingBox paddingAABB = paddingSDFBox(meshAABB);
+			const float maxDistance = math::max3(paddingAABB.size());
 
-			std::transform(mesh->getVertex().begin(), mesh->getVertex().end(), positions.begin(), [](const auto &v) {
-				return v.pos;
-			});
+			const auto key       = cache::getKey(geometry, config);
+			const auto cachePath = cache::getPath(key);
+
+			auto applyField = [&]() {
+				field.aabb          = paddingAABB;
+				field.localToUVWMul = 1.f / paddingAABB.size();
+				field.localToUVWAdd = -paddingAABB.min / paddingAABB.size();
+				field.maxDistance   = maxDistance;
+				field.bakedPath     = cachePath;
+				cache::touch(key, geometry.name);
+			};
+
+			std::error_code error;
+			if (std::filesystem::exists(cachePath, error))
+			{
+				applyField();
+				return true;
+			}
+
+			LOGI("Baking MeshDistanceField : {} ", geometry.name);
 
-			BoundingBox paddingAABB = paddingSDFBox(*meshAABB);
+			const auto &indices   = geometry.indices;
+			const auto &positions = geometry.positions;
 
-			field.aabb          = paddingAABB;
-			field.localToUVWMul = 1.f / paddingAABB.size();
-			field.localToUVWAdd = -paddingAABB.min / paddingAABB.size();
-			field.maxDistance   = math::max3(paddingAABB.size());
+			acc::BVHTree<uint32_t, glm::vec3> bvh(indices, positions, JobExecutor());
 
-			acc::BVHTree<uint32_t, glm::vec3> bvh(mesh->getIndex(), positions, 1);
+			const bool useWindingNumber = config.signMethod == SignMethod::WindingNumber;
+			if (useWindingNumber)
+				bvh.build_winding_data();
 
 			std::vector<glm::vec3> sampleDirections;
 
-			for (int32_t sampleIndexX = 0; sampleIndexX < config.sampleCount; sampleIndexX++)
+			for (int32_t sampleIndexX = 0; sampleIndexX < config.sampleCount && !useWindingNumber; sampleIndexX++)
 			{
 				for (int32_t sampleIndexY = 0; sampleIndexY < config.sampleCount; sampleIndexY++)
 				{
@@ -88,7 +136,7 @@ namespace maple
 					float sampleY = sampleIndexY / float(config.sampleCount - 1) * 2 - 1;        //-1 - 1
 					//0-2pi
 					const float phi   = sampleX * M_PI_TWO;
-					const float theta = std::acosf(sampleY);
+					const float theta = std::acos(sampleY);
 					sampleDirections.emplace_back(math::directionToVector({phi, theta}));
 				}
 			}
@@ -97,53 +145,74 @@ namespace maple
 			const uint32_t       pixelSize  = sizeof(float) / 2;        //stored as 16 bit float
 			std::vector<uint8_t> byteData(pixelCount * pixelSize, 0);
 
-			for (auto z = 0; z < sdfSize.z; z++)
-			{
+			if (progress != nullptr)
+				progress->total.fetch_add(sdfSize.z, std::memory_order_relaxed);
+
+			const auto sizeOfGrid = paddingAABB.size() / glm::vec3(sdfSize - glm::uvec3(1));
+
+			// one job per z slice, every voxel only writes its own texel so the result does not depend on scheduling.
+			JobSystem::Context context;
+			JobSystem::dispatch(context, sdfSize.z, 1, [&](JobSystem::JobDispatchArgs args) {
+				if (progress != nullptr && progress->isCancelled())
+					return;
+
+				const auto z = args.jobIndex;
+
+				std::vector<acc::Ray<glm::vec3>>                    rays(sampleDirections.size());
+				std::vector<acc::BVHTree<uint32_t, glm::vec3>::Hit> hits(sampleDirections.size());
+
 				for (auto y = 0; y < sdfSize.y; y++)
 				{
 					for (auto x = 0; x < sdfSize.x; x++)
 					{
-						float minDistance = std::numeric_limits<float>::infinity();
-						// math::max3(sdfSize);
-
-						auto sizeOfGrid = paddingAABB.size() / glm::vec3(sdfSize - glm::uvec3(1));
-
 						glm::vec3 voxelPos = glm::vec3((float) x, (float) y, (float) z) * sizeOfGrid + paddingAABB.min;
 
 						int32_t hitBackCount = 0, hitCount = 0;
 
-						minDistance = glm::distance(bvh.closest_point(voxelPos, minDistance), voxelPos);
+						float minDistance = glm::distance(bvh.closest_point(voxelPos, std::numeric_limits<float>::infinity()), voxelPos);
 
+						// all sample rays share the voxel as origin, so they are traced as one packet.
 						for (int32_t sample = 0; sample < sampleDirections.size(); sample++)
 						{
-							acc::Ray<glm::vec3>                    ray{voxelPos, sampleDirections[sample], 0.00000001, field.maxDistance};
-							acc::BVHTree<uint32_t, glm::vec3>::Hit hits;
+							rays[sample] = {voxelPos, sampleDirections[sample], 0.00000001, maxDistance};
+						}
 
-							if (bvh.intersect(ray, &hits))
+						if (!rays.empty() && bvh.intersect(rays.data(), rays.size(), hits.data()) != 0)
+						{
+							for (int32_t sample = 0; sample < sampleDirections.size(); sample++)
 							{
-								auto i0 = mesh->getIndex()[hits.idx * 3];
-								auto i1 = mesh->getIndex()[hits.idx * 3 + 1];
-								auto i2 = mesh->getIndex()[hits.idx * 3 + 2];
-								auto v0 = mesh->getVertex()[i0].pos;
-								auto v1 = mesh->getVertex()[i1].pos;
-								auto v2 = mesh->getVertex()[i2].pos;
+								if (hits[sample].t == std::numeric_limits<float>::infinity())
+									continue;
+
+								auto i0 = indices[hits[sample].idx * 3];
+								auto i1 = indices[hits[sample].idx * 3 + 1];
+								auto i2 = indices[hits[sample].idx * 3 + 2];
+								auto v0 = positions[i0];
+								auto v1 = positions[i1];
+								auto v2 = positions[i2];
 
 								auto normal = glm::normalize(glm::cross(v0 - v2, v0 - v1));
 
 								hitCount++;
-								const bool backHit = glm::dot(ray.dir, normal) > 0;
+								const bool backHit = glm::dot(rays[sample].dir, normal) > 0;
 								if (backHit)
 									hitBackCount++;
 							}
 						}
 
-						float distance = (float) minDistance;
+						float distance = minDistance;
 						if ((float) hitBackCount > (float) sampleDirections.size() * 0.5 && hitCount != 0)
 						{
 							distance *= -1;
 						}
 
-						distance /= field.maxDistance;
+						// the winding number is +-1 inside depending on the mesh winding order, so only its magnitude is used.
+						if (useWindingNumber && std::abs(bvh.winding_number(voxelPos)) > 0.5f)
+						{
+							distance *= -1;
+						}
+
+						distance /= maxDistance;
 						distance                 = (distance + 1.) / 2.f;
 						const uint32_t index     = flatten(glm::ivec3(x, y, z), glm::ivec3(sdfSize));
 						const uint32_t byteIndex = index * pixelSize;
@@ -153,90 +222,124 @@ namespace maple
 						byteData[size_t(byteIndex) + 1] = ((uint8_t *) &half)[1];
 					}
 				}
-			}
 
-			const int32_t mipCount = std::min(getMipLevels(sdfSize.x, sdfSize.y, sdfSize.z), 3);
+				if (progress != nullptr)
+					progress->completed.fetch_add(1, std::memory_order_relaxed);
+			});
+			JobSystem::wait(context);
+
+			if (progress != nullptr && progress->isCancelled())
+				return false;
+
+			// meshes shared by several entities may be baked at the same time, so write aside and move into place.
+			const auto tempPath = cachePath + "." + std::to_string(std::hash<std::thread::id>{}(std::this_thread::get_id())) + ".tmp";
+			std::filesystem::create_directories(cache::Directory);
+
+			container::Header header{};
+			header.format      = container::Format::R16Float;
+			header.width       = sdfSize.x;
+			header.height      = sdfSize.y;
+			header.depth       = sdfSize.z;
+			header.aabbMin     = paddingAABB.min;
+			header.aabbMax     = paddingAABB.max;
+			header.maxDistance = maxDistance;
 
-			Timer timer;
-			field.bakedPath = "sdf/" + mesh->getName() + "_" + std::to_string(timer.currentTimestamp()) + ".sdf";
-			std::ofstream               os(field.bakedPath, std::ios::binary);
-			cereal::BinaryOutputArchive archive(os);
-			archive(sdfSize, mipCount, byteData);
+			const auto mips = buildMipChain(byteData, sdfSize, paddingAABB.size() / maxDistance, config.mipFloor, container::MaxMips);
 
-			for (int32_t mipLevel = 1; mipLevel < mipCount; mipLevel++)
+			std::unique_ptr<bricks::BrickVolume> brickVolume;
+			if (config.brickBand > 0.f)
 			{
-				glm::ivec3           resolutionMip = glm::max(sdfSize / 2u, glm::uvec3(1));
-				const auto           voxelsMipSize = resolutionMip.x * resolutionMip.y * resolutionMip.z * pixelSize;
-				std::vector<uint8_t> voxelData(voxelsMipSize, 0);
+				brickVolume = std::make_unique<bricks::BrickVolume>(bricks::encode(reinterpret_cast<const uint16_t *>(byteData.data()), sdfSize, config.brickBand));
+			}
+
+			if (!container::write(tempPath, header, mips, brickVolume.get()))
+			{
+				LOGE("failed to write baked MeshDistanceField : {}", tempPath);
+				std::filesystem::remove(tempPath, error);
+				return false;
+			}
 
-				for (uint32_t z = 0; z < resolutionMip.z; z++)
+			std::filesystem::rename(tempPath, cachePath, error);
+			if (error)
+			{
+				std::filesystem::remove(tempPath, error);
+				if (!std::filesystem::exists(cachePath, error))
 				{
-					for (uint32_t y = 0; y < resolutionMip.y; y++)
+					LOGE("failed to store baked MeshDistanceField : {}", cachePath);
+					return false;
+				}
+			}
+			applyField();
+			return true;
+		}
+
+		auto buildMipChain(const std::vector<uint8_t> &mip0, const glm::uvec3 &resolution, const glm::vec3 &extent, uint32_t mipFloor, uint32_t maxMips) -> std::vector<std::vector<uint8_t>>
+		{
+			PROFILE_FUNCTION();
+			std::vector<std::vector<uint8_t>> mips;
+			mips.emplace_back(mip0);
+
+			glm::uvec3 fine = resolution;
+			while (mips.size() < maxMips)
+			{
+				const glm::uvec3 coarse = glm::max(fine / 2u, glm::uvec3(1));
+				if (coarse == fine || std::max(coarse.x, std::max(coarse.y, coarse.z)) < mipFloor)
+					break;
+
+				// texel spacing of the finer level in normalized distance units, the baker spaces texels by (size - 1).
+				const glm::vec3 spacing = extent / glm::vec3(glm::max(fine - 1u, glm::uvec3(1)));
+				const glm::vec3 scale   = glm::vec3(fine) / glm::vec3(coarse);
+
+				const auto &         source = mips.back();
+				std::vector<uint8_t> target(size_t(coarse.x) * coarse.y * coarse.z * sizeof(uint16_t));
+
+				JobSystem::Context context;
+				JobSystem::dispatch(context, coarse.z, 1, [&](JobSystem::JobDispatchArgs args) {
+					const auto z = args.jobIndex;
+					for (uint32_t y = 0; y < coarse.y; y++)
 					{
-						for (uint32_t x = 0; x < resolutionMip.x; x++)
+						for (uint32_t x = 0; x < coarse.x; x++)
 						{
-							float distance = 0;
-							for (uint32_t dz = 0; dz < 2; dz++)
+							const glm::vec3  texel  = glm::vec3(x, y, z);
+							const glm::vec3  center = (texel + 0.5f) * scale - 0.5f;
+							const glm::uvec3 lo     = glm::uvec3(glm::floor(texel * scale));
+							const glm::uvec3 hi     = glm::min(glm::uvec3(glm::ceil((texel + 1.f) * scale)) - 1u, fine - 1u);
+
+							// 1-lipschitz : |d(center)| >= |d(q)| - |center - q| for every fine texel q of the footprint.
+							const float radius = glm::length(glm::max(center - glm::vec3(lo), glm::vec3(hi) - center) * spacing);
+
+							float minDistance = std::numeric_limits<float>::infinity();
+							bool  inside      = false;
+							for (uint32_t fz = lo.z; fz <= hi.z; fz++)
 							{
-								for (uint32_t dy = 0; dy < 2; dy++)
+								for (uint32_t fy = lo.y; fy <= hi.y; fy++)
 								{
-									for (uint32_t dx = 0; dx < 2; dx++)
+									for (uint32_t fx = lo.x; fx <= hi.x; fx++)
 									{
-										auto     index = flatten({x * 2 + dx, y * 2 + dy, z * 2 + dz}, sdfSize) * pixelSize;
 										uint16_t value;
-										memcpy(&value, &byteData[index], sizeof(uint16_t));
-										distance += glm::unpackHalf1x16(value);
+										memcpy(&value, &source[flatten(glm::ivec3(fx, fy, fz), glm::ivec3(fine)) * sizeof(uint16_t)], sizeof(uint16_t));
+										const float distance = glm::unpackHalf1x16(value) * 2.f - 1.f;
+										if (std::abs(distance) < minDistance)
+										{
+											minDistance = std::abs(distance);
+											inside      = distance < 0.f;
+										}
 									}
 								}
 							}
-							distance *= 1.0f / 8.0f;
-							auto     index               = flatten({x, y, z}, resolutionMip) * pixelSize;
-							uint16_t half                = glm::packHalf(glm::vec1(distance))[0];        //distance is stored as 16 bit float
-							voxelData[index]             = ((uint8_t *) &half)[0];
-							voxelData[size_t(index) + 1] = ((uint8_t *) &half)[1];
+
+							const float    bound = std::max(minDistance - radius, 0.f);
+							const uint16_t half  = packConservative(inside ? -bound : bound);
+							memcpy(&target[flatten(glm::ivec3(x, y, z), glm::ivec3(coarse)) * sizeof(uint16_t)], &half, sizeof(uint16_t));
 						}
 					}
-				}
-
-				archive(voxelData);
-				sdfSize  = resolutionMip;
-				byteData = voxelData;
-			}
-		}
+				});
+				JobSystem::wait(context);
 
-		auto load(component::MeshDistanceField &field, const CommandBuffer *cmd) -> void
-		{
-			const CommandBuffer *cmd1 = cmd;
-			CommandBuffer::Ptr   onceCmd;
-			if (cmd == nullptr)
-			{
-				onceCmd = CommandBuffer::create();
-				onceCmd->init(true);
-				onceCmd->beginRecording();
-				cmd1 = onceCmd.get();
-			}
-
-			std::ifstream              os(field.bakedPath, std::ios::binary);
-			cereal::BinaryInputArchive archive(os);
-			glm::uvec3                 sdfSize{};
-			int32_t                    mipCount;
-			std::vector<uint8_t>       data;
-			archive(sdfSize, mipCount, data);
-			auto sdf3d = Texture3D::create(sdfSize.x, sdfSize.y, sdfSize.z, {TextureFormat::R16, TextureFilter::Linear}, {false, false, true, false, mipCount});
-			sdf3d->update(cmd1, data.data());
-
-			for (int32_t mipLevel = 1; mipLevel < mipCount; mipLevel++)
-			{
-				std::vector<uint8_t> voxelData;
-				archive(voxelData);
-				sdf3d->updateMipmap(cmd1, mipLevel, voxelData.data());
-			}
-
-			if (cmd == nullptr)
-			{
-				onceCmd->endSingleTimeCommands();
+				mips.emplace_back(std::move(target));
+				fine = coarse;
 			}
-			field.buffer = sdf3d;
+			return mips;
 		}
 
 	};        // namespace sdf::baker
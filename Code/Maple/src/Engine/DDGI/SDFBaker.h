@@ -5,18 +5,14 @@
 #include "Engine/Core.h"
 #include "Math/BoundingBox.h"
 
+#include <atomic>
 #include <memory>
+#include <string>
+#include <vector>
 
 namespace maple
 {
-	class Mesh;
-	class Texture3D;
-	class CommandBuffer;
-
-	namespace component
-	{
-		class Transform;
-	}
+	struct Vertex;
 
 	namespace sdf::component
 	{
@@ -24,18 +20,67 @@ namespace maple
 	}
 	namespace sdf::baker
 	{
+		enum class SignMethod : uint8_t
+		{
+			RayVote,              // sampleCount^2 rays per voxel, majority of back face hits is inside
+			WindingNumber,        // one hierarchical generalized winding number query per voxel
+		};
+
 		struct SDFBakerConfig
 		{
-			constexpr SDFBakerConfig(uint32_t maxResolution = 128, uint32_t minResolution = 32, float targetTexelPerMeter = 3, int32_t sampleCount = 4, bool buildWithBVH = true) :
-			    maxResolution(maxResolution), minResolution(minResolution), targetTexelPerMeter(targetTexelPerMeter), sampleCount(sampleCount), buildWithBVH(buildWithBVH){};
-
-			uint32_t maxResolution;
-			uint32_t minResolution;
-			float    targetTexelPerMeter;
-			int32_t  sampleCount;
-			bool     buildWithBVH;
+			constexpr SDFBakerConfig(uint32_t maxResolution = 128, uint32_t minResolution = 32, float targetTexelPerMeter = 3, int32_t sampleCount = 4, bool buildWithBVH = true, SignMethod signMethod = SignMethod::RayVote, float brickBand = 0.f, uint32_t mipFloor = 8) :
+			    maxResolution(maxResolution), minResolution(minResolution), targetTexelPerMeter(targetTexelPerMeter), sampleCount(sampleCount), buildWithBVH(buildWithBVH), signMethod(signMethod), brickBand(brickBand), mipFloor(mipFloor){};
+
+			uint32_t   maxResolution;
+			uint32_t   minResolution;
+			float      targetTexelPerMeter;
+			int32_t    sampleCount;
+			bool       buildWithBVH;
+			SignMethod signMethod;
+			float      brickBand;        // > 0 also stores 8^3 narrow band bricks, in units of maxDistance
+			uint32_t   mipFloor;         // mips stop before the largest dimension drops below this
 		};
-		
+
+		/**
+		 * shared between the baking jobs and whoever watches them, counted in voxel slices.
+		 * one instance can be passed to several bakes, total grows as each bake starts.
+		 */
+		struct BakeProgress
+		{
+			std::atomic<uint32_t> completed{0};
+			std::atomic<uint32_t> total{0};
+			std::atomic<bool>     cancelled{false};
+
+			inline auto cancel() -> void
+			{
+				cancelled.store(true, std::memory_order_relaxed);
+			}
+
+			inline auto isCancelled() const -> bool
+			{
+				return cancelled.load(std::memory_order_relaxed);
+			}
+
+			inline auto getProgress() const -> float
+			{
+				const auto count = total.load(std::memory_order_relaxed);
+				return count == 0 ? 0.f : float(completed.load(std::memory_order_relaxed)) / float(count);
+			}
+		};
+
+		/**
+		 * what a bake reads from a mesh : local space positions and a triangle list.
+		 * the engine fills it from a Mesh, tools can fill it without one.
+		 */
+		struct MeshGeometry
+		{
+			std::string            name;
+			std::vector<glm::vec3> positions;
+			std::vector<uint32_t>  indices;
+		};
+
+		auto MAPLE_EXPORT makeGeometry(const std::string &name, const std::vector<Vertex> &vertices, const std::vector<uint32_t> &indices) -> MeshGeometry;
+
 		inline auto paddingSDFBox(const BoundingBox &bb) -> BoundingBox
 		{
 			glm::vec3       padding    = 0.05f * bb.size();
@@ -48,7 +93,17 @@ namespace maple
 		 * TODO ...can also use GPU to generate
 		 */
 
-		auto MAPLE_EXPORT load(component::MeshDistanceField &field, const CommandBuffer *cmd) -> void;
-		auto MAPLE_EXPORT bake(const std::shared_ptr<Mesh> &mesh, const SDFBakerConfig &config, component::MeshDistanceField &field, const maple::component::Transform &transform) -> void;
+		/**
+		 * conservative mip chain of a normalized R16 volume. every coarse texel stores the min-abs distance of its
+		 * footprint minus the footprint radius, so it never overestimates the distance and marchers can step safely.
+		 * extent is the volume size divided by maxDistance, levels halve down to mipFloor or maxMips, including mip0.
+		 */
+		auto MAPLE_EXPORT buildMipChain(const std::vector<uint8_t> &mip0, const glm::uvec3 &resolution, const glm::vec3 &extent, uint32_t mipFloor, uint32_t maxMips) -> std::vector<std::vector<uint8_t>>;
+
+		/**
+		 * voxels are baked slice by slice over the JobSystem, the output is identical to a serial bake.
+		 * returns false and leaves field untouched when the bake is cancelled through progress.
+		 */
+		auto MAPLE_EXPORT bake(const MeshGeometry &geometry, const SDFBakerConfig &config, component::MeshDistanceField &field, BakeProgress *progress = nullptr) -> bool;
 	};        // namespace sdf::baker
 }        // namespace maple
\ No newline at end of file
@@ -0,0 +1,124 @@
+//////////////////////////////////////////////////////////////////////////////
+// This file is part of the Maple Engine                              		//
+//////////////////////////////////////////////////////////////////////////////
+
+#include "SDFBricks.h"
+
+#include <cmath>
+#include <limits>
+#include <glm/gtc/packing.hpp>
+
+namespace maple
+{
+	namespace sdf::bricks
+	{
+		namespace
+		{
+			inline auto decode(uint16_t value)
+			{
+				return glm::unpackHalf1x16(value) * 2.f - 1.f;
+			}
+
+			inline auto flatten(const glm::uvec3 &position, const glm::uvec3 &resolution)
+			{
+				return position.x + position.y * resolution.x + position.z * resolution.x * resolution.y;
+			}
+		}        // namespace
+
+		auto encode(const uint16_t *dense, const glm::uvec3 &resolution, float band) -> BrickVolume
+		{
+			BrickVolume volume;
+			volume.resolution = resolution;
+			volume.brickCount = (resolution + glm::uvec3(BrickSize - 1)) / BrickSize;
+			volume.band       = band;
+			volume.indirection.resize(volume.brickCount.x * volume.brickCount.y * volume.brickCount.z, EmptyOutside);
+
+			uint16_t brick[BrickVoxels];
+
+			for (uint32_t bz = 0; bz < volume.brickCount.z; bz++)
+			{
+				for (uint32_t by = 0; by < volume.brickCount.y; by++)
+				{
+					for (uint32_t bx = 0; bx < volume.brickCount.x; bx++)
+					{
+						const glm::uvec3 origin = glm::uvec3(bx, by, bz) * BrickSize;
+
+						float minDistance = std::numeric_limits<float>::infinity();
+						bool  inside      = false;
+
+						// voxels past the border replicate the edge, so partial bricks still sample like the clamped texture.
+						for (uint32_t z = 0; z < BrickSize; z++)
+						{
+							for (uint32_t y = 0; y < BrickSize; y++)
+							{
+								for (uint32_t x = 0; x < BrickSize; x++)
+								{
+									const auto voxel = glm::min(origin + glm::uvec3(x, y, z), resolution - 1u);
+									const auto value = dense[flatten(voxel, resolution)];
+									const auto d     = decode(value);
+
+									brick[x + y * BrickSize + z * BrickSize * BrickSize] = value;
+									if (std::abs(d) < minDistance)
+									{
+										minDistance = std::abs(d);
+										inside      = d < 0.f;
+									}
+								}
+							}
+						}
+
+						auto &slot = volume.indirection[flatten({bx, by, bz}, volume.brickCount)];
+						if (minDistance <= band)
+						{
+							slot = volume.getBrickSlots();
+							volume.bricks.insert(volume.bricks.end(), brick, brick + BrickVoxels);
+						}
+						else
+						{
+							slot = inside ? EmptyInside : EmptyOutside;
+						}
+					}
+				}
+			}
+			return volume;
+		}
+
+		auto fetch(const BrickVolume &volume, const glm::ivec3 &voxel) -> float
+		{
+			const auto clamped = glm::uvec3(glm::clamp(voxel, glm::ivec3(0), glm::ivec3(volume.resolution) - 1));
+			const auto brick   = clamped / BrickSize;
+			const auto local   = clamped % BrickSize;
+			const auto slot    = volume.indirection[flatten(brick, volume.brickCount)];
+
+			if (slot == EmptyOutside)
+				return volume.band;
+			if (slot == EmptyInside)
+				return -volume.band;
+
+			return decode(volume.bricks[size_t(slot) * BrickVoxels + local.x + local.y * BrickSize + local.z * BrickSize * BrickSize]);
+		}
+
+		auto sample(const BrickVolume &volume, const glm::vec3 &uvw) -> float
+		{
+			const glm::vec3  position = uvw * glm::vec3(volume.resolution) - 0.5f;
+			const glm::vec3  base     = glm::floor(position);
+			const glm::vec3  t        = position - base;
+			const glm::ivec3 voxel    = glm::ivec3(base);
+
+			const float c000 = fetch(volume, voxel);
+			const float c100 = fetch(volume, voxel + glm::ivec3(1, 0, 0));
+			const float c010 = fetch(volume, voxel + glm::ivec3(0, 1, 0));
+			const float c110 = fetch(volume, voxel + glm::ivec3(1, 1, 0));
+			const float c001 = fetch(volume, voxel + glm::ivec3(0, 0, 1));
+			const float c101 = fetch(volume, voxel + glm::ivec3(1, 0, 1));
+			const float c011 = fetch(volume, voxel + glm::ivec3(0, 1, 1));
+			const float c111 = fetch(volume, voxel + glm::ivec3(1, 1, 1));
+
+			const float c00 = glm::mix(c000, c100, t.x);
+			const float c10 = glm::mix(c010, c110, t.x);
+			const float c01 = glm::mix(c001, c101, t.x);
+			const float c11 = glm::mix(c011, c111, t.x);
+			return glm::mix(glm::mix(c00, c10, t.y), glm::mix(c01, c11, t.y), t.z);
+		}
+	};        // namespace sdf::bricks
+}        // namespace maple
@@ -0,0 +1,55 @@
+//////////////////////////////////////////////////////////////////////////////
+// This file is part of the Maple Engine                              		//
+//////////////////////////////////////////////////////////////////////////////
+#pragma once
+#include "Engine/Core.h"
+
+#include <glm/glm.hpp>
+#include <vector>
+
+namespace maple
+{
+	/**
+	 * sparse narrow band representation of a mesh distance field.
+	 * the volume is cut into 8^3 bricks, only bricks with a voxel closer than band to the surface are stored,
+	 * every other brick resolves to a constant +-band through the indirection table.
+	 * values use the same normalized half float encoding as the dense volume ((d / maxDistance + 1) / 2).
+	 */
+	namespace sdf::bricks
+	{
+		static constexpr uint32_t BrickSize    = 8;
+		static constexpr uint32_t BrickVoxels  = BrickSize * BrickSize * BrickSize;
+		static constexpr uint32_t EmptyOutside = 0xffffffff;
+		static constexpr uint32_t EmptyInside  = 0xfffffffe;
+
+		struct BrickVolume
+		{
+			glm::uvec3            resolution{};
+			glm::uvec3            brickCount{};
+			float                 band = 0.f;        // normalized distance, in the same unit as the stored values
+			std::vector<uint32_t> indirection;       // brick slot, or EmptyOutside / EmptyInside
+			std::vector<uint16_t> bricks;            // BrickVoxels half floats per slot, x fastest
+
+			inline auto getBrickSlots() const -> uint32_t
+			{
+				return static_cast<uint32_t>(bricks.size() / BrickVoxels);
+			}
+		};
+
+		/**
+		 * dense holds resolution.x * y * z half floats, x fastest.
+		 * band is a normalized signed distance (|d| / maxDistance).
+		 */
+		auto MAPLE_EXPORT encode(const uint16_t *dense, const glm::uvec3 &resolution, float band) -> BrickVolume;
+
+		/**
+		 * cpu reference, returns the decoded normalized distance (-1 .. 1) of a voxel, clamped to the volume.
+		 */
+		auto MAPLE_EXPORT fetch(const BrickVolume &volume, const glm::ivec3 &voxel) -> float;
+
+		/**
+		 * cpu reference of the trilinear lookup, uvw in 0..1 covering voxel centers like the dense texture.
+		 */
+		auto MAPLE_EXPORT sample(const BrickVolume &volume, const glm::vec3 &uvw) -> float;
+	};        // namespace sdf::bricks
+}        // namespace maple
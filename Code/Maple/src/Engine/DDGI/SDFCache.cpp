@@ -0,0 +1,226 @@
+//////////////////////////////////////////////////////////////////////////////
+// This file is part of the Maple Engine                              		//
+//////////////////////////////////////////////////////////////////////////////
+
+#include "SDFCache.h"
+
+#include "Engine/Profiler.h"
+#include "Others/Console.h"
+#include "Others/StringUtils.h"
+#include "Others/Timer.h"
+
+#include <cereal/archives/json.hpp>
+#include <cereal/types/map.hpp>
+#include <cereal/types/string.hpp>
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <mutex>
+#include <type_traits>
+
+namespace maple
+{
+	namespace sdf::cache
+	{
+		namespace
+		{
+			struct Entry
+			{
+				std::string mesh;
+				int64_t     lastUsed = 0;
+
+				SERIALIZATION(mesh, lastUsed);
+			};
+
+			std::mutex                   manifestMutex;
+			std::map<std::string, Entry> manifest;
+			bool                         manifestLoaded = false;
+			bool                         manifestDirty  = false;
+
+			// fnv-1a, stable across runs and platforms unlike std::hash.
+			struct Hasher
+			{
+				uint64_t value = 14695981039346656037ull;
+
+				inline auto write(const void *data, size_t size) -> void
+				{
+					auto bytes = static_cast<const uint8_t *>(data);
+					for (size_t i = 0; i < size; i++)
+					{
+						value ^= bytes[i];
+						value *= 1099511628211ull;
+					}
+				}
+
+				template <typename T>
+				inline auto write(const T &value) -> void
+				{
+					static_assert(std::is_trivially_copyable_v<T>);
+					write(&value, sizeof(T));
+				}
+			};
+
+			inline auto toHex(uint64_t key)
+			{
+				char buffer[17];
+				snprintf(buffer, sizeof(buffer), "%016llx", (unsigned long long) key);
+				return std::string(buffer);
+			}
+
+			inline auto isKeyName(const std::string &name)
+			{
+				return name.size() == 16 && std::all_of(name.begin(), name.end(), [](char c) { return std::isxdigit((unsigned char) c) != 0; });
+			}
+
+			// the baker writes <key>.sdf.<thread>.tmp and renames it into place.
+			inline auto isTempName(const std::string &name)
+			{
+				return name.size() > 21 && isKeyName(name.substr(0, 16)) && name.compare(16, 5, ".sdf.") == 0;
+			}
+
+			// manifestMutex must be held.
+			inline auto loadManifest() -> void
+			{
+				if (manifestLoaded)
+					return;
+				manifestLoaded = true;
+				std::error_code error;
+				if (!std::filesystem::exists(ManifestPath, error))
+					return;
+				try
+				{
+					std::ifstream            istr(ManifestPath, std::ios::in);
+					cereal::JSONInputArchive input(istr);
+					input(manifest);
+				}
+				catch (const std::exception &e)
+				{
+					LOGW("SDF cache manifest is broken, rebuilding it : {}", e.what());
+					manifest.clear();
+				}
+			}
+		}        // namespace
+
+		auto getKey(const baker::MeshGeometry &geometry, const baker::SDFBakerConfig &config) -> uint64_t
+		{
+			PROFILE_FUNCTION();
+			Hasher hasher;
+			hasher.write(BakerVersion);
+
+			const auto &indices = geometry.indices;
+			hasher.write(uint64_t(indices.size()));
+			hasher.write(indices.data(), indices.size() * sizeof(indices[0]));
+
+			// only positions shape the distance field, uv or normal edits keep the entry.
+			const auto &positions = geometry.positions;
+			hasher.write(uint64_t(positions.size()));
+			for (const auto &position : positions)
+				hasher.write(position);
+
+			hasher.write(config.maxResolution);
+			hasher.write(config.minResolution);
+			hasher.write(config.targetTexelPerMeter);
+			hasher.write(config.signMethod);
+			hasher.write(config.brickBand);
+			hasher.write(config.mipFloor);
+			if (config.signMethod == baker::SignMethod::RayVote)
+				hasher.write(config.sampleCount);
+			return hasher.value;
+		}
+
+		auto getPath(uint64_t key) -> std::string
+		{
+			return Directory + toHex(key) + ".sdf";
+		}
+
+		auto touch(uint64_t key, const std::string &meshName) -> void
+		{
+			Timer                       timer;
+			std::lock_guard<std::mutex> lock(manifestMutex);
+			loadManifest();
+			auto &entry    = manifest[toHex(key)];
+			entry.mesh     = meshName;
+			entry.lastUsed = timer.currentTimestamp();
+			manifestDirty  = true;
+		}
+
+		auto save() -> void
+		{
+			std::lock_guard<std::mutex> lock(manifestMutex);
+			if (!manifestDirty)
+				return;
+
+			std::filesystem::create_directories(Directory);
+			std::ofstream storage(ManifestPath, std::ios::binary);
+			{
+				cereal::JSONOutputArchive output{storage};
+				output(manifest);
+			}
+			manifestDirty = false;
+		}
+
+		auto collectGarbage(int64_t maxAge, int64_t gracePeriod) -> uint32_t
+		{
+			PROFILE_FUNCTION();
+			uint32_t removed = 0;
+			{
+				Timer                       timer;
+				const auto                  now = timer.currentTimestamp();
+				std::lock_guard<std::mutex> lock(manifestMutex);
+				loadManifest();
+
+				for (auto iter = manifest.begin(); iter != manifest.end();)
+				{
+					const auto path = Directory + iter->first + ".sdf";
+					std::error_code error;
+					if (!std::filesystem::exists(path, error) || now - iter->second.lastUsed > maxAge)
+					{
+						std::remove(path.c_str());
+						iter          = manifest.erase(iter);
+						manifestDirty = true;
+						removed++;
+					}
+					else
+					{
+						++iter;
+					}
+				}
+
+				// another process may have just renamed a bake into place without saving its manifest yet.
+				const auto               written = std::filesystem::file_time_type::clock::now() - std::chrono::milliseconds(gracePeriod);
+				std::vector<std::string> files;
+				std::error_code          error;
+				for (auto &entry : std::filesystem::directory_iterator(Directory, error))
+				{
+					std::error_code fileError;
+					if (!entry.is_regular_file(fileError) || entry.last_write_time(fileError) > written || fileError)
+						continue;
+
+					const auto path       = entry.path().string();
+					const auto name       = StringUtils::getFileNameWithoutExtension(path);
+					const auto extension  = StringUtils::getExtension(path);
+					const bool orphan     = extension == "sdf" && isKeyName(name) && manifest.find(name) == manifest.end();
+					const bool unfinished = extension == "tmp" && isTempName(entry.path().filename().string());
+					if (orphan || unfinished)
+						files.emplace_back(path);
+				}
+
+				for (auto &file : files)
+				{
+					std::remove(file.c_str());
+					removed++;
+				}
+			}
+
+			if (removed > 0)
+				LOGI("SDF cache : removed {} orphaned entries", removed);
+
+			save();
+			return removed;
+		}
+	};        // namespace sdf::cache
+}        // namespace maple
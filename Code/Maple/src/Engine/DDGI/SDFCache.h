@@ -0,0 +1,48 @@
+//////////////////////////////////////////////////////////////////////////////
+// This file is part of the Maple Engine                              		//
+//////////////////////////////////////////////////////////////////////////////
+#pragma once
+#include "Engine/Core.h"
+#include "SDFBaker.h"
+
+#include <memory>
+#include <string>
+
+namespace maple
+{
+	/**
+	 * content addressed store for baked mesh distance fields.
+	 * the key only depends on the geometry and the bake settings, so an unchanged mesh always resolves
+	 * to the same file and never needs to be baked twice.
+	 */
+	namespace sdf::cache
+	{
+		// bump whenever the baker output changes, older entries stop matching and get collected.
+		static constexpr uint32_t BakerVersion = 6;
+
+		static constexpr const char *Directory    = "sdf/";
+		static constexpr const char *ManifestPath = "sdf/manifest.json";
+
+		// entries not used for 30 days are dropped by collectGarbage.
+		static constexpr int64_t DefaultMaxAge = 30ll * 24 * 60 * 60 * 1000;
+
+		// files written within the last hour may belong to a bake still running in another process.
+		static constexpr int64_t DefaultGracePeriod = 60ll * 60 * 1000;
+
+		auto MAPLE_EXPORT getKey(const baker::MeshGeometry &geometry, const baker::SDFBakerConfig &config) -> uint64_t;
+		auto MAPLE_EXPORT getPath(uint64_t key) -> std::string;
+
+		/**
+		 * records a use of the entry in the manifest, thread safe. the manifest is only written by save.
+		 */
+		auto MAPLE_EXPORT touch(uint64_t key, const std::string &meshName) -> void;
+		auto MAPLE_EXPORT save() -> void;
+
+		/**
+		 * removes entries older than maxAge (ms) or whose file is gone, cache files the manifest does not know and
+		 * the temporary files of bakes that never finished. files modified within gracePeriod (ms) and files not
+		 * named by a cache key (e.g. older timestamped bakes) are left alone. returns the removed count.
+		 */
+		auto MAPLE_EXPORT collectGarbage(int64_t maxAge = DefaultMaxAge, int64_t gracePeriod = DefaultGracePeriod) -> uint32_t;
+	};        // namespace sdf::cache
+}        // namespace maple
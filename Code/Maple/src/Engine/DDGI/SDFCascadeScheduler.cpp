@@ -0,0 +1,104 @@
+//////////////////////////////////////////////////////////////////////////////
+// This file is part of the Maple Engine                              		//
+//////////////////////////////////////////////////////////////////////////////
+
+#include "SDFCascadeScheduler.h"
+#include "Others/Console.h"
+
+#include <algorithm>
+#include <limits>
+
+namespace maple
+{
+	namespace sdf::scheduler
+	{
+		auto CascadeScheduler::schedule(const std::vector<CascadeRequest> &requests) -> const std::vector<uint32_t> &
+		{
+			MAPLE_ASSERT(requests.size() <= MaxCascades, "too many global sdf cascades");
+
+			order.clear();
+			spentMs    = 0;
+			overBudget = false;
+			stats.frames++;
+			stats.budgetMs = budgetMs;
+			stats.spentMs  = 0;
+
+			struct Candidate
+			{
+				uint32_t cascade;
+				float    priority;
+			};
+			std::vector<Candidate> candidates;
+
+			for (uint32_t i = 0; i < requests.size(); i++)
+			{
+				const auto &request = requests[i];
+				auto &      cascade = stats.cascades[i];
+				const auto  work    = request.enteringChunks + request.dirtyChunks;
+
+				mandatory[i] = false;
+				if (!request.forced && work == 0)
+				{
+					cascade.staleFrames = 0;
+					continue;
+				}
+
+				// counts this frame, a complete update resets it.
+				cascade.staleFrames++;
+				cascade.maxStaleFrames = std::max(cascade.maxStaleFrames, cascade.staleFrames);
+
+				if (request.forced || cascade.staleFrames >= maxStaleFrames[i])
+				{
+					mandatory[i] = true;
+					order.emplace_back(i);
+					continue;
+				}
+
+				// the view moving matters more than props moving, every cascade covers twice the distance of the previous one.
+				const float urgency = 1.f + cascade.staleFrames / float(maxStaleFrames[i]);
+				candidates.push_back({i, urgency * (2.f * request.enteringChunks + request.dirtyChunks) / float(1 << i)});
+			}
+
+			std::stable_sort(candidates.begin(), candidates.end(), [](const Candidate &a, const Candidate &b) {
+				return a.priority > b.priority;
+			});
+
+			for (auto &candidate : candidates)
+				order.emplace_back(candidate.cascade);
+			return order;
+		}
+
+		auto CascadeScheduler::getChunkBudget(uint32_t cascade) const -> uint32_t
+		{
+			if (mandatory[cascade])
+				return std::numeric_limits<uint32_t>::max();
+
+			const float remaining = budgetMs - spentMs - cascadeCostMs;
+			if (remaining < chunkCostMs)
+				return 0;
+			return static_cast<uint32_t>(remaining / chunkCostMs);
+		}
+
+		auto CascadeScheduler::complete(uint32_t cascade, uint32_t rasterized, uint32_t deferred) -> void
+		{
+			auto &stat = stats.cascades[cascade];
+			stat.updates++;
+			stat.rasterized = rasterized;
+			stat.deferred   = deferred;
+			if (mandatory[cascade])
+				stat.forcedUpdates++;
+			if (deferred > 0)
+				stat.partialUpdates++;
+			else
+				stat.staleFrames = 0;
+
+			spentMs += getCost(rasterized);
+			stats.spentMs = spentMs;
+			if (spentMs > budgetMs && !overBudget)
+			{
+				overBudget = true;
+				stats.overBudgetFrames++;
+			}
+		}
+	};        // namespace sdf::scheduler
+}        // namespace maple
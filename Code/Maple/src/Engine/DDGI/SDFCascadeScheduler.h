@@ -0,0 +1,91 @@
+//////////////////////////////////////////////////////////////////////////////
+// This file is part of the Maple Engine                              		//
+//////////////////////////////////////////////////////////////////////////////
+#pragma once
+#include "Engine/Core.h"
+
+#include <cstdint>
+#include <vector>
+
+namespace maple
+{
+	/**
+	 * decides which global sdf cascades are updated each frame and how many chunks they may rasterize.
+	 * cascades with more camera movement and more dirty chunks go first, finer cascades before coarser ones,
+	 * until the frame budget is spent. chunks left over stay dirty for a later frame. a cascade that has had
+	 * pending work for maxStaleFrames frames is updated completely, whatever the budget.
+	 * the renderer has no gpu timers, so the budget is spent against an estimated cost per dispatch.
+	 */
+	namespace sdf::scheduler
+	{
+		constexpr uint32_t MaxCascades = 4;
+
+		struct CascadeRequest
+		{
+			bool     forced         = false;        // the cascade was reset and has to be rebuilt now
+			uint32_t enteringChunks = 0;            // scrolled into the window since the last update
+			uint32_t dirtyChunks    = 0;
+		};
+
+		struct CascadeStats
+		{
+			uint32_t updates        = 0;        // since start
+			uint32_t partialUpdates = 0;        // left chunks for a later frame
+			uint32_t forcedUpdates  = 0;        // reset or too stale, ran past the budget
+			uint32_t staleFrames    = 0;        // frames the current work has been waiting
+			uint32_t maxStaleFrames = 0;        // worst since start
+			uint32_t rasterized     = 0;        // chunks, last update
+			uint32_t deferred       = 0;
+		};
+
+		struct Stats
+		{
+			float        budgetMs         = 0;
+			float        spentMs          = 0;        // estimated, last frame
+			uint32_t     frames           = 0;
+			uint32_t     overBudgetFrames = 0;        // forced updates went past the budget
+			CascadeStats cascades[MaxCascades];
+		};
+
+		class MAPLE_EXPORT CascadeScheduler
+		{
+		  public:
+			/**
+			 * starts a frame, returns the cascades to update in the order they should run.
+			 */
+			auto schedule(const std::vector<CascadeRequest> &requests) -> const std::vector<uint32_t> &;
+
+			/**
+			 * the chunks the cascade may rasterize with what is left of the budget, zero skips it this frame.
+			 */
+			auto getChunkBudget(uint32_t cascade) const -> uint32_t;
+
+			/**
+			 * charges the update to the frame, deferred chunks keep the cascade stale.
+			 */
+			auto complete(uint32_t cascade, uint32_t rasterized, uint32_t deferred) -> void;
+
+			inline auto &getStats() const
+			{
+				return stats;
+			}
+
+			inline auto getCost(uint32_t chunks) const
+			{
+				return cascadeCostMs + chunks * chunkCostMs;
+			}
+
+			float    budgetMs      = 2.f;
+			float    chunkCostMs   = 0.02f;        // one 32^3 chunk rasterized
+			float    cascadeCostMs = 0.25f;        // the mip and flood passes after any change
+			uint32_t maxStaleFrames[MaxCascades] = {2, 3, 5, 11};
+
+		  private:
+			std::vector<uint32_t> order;
+			bool                  mandatory[MaxCascades] = {};
+			bool                  overBudget             = false;
+			float                 spentMs                = 0;
+			Stats                 stats;
+		};
+	};        // namespace sdf::scheduler
+}        // namespace maple
@@ -0,0 +1,268 @@
+//////////////////////////////////////////////////////////////////////////////
+// This file is part of the Maple Engine                              		//
+//////////////////////////////////////////////////////////////////////////////
+
+#include "SDFChunks.h"
+#include "Math/BoundingSphere.h"
+
+#include <algorithm>
+
+namespace maple
+{
+	namespace sdf::chunks
+	{
+		auto getChunkId(float voxelSize, const BoundingBox &cascadeBounds, const BoundingBox &objectBounds, glm::ivec3 &objectChunkMin, glm::ivec3 &objectChunkMax) -> void
+		{
+			BoundingBox objectBoundsCascade;
+			const float objectMargin      = voxelSize * ChunkMargin;
+			auto        cascadeBoundsBias = cascadeBounds;
+			cascadeBoundsBias.min += 0.1f;
+			cascadeBoundsBias.max -= 0.1f;
+			objectBoundsCascade.min = objectBounds.min - objectMargin;
+			objectBoundsCascade.max = objectBounds.max + objectMargin;
+			objectBoundsCascade.min = glm::clamp(objectBoundsCascade.min, cascadeBoundsBias.min, cascadeBoundsBias.max);
+			objectBoundsCascade.max = glm::clamp(objectBoundsCascade.max, cascadeBoundsBias.min, cascadeBoundsBias.max);
+
+			// world chunk ids, cascades are snapped to whole chunks so the same object maps to the same chunks wherever the cascade is.
+			const float chunkSize = voxelSize * ChunkSize;
+			objectChunkMin        = glm::ivec3{glm::floor(objectBoundsCascade.min / chunkSize)};
+			objectChunkMax        = glm::ivec3{glm::floor(objectBoundsCascade.max / chunkSize)};
+		}
+
+		auto getObjectBounds(const BoundingBox &objectBounds) -> BoundingBox
+		{
+			const BoundingSphere sphere = objectBounds;
+			return BoundingBox{sphere.center - sphere.radius, sphere.center + sphere.radius};
+		}
+
+		auto invalidateChunks(std::vector<CascadeData> &cascades, const BoundingBox &objectBounds) -> void
+		{
+			const BoundingSphere sphere = objectBounds;
+			for (auto &cascade : cascades)
+			{
+				// same selection as the cascade gather, objects outside it are not clamped into its border chunks.
+				if (!cascade.bounds.intersectsWithSphere(sphere))
+					continue;
+
+				glm::ivec3 objectChunkMin;
+				glm::ivec3 objectChunkMax;
+				getChunkId(cascade.voxelSize, cascade.bounds, objectBounds, objectChunkMin, objectChunkMax);
+
+				ChunkKey key;
+				key.layer = 0;
+
+				for (key.coord.z = objectChunkMin.z; key.coord.z <= objectChunkMax.z; key.coord.z++)
+				{
+					for (key.coord.y = objectChunkMin.y; key.coord.y <= objectChunkMax.y; key.coord.y++)
+					{
+						for (key.coord.x = objectChunkMin.x; key.coord.x <= objectChunkMax.x; key.coord.x++)
+						{
+							key.hash = flatten(key.coord, glm::ivec3{KeyHashResolution});
+							cascade.dirtyChunks.emplace(key);
+						}
+					}
+				}
+			}
+		}
+
+		auto addObjectToChunks(ChunkGrid &chunks, float voxelSize, const BoundingBox &cascadeBounds, const BoundingBox &objectBounds, uint32_t objectIndex) -> void
+		{
+			glm::ivec3 objectChunkMin;
+			glm::ivec3 objectChunkMax;
+			getChunkId(voxelSize, cascadeBounds, objectBounds, objectChunkMin, objectChunkMax);
+
+			ChunkKey key;
+
+			for (key.coord.z = objectChunkMin.z; key.coord.z <= objectChunkMax.z; key.coord.z++)
+			{
+				for (key.coord.y = objectChunkMin.y; key.coord.y <= objectChunkMax.y; key.coord.y++)
+				{
+					for (key.coord.x = objectChunkMin.x; key.coord.x <= objectChunkMax.x; key.coord.x++)
+					{
+						key.layer   = 0;
+						key.hash    = flatten(key.coord, glm::ivec3{KeyHashResolution});
+						auto *chunk = &chunks.get(key);
+
+						// Move to the next layer if chunk has overflown
+						while (chunk->modelsCount == MaxChunkModels)
+						{
+							key.nextLayer();
+							chunk = &chunks.get(key);
+						}
+						chunk->models[chunk->modelsCount++] = objectIndex;
+					}
+				}
+			}
+		}
+
+		auto resetCascade(CascadeData &cascade, const glm::ivec3 &minChunk, int32_t chunksPerAxis) -> void
+		{
+			cascade.recycledChunks.clear();
+			for (const auto &key : cascade.nonEmptyChunks)
+			{
+				if (key.layer == 0)
+					cascade.recycledChunks.emplace_back(key);
+			}
+			cascade.nonEmptyChunks.clear();
+			cascade.staticChunks.clear();
+			cascade.dirtyChunks.clear();
+			cascade.minChunk    = minChunk;
+			cascade.texelOffset = wrapChunk(minChunk, chunksPerAxis) * ChunkSize;
+		}
+
+		auto scrollCascade(CascadeData &cascade, const glm::ivec3 &minChunk, int32_t chunksPerAxis) -> void
+		{
+			auto outside = [&](const ChunkKey &key) {
+				const auto local = key.coord - minChunk;
+				return glm::any(glm::lessThan(local, glm::ivec3(0))) || glm::any(glm::greaterThanEqual(local, glm::ivec3(chunksPerAxis)));
+			};
+
+			for (auto it = cascade.nonEmptyChunks.begin(); it != cascade.nonEmptyChunks.end();)
+			{
+				if (!outside(*it))
+				{
+					++it;
+					continue;
+				}
+				if (it->layer == 0)
+					cascade.recycledChunks.emplace_back(*it);
+				it = cascade.nonEmptyChunks.erase(it);
+			}
+
+			// objects reaching past the cascade are clamped into its border chunks. along the axes the cascade moved,
+			// the old leading border and the new trailing border see a different set of them.
+			const auto delta = minChunk - cascade.minChunk;
+			auto onMovedBorder = [&](const ChunkKey &key) {
+				const auto oldLocal = key.coord - cascade.minChunk;
+				const auto newLocal = key.coord - minChunk;
+				const auto forward  = glm::greaterThan(delta, glm::ivec3(0));
+				const auto backward = glm::lessThan(delta, glm::ivec3(0));
+				return glm::any(forward && (glm::equal(oldLocal, glm::ivec3(chunksPerAxis - 1)) || glm::equal(newLocal, glm::ivec3(0)))) ||
+				       glm::any(backward && (glm::equal(oldLocal, glm::ivec3(0)) || glm::equal(newLocal, glm::ivec3(chunksPerAxis - 1))));
+			};
+
+			for (auto it = cascade.staticChunks.begin(); it != cascade.staticChunks.end();)
+			{
+				if (outside(*it) || onMovedBorder(*it))
+					it = cascade.staticChunks.erase(it);
+				else
+					++it;
+			}
+
+			cascade.minChunk    = minChunk;
+			cascade.texelOffset = wrapChunk(minChunk, chunksPerAxis) * ChunkSize;
+		}
+
+		auto planChunkDispatches(CascadeData &cascade, ChunkGrid &chunks, int32_t chunksPerAxis, uint32_t maxChunks, std::vector<ChunkDispatch> &dispatches) -> uint32_t
+		{
+			dispatches.clear();
+
+			for (const auto &key : cascade.dirtyChunks)
+			{
+				if (auto chunk = chunks.find(key))
+					chunk->dynamic = true;
+			}
+			cascade.dirtyChunks.clear();
+
+			for (const auto &recycled : cascade.recycledChunks)
+			{
+				ChunkKey key;
+				key.layer = 0;
+				key.coord = cascade.minChunk + wrapChunk(recycled.coord - cascade.minChunk, chunksPerAxis);
+				if (chunks.find(key) == nullptr)
+					dispatches.push_back({ChunkDispatch::Type::Clear, key.coord - cascade.minChunk});
+			}
+			cascade.recycledChunks.clear();
+
+			for (auto it = cascade.nonEmptyChunks.begin(); it != cascade.nonEmptyChunks.end();)
+			{        //when chunk merge or expand (like move object), so clear that chunk..
+				if (chunks.find(*it) != nullptr)
+				{
+					++it;
+					continue;
+				}
+
+				// only an overflow layer went away, redrawing the first layer overwrites the whole chunk.
+				ChunkKey firstLayer = *it;
+				firstLayer.layer    = 0;
+				firstLayer.hash     = flatten(firstLayer.coord, glm::ivec3{KeyHashResolution});
+				if (auto chunk = chunks.find(firstLayer))
+				{
+					chunk->dynamic = true;
+					it             = cascade.nonEmptyChunks.erase(it);
+					continue;
+				}
+
+				dispatches.push_back({ChunkDispatch::Type::Clear, it->coord - cascade.minChunk});
+				it = cascade.nonEmptyChunks.erase(it);
+			}
+
+			auto eraseLayers = [&](ChunkKey key) {
+				while (chunks.erase(key))
+					key.nextLayer();
+			};
+
+			std::vector<ChunkKey> pending;
+			chunks.forEach([&](const ChunkKey &chunkKey, const Chunk &chunk) {
+				if (chunkKey.layer == 0)
+				{
+					if (!chunk.dynamic && cascade.staticChunks.count(chunkKey) > 0)
+						eraseLayers(chunkKey);
+					else
+						pending.emplace_back(chunkKey);
+				}
+			});
+
+			const auto center = cascade.minChunk + chunksPerAxis / 2;
+			std::stable_sort(pending.begin(), pending.end(), [&](const ChunkKey &a, const ChunkKey &b) {
+				const auto da = a.coord - center;
+				const auto db = b.coord - center;
+				return glm::dot(glm::vec3(da), glm::vec3(da)) < glm::dot(glm::vec3(db), glm::vec3(db));
+			});
+
+			uint32_t planned  = 0;
+			uint32_t deferred = 0;
+			for (const auto &chunkKey : pending)
+			{
+				uint32_t layers = 0;
+				for (auto key = chunkKey; chunks.find(key) != nullptr; key.nextLayer())
+					layers++;
+
+				if (planned + layers <= maxChunks)
+				{
+					planned += layers;
+					cascade.staticChunks.emplace(chunkKey);
+					continue;
+				}
+
+				// texels scrolled in from another chunk must not be sampled until this one is rasterized.
+				if (cascade.staticChunks.count(chunkKey) == 0)
+				{
+					cascade.nonEmptyChunks.erase(chunkKey);
+					dispatches.push_back({ChunkDispatch::Type::Clear, chunkKey.coord - cascade.minChunk});
+				}
+				cascade.dirtyChunks.emplace(chunkKey);
+				eraseLayers(chunkKey);
+				deferred++;
+			}
+
+			chunks.forEach([&](const ChunkKey &key, const Chunk &chunk) {
+				if (key.layer == 0)        //first layer..
+				{
+					cascade.nonEmptyChunks.emplace(key);
+					dispatches.push_back({chunk.modelsCount > 0 ? ChunkDispatch::Type::Rasterize : ChunkDispatch::Type::Clear, key.coord - cascade.minChunk, &chunk});
+				}
+			});
+
+			chunks.forEach([&](const ChunkKey &key, const Chunk &chunk) {
+				//additive layers, combine with existing chunk data
+				if (key.layer != 0 && chunk.modelsCount > 0)
+				{
+					cascade.nonEmptyChunks.emplace(key);
+					dispatches.push_back({ChunkDispatch::Type::RasterizeAdditive, key.coord - cascade.minChunk, &chunk});
+				}
+			});
+			return deferred;
+		}
+	};        // namespace sdf::chunks
+}        // namespace maple
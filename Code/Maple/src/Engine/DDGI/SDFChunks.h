@@ -0,0 +1,254 @@
+//////////////////////////////////////////////////////////////////////////////
+// This file is part of the Maple Engine                              		//
+//////////////////////////////////////////////////////////////////////////////
+#pragma once
+#include "Engine/Core.h"
+#include "Math/BoundingBox.h"
+#include "Others/Console.h"
+
+#include <glm/glm.hpp>
+#include <unordered_set>
+#include <vector>
+
+namespace maple
+{
+	/**
+	 * cpu side bookkeeping of the global sdf cascades : which 32^3 chunks hold which objects, which are still valid
+	 * in the toroidal texture and which have to be cleared or rasterized next. no gpu work happens here,
+	 * the renderer turns the planned dispatches into compute passes.
+	 */
+	namespace sdf::chunks
+	{
+		constexpr int32_t ChunkSize         = 32;        // voxels per chunk side
+		constexpr int32_t MaxChunkModels    = 28;        // objects per chunk layer, more spill into the next layer
+		constexpr int32_t ChunkMargin       = 4;         // voxels an object is extended by before it is binned
+		constexpr int32_t KeyHashResolution = ChunkSize;
+
+		inline auto flatten(const glm::ivec3 &position, const glm::ivec3 &resolution)
+		{
+			return position.x + position.y * resolution.x + position.z * resolution.x * resolution.y;
+		}
+
+		struct Chunk
+		{
+			enum class State : uint8_t
+			{
+				Free,
+				Live,
+				Erased        // still listed, skipped until the next reset
+			};
+
+			State    state;
+			bool     dynamic;        // touched by a moved object, the cached rasterization is stale
+			uint16_t modelsCount;
+			uint32_t models[MaxChunkModels];
+
+			Chunk()
+			{
+				state       = State::Free;
+				modelsCount = 0;
+				dynamic     = false;
+			}
+		};
+
+		struct ChunkKey
+		{
+			uint32_t   hash;
+			int32_t    layer;
+			glm::ivec3 coord;
+
+			inline auto nextLayer()
+			{
+				layer++;
+				hash += KeyHashResolution * KeyHashResolution * KeyHashResolution;
+			}
+
+			friend auto operator==(const ChunkKey &a, const ChunkKey &b)
+			{
+				return a.hash == b.hash && a.coord == b.coord && a.layer == b.layer;
+			}
+		};
+
+		struct HashFunc
+		{
+			size_t operator()(const ChunkKey &i) const
+			{
+				return i.hash;
+			}
+		};
+
+		/**
+		 * chunk keys are world chunk coords, the cascade volume only covers [minChunk, minChunk + chunks).
+		 * the texture is addressed toroidally, so a chunk keeps its texels while the cascade scrolls and
+		 * only the slabs entering the volume are rasterized.
+		 */
+		struct CascadeData
+		{
+			glm::vec3                              position;
+			float                                  voxelSize;
+			BoundingBox                            bounds;
+			glm::ivec3                             minChunk{0};
+			glm::ivec3                             texelOffset{0};        // where minChunk starts in the texture
+			std::unordered_set<ChunkKey, HashFunc> nonEmptyChunks;
+			std::unordered_set<ChunkKey, HashFunc> staticChunks;
+			std::unordered_set<ChunkKey, HashFunc> dirtyChunks;           // objects moved, appeared or changed mip in them since the last update
+			std::vector<ChunkKey>                  recycledChunks;        // scrolled out, their texels still hold old data
+		};
+
+		/**
+		 * the chunks one cascade update rasterizes, a dense grid per layer indexed by chunk coord inside the cascade.
+		 * layers are only added, so references stay valid until the next reset. touched keys are
+		 * listed in insertion order, which keeps the dispatch order stable and the reset cheap.
+		 */
+		class ChunkGrid
+		{
+		  public:
+			inline auto reset(int32_t chunksPerAxis, const glm::ivec3 &minChunk)
+			{
+				for (const auto &key : keys)
+					at(key) = Chunk{};
+				keys.clear();
+				liveCount = 0;
+
+				origin = minChunk;
+				if (resolution != chunksPerAxis)
+				{
+					resolution = chunksPerAxis;
+					layers.clear();
+				}
+			}
+
+			inline auto get(const ChunkKey &key) -> Chunk &
+			{
+				while (static_cast<size_t>(key.layer) >= layers.size())
+					layers.emplace_back(resolution * resolution * resolution);
+
+				auto &chunk = at(key);
+				if (chunk.state == Chunk::State::Free)
+					keys.emplace_back(key);
+				if (chunk.state != Chunk::State::Live)
+				{
+					chunk.state = Chunk::State::Live;
+					liveCount++;
+				}
+				return chunk;
+			}
+
+			inline auto find(const ChunkKey &key) -> Chunk *
+			{
+				if (static_cast<size_t>(key.layer) >= layers.size() || !inside(key.coord))
+					return nullptr;
+				auto &chunk = at(key);
+				return chunk.state == Chunk::State::Live ? &chunk : nullptr;
+			}
+
+			inline auto erase(const ChunkKey &key) -> bool
+			{
+				auto chunk = find(key);
+				if (chunk == nullptr)
+					return false;
+				chunk->state       = Chunk::State::Erased;
+				chunk->modelsCount = 0;
+				liveCount--;
+				return true;
+			}
+
+			inline auto empty() const
+			{
+				return liveCount == 0;
+			}
+
+			template <typename Callback>
+			inline auto forEach(Callback &&callback)
+			{
+				for (const auto &key : keys)
+				{
+					if (auto &chunk = at(key); chunk.state == Chunk::State::Live)
+						callback(key, chunk);
+				}
+			}
+
+		  private:
+			inline auto inside(const glm::ivec3 &coord) const -> bool
+			{
+				return glm::all(glm::greaterThanEqual(coord, origin)) && glm::all(glm::lessThan(coord, origin + resolution));
+			}
+
+			inline auto at(const ChunkKey &key) -> Chunk &
+			{
+				MAPLE_ASSERT(inside(key.coord), "chunk coord outside of the cascade");
+				return layers[key.layer][flatten(key.coord - origin, glm::ivec3(resolution))];
+			}
+
+			std::vector<std::vector<Chunk>> layers;
+			std::vector<ChunkKey>           keys;
+			glm::ivec3                      origin{0};
+			int32_t                         resolution = 0;
+			int32_t                         liveCount  = 0;
+		};
+
+		struct ChunkDispatch
+		{
+			enum class Type : uint8_t
+			{
+				Clear,
+				Rasterize,                // first layer, overwrites the chunk
+				RasterizeAdditive         // overflow layers, combine with the chunk
+			};
+
+			Type         type;
+			glm::ivec3   coord;        // in chunks, relative to the cascade window
+			const Chunk *chunk = nullptr;
+		};
+
+		// positive modulo, the texture chunk slot a world chunk coord lives in.
+		inline auto wrapChunk(const glm::ivec3 &coord, int32_t chunksPerAxis) -> glm::ivec3
+		{
+			return ((coord % chunksPerAxis) + chunksPerAxis) % chunksPerAxis;
+		}
+
+		// chunks of the new window the old one did not cover.
+		inline auto getEnteringChunks(const glm::ivec3 &from, const glm::ivec3 &to, int32_t chunksPerAxis) -> uint32_t
+		{
+			const auto overlap = glm::max(glm::ivec3(chunksPerAxis) - glm::abs(to - from), glm::ivec3(0));
+			return chunksPerAxis * chunksPerAxis * chunksPerAxis - overlap.x * overlap.y * overlap.z;
+		}
+
+		/**
+		 * the world chunks an object is rasterized into, its bounds grown by the chunk margin and clamped to the cascade.
+		 */
+		auto MAPLE_EXPORT getChunkId(float voxelSize, const BoundingBox &cascadeBounds, const BoundingBox &objectBounds, glm::ivec3 &objectChunkMin, glm::ivec3 &objectChunkMax) -> void;
+
+		/**
+		 * the box around the bounding sphere, cascades select objects by their sphere so this is what the object tree stores.
+		 */
+		auto MAPLE_EXPORT getObjectBounds(const BoundingBox &objectBounds) -> BoundingBox;
+
+		/**
+		 * marks every chunk the object bounds are rasterized into as dirty, the next update of the cascade redraws them.
+		 */
+		auto MAPLE_EXPORT invalidateChunks(std::vector<CascadeData> &cascades, const BoundingBox &objectBounds) -> void;
+
+		auto MAPLE_EXPORT addObjectToChunks(ChunkGrid &chunks, float voxelSize, const BoundingBox &cascadeBounds, const BoundingBox &objectBounds, uint32_t objectIndex) -> void;
+
+		/**
+		 * recenters the cascade without keeping anything, for a reset or a new voxel size.
+		 * chunks holding data are cleared unless they are rasterized again.
+		 */
+		auto MAPLE_EXPORT resetCascade(CascadeData &cascade, const glm::ivec3 &minChunk, int32_t chunksPerAxis) -> void;
+
+		/**
+		 * moves the cascade window, chunks that left it are forgotten and their texture slots recycled.
+		 */
+		auto MAPLE_EXPORT scrollCascade(CascadeData &cascade, const glm::ivec3 &minChunk, int32_t chunksPerAxis) -> void;
+
+		/**
+		 * decides which chunks of the cascade are cleared and rasterized this update, in dispatch order.
+		 * static chunks that were rasterized before are left alone unless they are dirty, chunks that lost
+		 * every object and recycled slots nobody rasterizes into are cleared.
+		 * at most maxChunks rasterize dispatches are planned, closest to the view first. the rest stay dirty,
+		 * the ones without a valid rasterization are cleared meanwhile. returns how many chunks were deferred.
+		 */
+		auto MAPLE_EXPORT planChunkDispatches(CascadeData &cascade, ChunkGrid &chunks, int32_t chunksPerAxis, uint32_t maxChunks, std::vector<ChunkDispatch> &dispatches) -> uint32_t;
+	};        // namespace sdf::chunks
+}        // namespace maple
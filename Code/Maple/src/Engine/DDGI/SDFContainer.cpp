@@ -0,0 +1,250 @@
+//////////////////////////////////////////////////////////////////////////////
+// This file is part of the Maple Engine                              		//
+//////////////////////////////////////////////////////////////////////////////
+
+#include "SDFContainer.h"
+
+#include <glm/gtc/packing.hpp>
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+
+namespace maple
+{
+	namespace sdf::container
+	{
+		namespace
+		{
+			inline auto alignUp(uint64_t value, uint64_t alignment)
+			{
+				return (value + alignment - 1) & ~(alignment - 1);
+			}
+
+			// offset + length could wrap for a corrupt header, so compare against what is left.
+			inline auto fits(uint64_t offset, uint64_t length, uint64_t size)
+			{
+				return offset <= size && length <= size - offset;
+			}
+
+			inline auto fail(std::string &error, const std::string &reason)
+			{
+				error = reason;
+				return false;
+			}
+		}        // namespace
+
+		auto write(const std::string &path, Header header, const std::vector<std::vector<uint8_t>> &mips, const bricks::BrickVolume *bricks) -> bool
+		{
+			if (mips.empty() || mips.size() > MaxMips)
+				return false;
+
+			header.magic    = Magic;
+			header.version  = Version;
+			header.mipCount = static_cast<uint32_t>(mips.size());
+			header.reserved = 0;
+
+			uint64_t offset = alignUp(sizeof(Header), PayloadAlignment);
+			for (uint32_t i = 0; i < MaxMips; i++)
+			{
+				auto &mip = header.mips[i];
+				mip       = {};
+				if (i < header.mipCount)
+				{
+					mip.width  = std::max(header.width >> i, 1u);
+					mip.height = std::max(header.height >> i, 1u);
+					mip.depth  = std::max(header.depth >> i, 1u);
+					mip.size   = i == 0 && bricks != nullptr ? 0 : mips[i].size();
+					mip.offset = offset;
+					offset     = alignUp(offset + mip.size, PayloadAlignment);
+				}
+			}
+
+			header.sparse = {};
+			if (bricks != nullptr)
+			{
+				header.sparse.brickCount        = bricks->brickCount;
+				header.sparse.band              = bricks->band;
+				header.sparse.indirectionOffset = offset;
+				header.sparse.indirectionSize   = bricks->indirection.size() * sizeof(uint32_t);
+				offset                          = alignUp(offset + header.sparse.indirectionSize, PayloadAlignment);
+				header.sparse.brickOffset       = offset;
+				header.sparse.brickSize         = bricks->bricks.size() * sizeof(uint16_t);
+			}
+
+			std::ofstream os(path, std::ios::binary);
+			if (!os)
+				return false;
+
+			constexpr char padding[PayloadAlignment] = {};
+
+			os.write(reinterpret_cast<const char *>(&header), sizeof(Header));
+			uint64_t written = sizeof(Header);
+			for (uint32_t i = 0; i < header.mipCount; i++)
+			{
+				os.write(padding, header.mips[i].offset - written);
+				os.write(reinterpret_cast<const char *>(mips[i].data()), header.mips[i].size);
+				written = header.mips[i].offset + header.mips[i].size;
+			}
+
+			if (bricks != nullptr)
+			{
+				os.write(padding, header.sparse.indirectionOffset - written);
+				os.write(reinterpret_cast<const char *>(bricks->indirection.data()), header.sparse.indirectionSize);
+				written = header.sparse.indirectionOffset + header.sparse.indirectionSize;
+				os.write(padding, header.sparse.brickOffset - written);
+				os.write(reinterpret_cast<const char *>(bricks->bricks.data()), header.sparse.brickSize);
+			}
+			return os.good();
+		}
+
+		auto validate(const uint8_t *data, size_t size, std::string &error) -> bool
+		{
+			if (data == nullptr || size < sizeof(Header))
+				return fail(error, "truncated header");
+
+			Header header;
+			memcpy(&header, data, sizeof(Header));
+
+			if (header.magic != Magic)
+				return fail(error, "bad magic, not a mesh distance field");
+			if (header.version != Version)
+				return fail(error, "unsupported version " + std::to_string(header.version));
+
+			const auto texelSize = getTexelSize(header.format);
+			if (texelSize == 0)
+				return fail(error, "unknown texel format");
+
+			if (header.width == 0 || header.height == 0 || header.depth == 0 ||
+			    header.width > MaxResolution || header.height > MaxResolution || header.depth > MaxResolution)
+				return fail(error, "invalid dimensions");
+
+			if (header.mipCount == 0 || header.mipCount > MaxMips)
+				return fail(error, "invalid mip count");
+
+			if (!(header.maxDistance > 0.f) || glm::any(glm::greaterThan(header.aabbMin, header.aabbMax)))
+				return fail(error, "invalid bounds");
+
+			uint64_t end = sizeof(Header);
+			for (uint32_t i = 0; i < header.mipCount; i++)
+			{
+				const auto &mip = header.mips[i];
+				if (mip.width != std::max(header.width >> i, 1u) ||
+				    mip.height != std::max(header.height >> i, 1u) ||
+				    mip.depth != std::max(header.depth >> i, 1u))
+					return fail(error, "mip " + std::to_string(i) + " does not match the mip chain");
+
+				// mip0 lives in the bricks when there are some.
+				const bool sparse = i == 0 && header.sparse.indirectionSize != 0;
+				if (mip.size != (sparse ? 0 : uint64_t(mip.width) * mip.height * mip.depth * texelSize))
+					return fail(error, "mip " + std::to_string(i) + " has a wrong payload size");
+
+				if (mip.offset % PayloadAlignment != 0 || mip.offset < end)
+					return fail(error, "mip " + std::to_string(i) + " is misaligned or overlaps");
+
+				if (!fits(mip.offset, mip.size, size))
+					return fail(error, "mip " + std::to_string(i) + " is truncated");
+
+				end = mip.offset + mip.size;
+			}
+
+			const auto &sparse = header.sparse;
+			if (sparse.indirectionSize != 0)
+			{
+				const auto brickCount = (glm::uvec3(header.width, header.height, header.depth) + glm::uvec3(bricks::BrickSize - 1)) / bricks::BrickSize;
+				if (sparse.brickCount != brickCount)
+					return fail(error, "brick grid does not match the dimensions");
+
+				if (sparse.indirectionSize != uint64_t(brickCount.x) * brickCount.y * brickCount.z * sizeof(uint32_t) ||
+				    sparse.brickSize % (bricks::BrickVoxels * sizeof(uint16_t)) != 0)
+					return fail(error, "bricks have a wrong payload size");
+
+				if (!fits(sparse.indirectionOffset, sparse.indirectionSize, size) || !fits(sparse.brickOffset, sparse.brickSize, size))
+					return fail(error, "bricks are truncated");
+
+				// both ends are inside the file now, so the sum below cannot wrap.
+				if (sparse.indirectionOffset % PayloadAlignment != 0 || sparse.indirectionOffset < end ||
+				    sparse.brickOffset % PayloadAlignment != 0 || sparse.brickOffset < sparse.indirectionOffset + sparse.indirectionSize)
+					return fail(error, "bricks are misaligned or overlap");
+
+				const auto slots = sparse.brickSize / (bricks::BrickVoxels * sizeof(uint16_t));
+				for (uint64_t i = 0; i < sparse.indirectionSize / sizeof(uint32_t); i++)
+				{
+					uint32_t slot;
+					memcpy(&slot, data + sparse.indirectionOffset + i * sizeof(uint32_t), sizeof(uint32_t));
+					if (slot != bricks::EmptyInside && slot != bricks::EmptyOutside && slot >= slots)
+						return fail(error, "brick indirection points past the brick pool");
+				}
+			}
+			return true;
+		}
+
+		auto MappedFile::open(const std::string &path, std::string &error) -> bool
+		{
+			std::error_code code;
+			mmap.map(path, code);
+			if (code)
+				return fail(error, code.message());
+			return validate(reinterpret_cast<const uint8_t *>(mmap.data()), mmap.size(), error);
+		}
+
+		auto MappedFile::getMip(uint32_t level, std::vector<uint8_t> &storage) const -> const uint8_t *
+		{
+			const auto &header = getHeader();
+			const auto  data   = reinterpret_cast<const uint8_t *>(mmap.data());
+			if (level != 0 || !hasBricks())
+				return data + header.mips[level].offset;
+
+			const auto &sparse     = header.sparse;
+			const auto  resolution = glm::uvec3(header.width, header.height, header.depth);
+			const auto  inside     = glm::packHalf1x16((1.f - sparse.band) / 2.f);
+			const auto  outside    = glm::packHalf1x16((1.f + sparse.band) / 2.f);
+
+			storage.resize(getMipBytes(0));
+			auto texels = reinterpret_cast<uint16_t *>(storage.data());
+			for (uint32_t z = 0; z < resolution.z; z++)
+			{
+				for (uint32_t y = 0; y < resolution.y; y++)
+				{
+					for (uint32_t x = 0; x < resolution.x; x++)
+					{
+						const glm::uvec3 brick = glm::uvec3(x, y, z) / bricks::BrickSize;
+						const glm::uvec3 local = glm::uvec3(x, y, z) % bricks::BrickSize;
+
+						uint32_t slot;
+						memcpy(&slot, data + sparse.indirectionOffset + (brick.x + (brick.y + brick.z * sparse.brickCount.y) * sparse.brickCount.x) * sizeof(uint32_t), sizeof(uint32_t));
+
+						auto &texel = *texels++;
+						if (slot == bricks::EmptyInside)
+							texel = inside;
+						else if (slot == bricks::EmptyOutside)
+							texel = outside;
+						else
+						{
+							const auto voxel = slot * uint64_t(bricks::BrickVoxels) + local.x + (local.y + local.z * bricks::BrickSize) * bricks::BrickSize;
+							memcpy(&texel, data + sparse.brickOffset + voxel * sizeof(uint16_t), sizeof(uint16_t));
+						}
+					}
+				}
+			}
+			return storage.data();
+		}
+
+		auto MappedFile::loadBricks(bricks::BrickVolume &volume) const -> bool
+		{
+			if (!hasBricks())
+				return false;
+
+			const auto &header = getHeader();
+			const auto  data   = reinterpret_cast<const uint8_t *>(mmap.data());
+			volume.resolution  = {header.width, header.height, header.depth};
+			volume.brickCount  = header.sparse.brickCount;
+			volume.band        = header.sparse.band;
+			volume.indirection.resize(header.sparse.indirectionSize / sizeof(uint32_t));
+			volume.bricks.resize(header.sparse.brickSize / sizeof(uint16_t));
+			memcpy(volume.indirection.data(), data + header.sparse.indirectionOffset, header.sparse.indirectionSize);
+			memcpy(volume.bricks.data(), data + header.sparse.brickOffset, header.sparse.brickSize);
+			return true;
+		}
+	};        // namespace sdf::container
+}        // namespace maple
@@ -0,0 +1,135 @@
+//////////////////////////////////////////////////////////////////////////////
+// This file is part of the Maple Engine                              		//
+//////////////////////////////////////////////////////////////////////////////
+#pragma once
+#include "Engine/Core.h"
+#include "SDFBricks.h"
+
+#include <glm/glm.hpp>
+#include <mio/mmap.hpp>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+namespace maple
+{
+	/**
+	 * on-disk layout of a baked mesh distance field (.sdf).
+	 * a fixed little endian header followed by the mip payloads, each aligned to PayloadAlignment,
+	 * so a mapped file can be handed to the upload path without parsing or copying.
+	 * a file with narrow band bricks does not store mip0 densely (its size is 0), getMip decodes it from the bricks.
+	 * only depends on glm and mio, tools compile it without the rest of the engine.
+	 */
+	namespace sdf::container
+	{
+		static constexpr uint32_t Magic            = 0x4644534d;        // "MSDF"
+		static constexpr uint16_t Version          = 3;
+		static constexpr uint32_t MaxMips          = 8;
+		static constexpr uint32_t MaxResolution    = 1024;
+		static constexpr uint64_t PayloadAlignment = 16;
+
+		enum class Format : uint16_t
+		{
+			Unknown,
+			R16Float,        // (distance / maxDistance + 1) / 2
+		};
+
+		struct MipDesc
+		{
+			uint64_t offset;
+			uint64_t size;
+			uint32_t width;
+			uint32_t height;
+			uint32_t depth;
+			uint32_t reserved;
+		};
+
+		// optional narrow band bricks, see sdf::bricks. all zero when the file is dense only.
+		struct SparseDesc
+		{
+			uint64_t   indirectionOffset;
+			uint64_t   indirectionSize;
+			uint64_t   brickOffset;
+			uint64_t   brickSize;
+			glm::uvec3 brickCount;
+			float      band;
+		};
+
+		struct Header
+		{
+			uint32_t   magic;
+			uint16_t   version;
+			Format     format;
+			uint32_t   width;
+			uint32_t   height;
+			uint32_t   depth;
+			uint32_t   mipCount;
+			glm::vec3  aabbMin;
+			glm::vec3  aabbMax;
+			float      maxDistance;
+			uint32_t   reserved;
+			MipDesc    mips[MaxMips];
+			SparseDesc sparse;
+		};
+
+		static_assert(std::is_trivially_copyable_v<Header>);
+		static_assert(sizeof(MipDesc) == 32 && sizeof(SparseDesc) == 48 && sizeof(Header) == 360, "the header layout is part of the file format");
+
+		inline auto getTexelSize(Format format) -> uint32_t
+		{
+			switch (format)
+			{
+				case Format::R16Float:
+					return 2;
+				default:
+					return 0;
+			}
+		}
+
+		/**
+		 * fills magic, version and the mip table from the payloads and writes header + payloads to path.
+		 * mips[i] must hold width/height/depth >> i texels (at least 1). bricks are appended after the mips when given,
+		 * and then replace mips[0] on disk.
+		 */
+		auto MAPLE_EXPORT write(const std::string &path, Header header, const std::vector<std::vector<uint8_t>> &mips, const bricks::BrickVolume *bricks = nullptr) -> bool;
+
+		/**
+		 * checks magic, version, format, dimensions, the mip chain and that every payload lies inside size.
+		 * on failure error holds the reason.
+		 */
+		auto MAPLE_EXPORT validate(const uint8_t *data, size_t size, std::string &error) -> bool;
+
+		class MAPLE_EXPORT MappedFile
+		{
+		  public:
+			auto open(const std::string &path, std::string &error) -> bool;
+
+			inline auto getHeader() const -> const Header &
+			{
+				return *reinterpret_cast<const Header *>(mmap.data());
+			}
+
+			inline auto getMipBytes(uint32_t level) const -> uint64_t
+			{
+				const auto &mip = getHeader().mips[level];
+				return uint64_t(mip.width) * mip.height * mip.depth * getTexelSize(getHeader().format);
+			}
+
+			/**
+			 * getMipBytes(level) texels. points into the mapping, except for mip0 of a file with bricks,
+			 * which is decoded into storage : bricks keep their voxels, empty bricks become +-band.
+			 */
+			auto getMip(uint32_t level, std::vector<uint8_t> &storage) const -> const uint8_t *;
+
+			inline auto hasBricks() const -> bool
+			{
+				return getHeader().sparse.indirectionSize != 0;
+			}
+
+			auto loadBricks(bricks::BrickVolume &volume) const -> bool;
+
+		  private:
+			mio::mmap_source mmap;
+		};
+	};        // namespace sdf::container
+}        // namespace maple
@@ -0,0 +1,289 @@
+//////////////////////////////////////////////////////////////////////////////
+// This file is part of the Maple Engine                              		//
+//////////////////////////////////////////////////////////////////////////////
+
+#include "SDFQuery.h"
+#include "SDFContainer.h"
+#include "Others/Console.h"
+
+#include <glm/gtc/packing.hpp>
+
+#include <algorithm>
+#include <cstring>
+#include <limits>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#	define MAPLE_SDF_QUERY_SSE 1
+#	include <emmintrin.h>
+#endif
+
+namespace maple
+{
+	namespace sdf::query
+	{
+		namespace
+		{
+			// distance from a point to a box, zero inside.
+			inline auto boxDistance(const BoundingBox &box, const glm::vec3 &position)
+			{
+				return glm::length(glm::max(glm::max(box.min - position, position - box.max), glm::vec3(0.f)));
+			}
+
+			// same as combineDistanceToSDF in SDFCommon.glsl, the offset along the box face is unknown.
+			inline auto combineDistance(float volumeDistance, float distanceToVolume)
+			{
+				if (volumeDistance <= 0 && distanceToVolume <= 0)
+					return volumeDistance;
+				const float inside = std::max(volumeDistance, 0.f);
+				return std::sqrt(inside * inside + distanceToVolume * distanceToVolume);
+			}
+		}        // namespace
+
+		auto loadVolume(const std::string &path, uint32_t mip, std::string &error) -> std::shared_ptr<const Volume>
+		{
+			container::MappedFile file;
+			if (!file.open(path, error))
+				return nullptr;
+
+			const auto &header = file.getHeader();
+			auto        level  = std::min(mip, header.mipCount - 1);
+			while (level > 0 && (header.mips[level].width < 2 || header.mips[level].height < 2 || header.mips[level].depth < 2))
+				level--;
+
+			const auto &desc = header.mips[level];
+			if (desc.width < 2 || desc.height < 2 || desc.depth < 2)
+			{
+				error = "volume is too small to sample";
+				return nullptr;
+			}
+
+			auto volume          = std::make_shared<Volume>();
+			volume->path         = path;
+			volume->resolution   = glm::ivec3(glm::uvec3(desc.width, desc.height, desc.depth));
+			volume->aabb         = {header.aabbMin, header.aabbMax};
+			volume->localToVoxel = glm::vec3(volume->resolution) / volume->aabb.size();
+
+			const auto  count  = size_t(desc.width) * desc.height * desc.depth;
+			std::vector<uint8_t> decoded;
+			const auto *         texels = file.getMip(level, decoded);
+			volume->distances.resize(count);
+			for (size_t i = 0; i < count; i++)
+			{
+				uint16_t half;
+				memcpy(&half, texels + i * sizeof(uint16_t), sizeof(uint16_t));
+				volume->distances[i] = (glm::unpackHalf1x16(half) * 2.f - 1.f) * header.maxDistance;
+			}
+			return volume;
+		}
+
+		auto sample(const Volume &volume, const glm::vec3 &local) -> float
+		{
+			const glm::vec3  position = glm::clamp((local - volume.aabb.min) * volume.localToVoxel - 0.5f, glm::vec3(0.f), glm::vec3(volume.resolution - 1));
+			const glm::ivec3 base     = glm::min(glm::ivec3(position), volume.resolution - 2);
+			const glm::vec3  t        = position - glm::vec3(base);
+
+			const size_t strideY = volume.resolution.x;
+			const size_t strideZ = size_t(volume.resolution.x) * volume.resolution.y;
+			const float *c       = volume.distances.data() + base.x + base.y * strideY + base.z * strideZ;
+
+#ifdef MAPLE_SDF_QUERY_SSE
+			// x neighbours are adjacent, so each row of the cell is one 64 bit load.
+			const __m128 z0 = _mm_loadh_pi(_mm_loadl_pi(_mm_setzero_ps(), reinterpret_cast<const __m64 *>(c)), reinterpret_cast<const __m64 *>(c + strideY));
+			const __m128 z1 = _mm_loadh_pi(_mm_loadl_pi(_mm_setzero_ps(), reinterpret_cast<const __m64 *>(c + strideZ)), reinterpret_cast<const __m64 *>(c + strideY + strideZ));
+			const __m128 zz = _mm_add_ps(z0, _mm_mul_ps(_mm_sub_ps(z1, z0), _mm_set1_ps(t.z)));
+			const __m128 yy = _mm_add_ps(zz, _mm_mul_ps(_mm_sub_ps(_mm_movehl_ps(zz, zz), zz), _mm_set1_ps(t.y)));
+			const float  x0 = _mm_cvtss_f32(yy);
+			const float  x1 = _mm_cvtss_f32(_mm_shuffle_ps(yy, yy, _MM_SHUFFLE(1, 1, 1, 1)));
+			return x0 + (x1 - x0) * t.x;
+#else
+			const float c00 = glm::mix(c[0], c[strideZ], t.z);
+			const float c10 = glm::mix(c[1], c[1 + strideZ], t.z);
+			const float c01 = glm::mix(c[strideY], c[strideY + strideZ], t.z);
+			const float c11 = glm::mix(c[1 + strideY], c[1 + strideY + strideZ], t.z);
+			const float c0  = glm::mix(c00, c01, t.y);
+			const float c1  = glm::mix(c10, c11, t.y);
+			return glm::mix(c0, c1, t.x);
+#endif
+		}
+
+		DistanceQuery::DistanceQuery(std::shared_ptr<const DynamicAABBTree> tree) :
+		    tree(std::move(tree))
+		{
+		}
+
+		auto DistanceQuery::updateObject(uint32_t id, const std::string &bakedPath, const glm::mat4 &worldMatrix) -> bool
+		{
+			auto iter = ids.find(id);
+			if (iter == ids.end() || objects[iter->second].volume->path != bakedPath)
+			{
+				std::shared_ptr<const Volume> volume;
+				if (auto cached = volumes.find(bakedPath); cached != volumes.end())
+					volume = cached->second.lock();
+				if (volume == nullptr)
+				{
+					std::string error;
+					volume = loadVolume(bakedPath, mip, error);
+					if (volume == nullptr)
+					{
+						LOGW("distance queries skip {} : {}", bakedPath, error);
+						removeObject(id);
+						return false;
+					}
+					volumes[bakedPath] = volume;
+				}
+
+				if (iter == ids.end())
+				{
+					uint32_t slot;
+					if (freeSlots.empty())
+					{
+						slot = static_cast<uint32_t>(objects.size());
+						objects.emplace_back();
+					}
+					else
+					{
+						slot = freeSlots.back();
+						freeSlots.pop_back();
+					}
+					iter = ids.emplace(id, slot).first;
+				}
+				objects[iter->second].volume = volume;
+			}
+
+			auto &object        = objects[iter->second];
+			object.id           = id;
+			object.localToWorld = worldMatrix;
+			object.worldToLocal = glm::inverse(worldMatrix);
+			object.bounds       = object.volume->aabb.transform(worldMatrix);
+			object.scale        = std::min({glm::length(glm::vec3(worldMatrix[0])), glm::length(glm::vec3(worldMatrix[1])), glm::length(glm::vec3(worldMatrix[2]))});
+			return true;
+		}
+
+		auto DistanceQuery::removeObject(uint32_t id) -> void
+		{
+			auto iter = ids.find(id);
+			if (iter == ids.end())
+				return;
+
+			auto &object = objects[iter->second];
+			const auto path = object.volume->path;
+			object          = Object{};
+			freeSlots.emplace_back(iter->second);
+			ids.erase(iter);
+
+			if (auto volume = volumes.find(path); volume != volumes.end() && volume->second.expired())
+				volumes.erase(volume);
+		}
+
+		auto DistanceQuery::getResidentBytes() const -> uint64_t
+		{
+			uint64_t bytes = 0;
+			for (auto &[path, volume] : volumes)
+			{
+				if (auto resident = volume.lock())
+					bytes += resident->distances.size() * sizeof(float);
+			}
+			return bytes;
+		}
+
+		auto DistanceQuery::objectDistance(const Object &object, const glm::vec3 &position, float closest) const -> float
+		{
+			const auto &volume  = *object.volume;
+			const auto  local   = glm::vec3(object.worldToLocal * glm::vec4(position, 1.f));
+			const auto  clamped = glm::clamp(local, volume.aabb.min, volume.aabb.max);
+
+			// compared exactly, the round trip through both matrices leaves a small positive distance inside.
+			const float distanceToVolume = clamped == local ? 0.f : glm::distance(position, glm::vec3(object.localToWorld * glm::vec4(clamped, 1.f)));
+			if (distanceToVolume > 0 && distanceToVolume >= closest)
+				return distanceToVolume;
+
+			return combineDistance(sample(volume, clamped) * object.scale, distanceToVolume);
+		}
+
+		auto DistanceQuery::closest(const std::vector<uint32_t> &candidates, const glm::vec3 &position, float maxDistance, uint32_t *object) const -> float
+		{
+			float result = maxDistance;
+			for (auto slot : candidates)
+			{
+				const float bound = boxDistance(objects[slot].bounds, position);
+				if (bound > 0 && bound >= result)
+					continue;
+
+				const float distance = objectDistance(objects[slot], position, result);
+				if (distance < result)
+				{
+					result = distance;
+					if (object != nullptr)
+						*object = objects[slot].id;
+				}
+			}
+			return result;
+		}
+
+		auto DistanceQuery::gather(const BoundingBox &box, std::vector<uint32_t> &candidates) const -> void
+		{
+			// the tree also holds objects whose volume could not be read, they have no slot.
+			candidates.clear();
+			tree->query(box, [&](int32_t proxy) {
+				if (auto iter = ids.find(tree->getUserData(proxy)); iter != ids.end())
+					candidates.emplace_back(iter->second);
+				return true;
+			});
+		}
+
+		auto DistanceQuery::distance(const glm::vec3 *points, float *distances, size_t count, float maxDistance) const -> void
+		{
+			std::vector<uint32_t> candidates;
+			for (size_t i = 0; i < count; i++)
+			{
+				const auto &point = points[i];
+				gather({point - maxDistance, point + maxDistance}, candidates);
+				distances[i] = closest(candidates, point, maxDistance);
+			}
+		}
+
+		auto DistanceQuery::sphereTrace(const Ray *rays, RayHit *hits, size_t count) const -> void
+		{
+			std::vector<uint32_t> candidates;
+			for (size_t i = 0; i < count; i++)
+			{
+				const auto &ray = rays[i];
+				auto &      hit = hits[i];
+				hit             = RayHit{};
+				hit.distance    = ray.maxDistance;
+
+				// only objects along the segment can be hit, the others would just shorten the steps.
+				const auto end = ray.origin + ray.direction * ray.maxDistance;
+				gather({glm::min(ray.origin, end) - hitDistance, glm::max(ray.origin, end) + hitDistance}, candidates);
+				if (candidates.empty())
+					continue;
+
+				float travelled = 0;
+				for (; hit.steps < maxSteps && travelled < ray.maxDistance; hit.steps++)
+				{
+					const auto position = ray.origin + ray.direction * travelled;
+					uint32_t   object   = 0;
+					const auto distance = closest(candidates, position, ray.maxDistance - travelled + hitDistance, &object);
+					if (distance < hitDistance)
+					{
+						hit.hit      = true;
+						hit.distance = travelled;
+						hit.position = position;
+						hit.object   = object;
+
+						const glm::vec3 offsets[] = {{hitDistance, 0, 0}, {0, hitDistance, 0}, {0, 0, hitDistance}};
+						for (int32_t axis = 0; axis < 3; axis++)
+						{
+							hit.normal[axis] = closest(candidates, position + offsets[axis], std::numeric_limits<float>::max()) -
+							                   closest(candidates, position - offsets[axis], std::numeric_limits<float>::max());
+						}
+						const float length = glm::length(hit.normal);
+						hit.normal         = length > 0 ? hit.normal / length : -ray.direction;
+						break;
+					}
+					travelled += distance;
+				}
+			}
+		}
+	};        // namespace sdf::query
+}        // namespace maple
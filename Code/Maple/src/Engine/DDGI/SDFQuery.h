@@ -0,0 +1,121 @@
+//////////////////////////////////////////////////////////////////////////////
+// This file is part of the Maple Engine                              		//
+//////////////////////////////////////////////////////////////////////////////
+#pragma once
+#include "Engine/Core.h"
+#include "Math/BoundingBox.h"
+#include "Math/DynamicAABBTree.h"
+
+#include <glm/glm.hpp>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace maple
+{
+	/**
+	 * approximate world distance queries on the cpu, for gameplay and tools that can not wait for a gpu readback.
+	 * every loaded mesh distance field keeps one decoded mip in memory, objects are found with the box tree the
+	 * global sdf cascades already keep (user data is the object id) and combined the same way its rasterizer combines them.
+	 * queries only read, so they can run on any thread as long as neither the tree nor an object is updated meanwhile.
+	 */
+	namespace sdf::query
+	{
+		// one mip of a baked field, decoded to local space distances.
+		struct Volume
+		{
+			std::string        path;
+			glm::ivec3         resolution{0};        // at least 2 texels on every axis
+			BoundingBox        aabb;
+			glm::vec3          localToVoxel{0};        // resolution / aabb size
+			std::vector<float> distances;              // x fastest
+		};
+
+		/**
+		 * reads mip (or the finest one with at least 2 texels per axis, if coarser) of a baked field.
+		 */
+		auto MAPLE_EXPORT loadVolume(const std::string &path, uint32_t mip, std::string &error) -> std::shared_ptr<const Volume>;
+
+		/**
+		 * trilinear lookup at a local position, clamped to the outer texel centers like the atlas regions.
+		 */
+		auto MAPLE_EXPORT sample(const Volume &volume, const glm::vec3 &local) -> float;
+
+		struct Ray
+		{
+			glm::vec3 origin;
+			glm::vec3 direction;        // normalized
+			float     maxDistance;
+		};
+
+		struct RayHit
+		{
+			bool      hit      = false;
+			float     distance = 0;        // along the ray, maxDistance when nothing was hit
+			glm::vec3 position{0};
+			glm::vec3 normal{0};
+			uint32_t  object = 0;
+			uint32_t  steps  = 0;
+		};
+
+		class MAPLE_EXPORT DistanceQuery
+		{
+		  public:
+			/**
+			 * the tree is owned by the caller, which keeps one proxy per object with the object id as user data
+			 * and bounds covering the object.
+			 */
+			DistanceQuery(std::shared_ptr<const DynamicAABBTree> tree);
+
+			/**
+			 * adds the object or moves it, the volume is read the first time a baked path is seen.
+			 * the object is only found once the caller's tree has a proxy for it.
+			 */
+			auto updateObject(uint32_t id, const std::string &bakedPath, const glm::mat4 &worldMatrix) -> bool;
+			auto removeObject(uint32_t id) -> void;
+
+			/**
+			 * signed distance to the closest object for every point, maxDistance when nothing is closer.
+			 */
+			auto distance(const glm::vec3 *points, float *distances, size_t count, float maxDistance) const -> void;
+
+			/**
+			 * marches every ray until it comes closer than hitDistance to an object or runs past its maxDistance.
+			 */
+			auto sphereTrace(const Ray *rays, RayHit *hits, size_t count) const -> void;
+
+			inline auto getObjectCount() const
+			{
+				return static_cast<uint32_t>(ids.size());
+			}
+
+			auto getResidentBytes() const -> uint64_t;
+
+			uint32_t mip         = 1;        // of the baked fields, the query does not need the finest level
+			uint32_t maxSteps    = 64;
+			float    hitDistance = 0.05f;
+
+		  private:
+			struct Object
+			{
+				std::shared_ptr<const Volume> volume;
+				glm::mat4                     worldToLocal;
+				glm::mat4                     localToWorld;
+				BoundingBox                   bounds;       // world bounds of the volume, tighter than the tree's
+				float                         scale;        // smallest axis scale, local distances never grow by less
+				uint32_t                      id;
+			};
+
+			auto objectDistance(const Object &object, const glm::vec3 &position, float closest) const -> float;
+			auto closest(const std::vector<uint32_t> &candidates, const glm::vec3 &position, float maxDistance, uint32_t *object = nullptr) const -> float;
+			auto gather(const BoundingBox &box, std::vector<uint32_t> &candidates) const -> void;
+
+			std::shared_ptr<const DynamicAABBTree>                  tree;
+			std::vector<Object>                                     objects;
+			std::vector<uint32_t>                                   freeSlots;
+			std::unordered_map<uint32_t, uint32_t>                  ids;        // object id to its slot in objects
+			std::unordered_map<std::string, std::weak_ptr<const Volume>> volumes;
+		};
+	};        // namespace sdf::query
+}        // namespace maple
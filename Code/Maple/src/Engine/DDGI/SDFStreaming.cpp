@@ -0,0 +1,187 @@
+//////////////////////////////////////////////////////////////////////////////
+// This file is part of the Maple Engine                              		//
+//////////////////////////////////////////////////////////////////////////////
+
+#include "SDFStreaming.h"
+#include "Others/Console.h"
+
+#include <algorithm>
+#include <limits>
+#include <unordered_set>
+
+namespace maple
+{
+	namespace sdf::streaming
+	{
+		ResidencyManager::~ResidencyManager()
+		{
+			JobSystem::wait(context);
+		}
+
+		auto ResidencyManager::request(const std::shared_ptr<atlas::Entry> &entry, uint32_t wantedMip, float distance) -> void
+		{
+			if (entry != nullptr && !entry->mips.empty())
+				requests.push_back({entry, std::min<uint32_t>(wantedMip, static_cast<uint32_t>(entry->mips.size()) - 1), distance});
+		}
+
+		auto ResidencyManager::evict(atlas::MeshSDFAtlas &atlas, uint64_t required) -> bool
+		{
+			uint64_t inflightBytes = 0;
+			for (auto &read : reads)
+				inflightBytes += read->entry->getMipBytes(read->mip);
+
+			auto fits = [&]() {
+				return atlas.getResidentBytes() + inflightBytes + required <= budgetBytes;
+			};
+
+			// requests are sorted closest first, so walking backwards drops the farthest fields first.
+			// levels finer than wanted are free to go, the ones still sampled only when the budget itself is exceeded.
+			for (auto pass = 0; pass < 2 && !fits(); pass++)
+			{
+				if (pass == 1 && required != 0)
+					break;
+
+				for (auto it = requests.rbegin(); it != requests.rend() && !fits(); ++it)
+				{
+					auto &entry = *it->entry;
+					if (entry.streaming)
+						continue;
+
+					while (!fits() && (pass == 1 || entry.residentMip < it->wantedMip) && atlas.evict(entry))
+					{
+						changed.emplace_back(&entry);
+						stats.evicted++;
+					}
+				}
+			}
+			return fits();
+		}
+
+		auto ResidencyManager::update(atlas::MeshSDFAtlas &atlas, const CommandBuffer *cmd) -> const std::vector<atlas::Entry *> &
+		{
+			changed.clear();
+
+			uint32_t uploads = 0;
+			for (auto it = reads.begin(); it != reads.end() && uploads < maxUploadsPerFrame;)
+			{
+				auto &read = **it;
+				if (!read.ready.load(std::memory_order_acquire))
+				{
+					++it;
+					continue;
+				}
+
+				auto &entry     = *read.entry;
+				entry.streaming = false;
+				if (read.data.size() == entry.getMipBytes(read.mip) && read.mip + 1 == entry.residentMip)
+				{
+					if (atlas.upload(entry, read.mip, read.data.data(), cmd))
+					{
+						if (!entry.tracked)
+						{
+							entry.tracked = true;
+							streamed.emplace_back(read.entry);
+						}
+						changed.emplace_back(&entry);
+						stats.streamedIn++;
+						uploads++;
+					}
+				}
+				else if (read.data.empty())
+				{
+					LOGW("failed to stream MeshDistanceField {} mip {}", read.path, read.mip);
+				}
+				it = reads.erase(it);
+			}
+
+			std::sort(requests.begin(), requests.end(), [](const Request &a, const Request &b) {
+				return a.distance < b.distance;
+			});
+
+			// streamed fields nobody asked for are behind every request, evicted before any of them.
+			const auto requested = requests.size();
+			std::unordered_set<const atlas::Entry *> asked;
+			for (auto &request : requests)
+				asked.emplace(request.entry.get());
+
+			for (auto it = streamed.begin(); it != streamed.end();)
+			{
+				auto entry = it->lock();
+				if (entry == nullptr || entry->residentMip + 1 >= entry->mips.size())
+				{
+					if (entry != nullptr)
+						entry->tracked = false;
+					it = streamed.erase(it);
+					continue;
+				}
+				if (asked.count(entry.get()) == 0)
+					requests.push_back({entry, static_cast<uint32_t>(entry->mips.size()) - 1, std::numeric_limits<float>::max()});
+				++it;
+			}
+
+			evict(atlas, 0);
+
+			// coarser wanted levels first, they cover the larger cascades. the sort is stable so closer fields stay ahead.
+			std::vector<Request *> waiting;
+			for (auto &request : requests)
+			{
+				if (request.entry->residentMip > request.wantedMip)
+					waiting.emplace_back(&request);
+			}
+			std::stable_sort(waiting.begin(), waiting.end(), [](const Request *a, const Request *b) {
+				return a->wantedMip > b->wantedMip;
+			});
+
+			for (auto request : waiting)
+			{
+				if (reads.size() >= maxInflight)
+					break;
+
+				auto &entry = request->entry;
+				if (entry->streaming)
+					continue;
+
+				const auto mip = entry->residentMip - 1;
+				if (!evict(atlas, entry->getMipBytes(mip)))
+					break;
+
+				auto &read       = reads.emplace_back(std::make_unique<Read>());
+				read->entry      = entry;
+				read->path       = entry->path;
+				read->mip        = mip;
+				entry->streaming = true;
+
+				JobSystem::execute(context, [read = read.get()](JobSystem::JobDispatchArgs) {
+					container::MappedFile file;
+					std::string           error;
+					if (file.open(read->path, error) && read->mip < file.getHeader().mipCount)
+					{
+						std::vector<uint8_t> decoded;
+						const auto *         data = file.getMip(read->mip, decoded);
+						read->data.assign(data, data + file.getMipBytes(read->mip));
+					}
+					read->ready.store(true, std::memory_order_release);
+				});
+			}
+
+			Stats current;
+			current.residentBytes = atlas.getResidentBytes();
+			current.budgetBytes   = budgetBytes;
+			current.fields        = static_cast<uint32_t>(requested);
+			current.inflight      = static_cast<uint32_t>(reads.size());
+			current.streamedIn    = stats.streamedIn;
+			current.evicted       = stats.evicted;
+			stats                 = current;
+			for (size_t i = 0; i < requested; i++)
+			{
+				const auto &request = requests[i];
+				stats.residentLevels[std::min(request.entry->residentMip, container::MaxMips - 1)]++;
+				if (request.entry->residentMip > request.wantedMip)
+					stats.waiting++;
+			}
+
+			requests.clear();
+			return changed;
+		}
+	};        // namespace sdf::streaming
+}        // namespace maple
@@ -0,0 +1,97 @@
+//////////////////////////////////////////////////////////////////////////////
+// This file is part of the Maple Engine                              		//
+//////////////////////////////////////////////////////////////////////////////
+#pragma once
+#include "Engine/Core.h"
+#include "Engine/JobSystem.h"
+#include "SDFAtlas.h"
+#include "SDFContainer.h"
+
+#include <atomic>
+#include <memory>
+#include <vector>
+
+namespace maple
+{
+	class CommandBuffer;
+
+	/**
+	 * keeps only the mesh distance field mips the global sdf cascades sample.
+	 * fields are loaded with their coarsest mip, finer levels are read from the baked file on the JobSystem
+	 * as objects come closer and uploaded into the atlas on the render thread. when the atlas grows past the
+	 * budget, levels nobody needs any more go first, then the finest levels of the farthest fields.
+	 */
+	namespace sdf::streaming
+	{
+		struct Stats
+		{
+			uint64_t residentBytes = 0;
+			uint64_t budgetBytes   = 0;
+			uint32_t fields        = 0;        // requested this frame
+			uint32_t waiting       = 0;        // requested fields coarser than they want
+			uint32_t inflight      = 0;
+			uint32_t streamedIn    = 0;        // levels, since start
+			uint32_t evicted       = 0;
+			uint32_t residentLevels[container::MaxMips] = {};        // fields by their finest resident mip
+		};
+
+		class MAPLE_EXPORT ResidencyManager
+		{
+		  public:
+			~ResidencyManager();
+
+			/**
+			 * wantedMip is the finest level any cascade samples this frame, closer fields are served first.
+			 * requests only live until the next update. fields outside every cascade are not requested,
+			 * their streamed levels are the first to go.
+			 */
+			auto request(const std::shared_ptr<atlas::Entry> &entry, uint32_t wantedMip, float distance) -> void;
+
+			/**
+			 * uploads finished reads, evicts down to the budget and starts new reads.
+			 * returns the entries whose resident level changed, their rasterized chunks are stale.
+			 */
+			auto update(atlas::MeshSDFAtlas &atlas, const CommandBuffer *cmd) -> const std::vector<atlas::Entry *> &;
+
+			inline auto setBudget(uint64_t bytes)
+			{
+				budgetBytes = bytes;
+			}
+
+			inline auto &getStats() const
+			{
+				return stats;
+			}
+
+			uint32_t maxInflight        = 8;
+			uint32_t maxUploadsPerFrame = 4;
+
+		  private:
+			struct Request
+			{
+				std::shared_ptr<atlas::Entry> entry;
+				uint32_t                      wantedMip;
+				float                         distance;
+			};
+
+			struct Read
+			{
+				std::shared_ptr<atlas::Entry> entry;
+				std::string                   path;
+				uint32_t                      mip;
+				std::vector<uint8_t>          data;
+				std::atomic<bool>             ready{false};
+			};
+
+			auto evict(atlas::MeshSDFAtlas &atlas, uint64_t required) -> bool;
+
+			std::vector<Request>                      requests;
+			std::vector<std::weak_ptr<atlas::Entry>> streamed;        // fields holding levels finer than they were loaded with
+			std::vector<std::unique_ptr<Read>>       reads;
+			std::vector<atlas::Entry *>              changed;
+			JobSystem::Context                       context;
+			uint64_t                                 budgetBytes = 128ull << 20;
+			Stats                                    stats;
+		};
+	};        // namespace sdf::streaming
+}        // namespace maple
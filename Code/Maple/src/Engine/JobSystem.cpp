@@ -4,115 +4,426 @@
 
 #include "JobSystem.h"
 #include "Engine/Profiler.h"
+#include "Engine/Threading.h"
 #include "Others/Console.h"
+#include <algorithm>
+#include <deque>
 #include <sstream>
+#include <thread>
 
 namespace maple::JobSystem
 {
 	namespace internal
 	{
+		/**
+		 * Chase-Lev work-stealing deque (Le et al. 2013, weak memory model version).
+		 * Only the owner thread may push/pop at the bottom, any thread may steal from the top.
+		 * The capacity is fixed; push fails when full and the caller spills into the overflow queue.
+		 */
 		template <typename T, size_t capacity>
-		class RingBuffer
+		class WorkStealingQueue
 		{
+			static_assert((capacity & (capacity - 1)) == 0, "capacity should be power of two");
+
 		  public:
-			inline bool push(const T &item)
+			inline bool push(T item)
 			{
-				//PROFILE_FUNCTION();
+				const int64_t b = bottom.load(std::memory_order_relaxed);
+				const int64_t t = top.load(std::memory_order_acquire);
+				if (b - t >= (int64_t) capacity)
+					return false;
+				data[b & (capacity - 1)].store(item, std::memory_order_relaxed);
+				std::atomic_thread_fence(std::memory_order_release);
+				bottom.store(b + 1, std::memory_order_relaxed);
+				return true;
+			}
+
+			inline bool pop(T &item)
+			{
+				const int64_t b = bottom.load(std::memory_order_relaxed) - 1;
+				bottom.store(b, std::memory_order_relaxed);
+				std::atomic_thread_fence(std::memory_order_seq_cst);
+				int64_t t = top.load(std::memory_order_relaxed);
+
 				bool result = false;
-				lock.lock();
-				size_t next = (head + 1) % capacity;
-				if (next != tail)
+				if (t <= b)
+				{
+					item   = data[b & (capacity - 1)].load(std::memory_order_relaxed);
+					result = true;
+					if (t == b)
+					{
+						//last item, race against thieves.
+						result = top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed);
+						bottom.store(b + 1, std::memory_order_relaxed);
+					}
+				}
+				else
 				{
-					data[head] = item;
-					head       = next;
-					result     = true;
+					bottom.store(b + 1, std::memory_order_relaxed);
 				}
-				lock.unlock();
 				return result;
 			}
+
+			inline bool steal(T &item)
+			{
+				int64_t t = top.load(std::memory_order_acquire);
+				std::atomic_thread_fence(std::memory_order_seq_cst);
+				const int64_t b = bottom.load(std::memory_order_acquire);
+				if (t < b)
+				{
+					item = data[t & (capacity - 1)].load(std::memory_order_relaxed);
+					return top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed);
+				}
+				return false;
+			}
+
+		  private:
+			alignas(64) std::atomic<int64_t> top{0};
+			alignas(64) std::atomic<int64_t> bottom{0};
+			std::atomic<T> data[capacity];
+		};
+
+		/**
+		 * Unbounded queue used when a local deque is full or the producer is not a job-system thread.
+		 */
+		template <typename T>
+		class OverflowQueue
+		{
+		  public:
+			inline auto push(const T &item) -> void
+			{
+				std::lock_guard<std::mutex> locker(lock);
+				data.emplace_back(item);
+				size.fetch_add(1, std::memory_order_release);
+			}
+
 			inline bool pop(T &item)
 			{
-				//PROFILE_FUNCTION();
-				bool result = false;
-				lock.lock();
-				if (tail != head)
+				if (size.load(std::memory_order_acquire) == 0)
+					return false;
+				std::lock_guard<std::mutex> locker(lock);
+				if (data.empty())
+					return false;
+				item = data.front();
+				data.pop_front();
+				size.fetch_sub(1, std::memory_order_release);
+				return true;
+			}
+
+		  private:
+			std::deque<T>         data;
+			std::atomic<uint32_t> size{0};
+			std::mutex            lock;
+		};
+
+		/**
+		 * Bump allocator over a list of blocks. Blocks are kept after a rewind so a steady workload stops allocating.
+		 */
+		class ScratchArena
+		{
+		  public:
+			static constexpr size_t BlockSize = 1024 * 1024;
+
+			struct Marker
+			{
+				size_t block;
+				size_t offset;
+				size_t used;
+			};
+
+			ScratchArena() = default;
+			NO_COPYABLE(ScratchArena);
+
+			~ScratchArena()
+			{
+				for (auto &block : blocks)
 				{
-					item   = data[tail];
-					tail   = (tail + 1) % capacity;
-					result = true;
+					::operator delete(block.data, std::align_val_t(Alignment));
 				}
-				lock.unlock();
-				return result;
+			}
+
+			inline auto allocate(size_t size, size_t alignment) -> void *
+			{
+				alignment = std::max<size_t>(alignment, 1);
+				MAPLE_ASSERT((alignment & (alignment - 1)) == 0, "scratch alignment should be power of two");
+
+				while (current < blocks.size())
+				{
+					auto &      block   = blocks[current];
+					const auto  address = reinterpret_cast<uintptr_t>(block.data) + offset;
+					const auto  aligned = (address + alignment - 1) & ~(uintptr_t) (alignment - 1);
+					const auto  end     = aligned - reinterpret_cast<uintptr_t>(block.data) + size;
+					if (end <= block.size)
+					{
+						used += end - offset;
+						offset = end;
+						return reinterpret_cast<void *>(aligned);
+					}
+					//skip the tail of this block.
+					used += block.size - offset;
+					offset = 0;
+					current++;
+					if (current < blocks.size() && blocks[current].size < size + alignment)
+					{
+						break;
+					}
+				}
+
+				Block block;
+				block.size = std::max(BlockSize, size + alignment);
+				block.data = static_cast<uint8_t *>(::operator new(block.size, std::align_val_t(Alignment)));
+				blocks.insert(blocks.begin() + current, block);
+				reserved += block.size;
+				offset = 0;
+				return allocate(size, alignment);
+			}
+
+			inline auto getMarker() const -> Marker
+			{
+				return {current, offset, used};
+			}
+
+			inline auto rewind(const Marker &marker) -> void
+			{
+				current = marker.block;
+				offset  = marker.offset;
+				used    = marker.used;
+			}
+
+			inline auto getUsed() const
+			{
+				return used;
+			}
+
+			inline auto getReserved() const
+			{
+				return reserved;
 			}
 
 		  private:
-			T          data[capacity];
-			size_t     head = 0;
-			size_t     tail = 0;
-			std::mutex lock;
+			static constexpr size_t Alignment = 64;
+
+			struct Block
+			{
+				uint8_t *data;
+				size_t   size;
+			};
+
+			std::vector<Block> blocks;
+			size_t             current  = 0;
+			size_t             offset   = 0;
+			size_t             used     = 0;
+			size_t             reserved = 0;
 		};
+
+		inline auto random() -> uint32_t
+		{
+			//xorshift32, seeded per thread
+			thread_local uint32_t state = (uint32_t) std::hash<std::thread::id>{}(std::this_thread::get_id()) | 1u;
+			state ^= state << 13;
+			state ^= state >> 17;
+			state ^= state << 5;
+			return state;
+		}
 	}        // namespace internal
 
+	struct JobBlock;
+
 	struct Job
 	{
-		Context *                            ctx;
-		std::function<void(JobDispatchArgs)> task;
-		uint32_t                             groupID;
-		uint32_t                             groupJobOffset;
-		uint32_t                             groupJobEnd;
-		uint32_t                             sharedMemorySize;
+		JobBlock *block;
+		uint32_t  groupID;
+		uint32_t  groupJobOffset;
+		uint32_t  groupJobEnd;
 	};
 
+	/**
+	 * Control block of one dispatch. It is a single allocation holding the block itself,
+	 * the jobs of every group and the callable, and it is released by the last finished group.
+	 */
+	struct JobBlock
+	{
+		Context *                   ctx;
+		internal::Callable::Invoke  invoke;
+		internal::Callable::Destroy destroy;
+		void *                      object;
+		size_t                      alignment;
+		uint32_t                    sharedMemorySize;
+		std::atomic<uint32_t>       remaining;
+
+		inline auto getJobs() -> Job *
+		{
+			return reinterpret_cast<Job *>(this + 1);
+		}
+	};
+
+	static constexpr size_t LocalQueueSize = 1024;
+
+	using LocalQueue = internal::WorkStealingQueue<Job *, LocalQueueSize>;
+
 	uint32_t                                  numThreads = 0;
-	internal::RingBuffer<Job, 256>            jobQueue;
+	std::vector<std::unique_ptr<LocalQueue>>  localQueues;        //one per worker, plus one for the thread calling init
+	internal::OverflowQueue<Job *>            overflowQueue;
+	std::atomic<uint32_t>                     pendingJobs{0};
+	std::atomic<uint32_t>                     sleepingThreads{0};
 	std::condition_variable                   wakeCondition;
 	std::mutex                                wakeMutex;
 	std::vector<std::shared_ptr<std::thread>> threads;
 
+	thread_local int32_t threadIndex = -1;
+
+	/**
+	 * Scratch memory of one thread. Only the owner allocates or rewinds; endFrame just bumps the frame index
+	 * and the owner resets its frame arena lazily, so no arena is touched while its thread is still running a job.
+	 */
+	struct ThreadScratch
+	{
+		ThreadScratch();
+		~ThreadScratch();
+
+		internal::ScratchArena group;
+		internal::ScratchArena frame;
+		uint64_t               frameIndex = 0;
+		uint32_t               depth      = 0;        //nesting of job groups running on this thread
+		std::atomic<size_t>    peak{0};
+		std::atomic<size_t>    reserved{0};
+
+		inline auto updateStats()
+		{
+			const auto inUse = group.getUsed() + frame.getUsed();
+			if (inUse > peak.load(std::memory_order_relaxed))
+				peak.store(inUse, std::memory_order_relaxed);
+			reserved.store(group.getReserved() + frame.getReserved(), std::memory_order_relaxed);
+		}
+	};
+
+	std::atomic<uint64_t>       scratchFrame{0};
+	std::mutex                  scratchMutex;
+	std::vector<ThreadScratch *> scratches;
+	ScratchStats                scratchStats;
+
+	ThreadScratch::ThreadScratch()
+	{
+		frameIndex = scratchFrame.load();
+		std::lock_guard<std::mutex> locker(scratchMutex);
+		scratches.emplace_back(this);
+	}
+
+	ThreadScratch::~ThreadScratch()
+	{
+		std::lock_guard<std::mutex> locker(scratchMutex);
+		scratches.erase(std::remove(scratches.begin(), scratches.end(), this), scratches.end());
+	}
+
+	inline auto getThreadScratch() -> ThreadScratch &
+	{
+		thread_local ThreadScratch scratch;
+		return scratch;
+	}
+
+	inline auto pushJob(Job *job) -> void
+	{
+		pendingJobs.fetch_add(1);
+		if (threadIndex < 0 || !localQueues[threadIndex]->push(job))
+		{
+			overflowQueue.push(job);
+		}
+
+		if (sleepingThreads.load() > 0)
+		{
+			//serialize with a worker which is about to sleep so the notification could not be lost.
+			std::lock_guard<std::mutex> locker(wakeMutex);
+		}
+		wakeCondition.notify_one();
+	}
+
+	inline auto popJob(Job *&job) -> bool
+	{
+		if (threadIndex >= 0 && localQueues[threadIndex]->pop(job))
+			return true;
+
+		if (overflowQueue.pop(job))
+			return true;
+
+		const uint32_t queueCount = (uint32_t) localQueues.size();
+		if (queueCount == 0)
+			return false;
+
+		const uint32_t start = internal::random() % queueCount;
+		for (uint32_t i = 0; i < queueCount; ++i)
+		{
+			const uint32_t victim = (start + i) % queueCount;
+			if ((int32_t) victim != threadIndex && localQueues[victim]->steal(job))
+				return true;
+		}
+		return false;
+	}
+
 	inline auto work()
 	{
-		Job job;
-		if (jobQueue.pop(job))
+		Job *job = nullptr;
+		if (popJob(job))
 		{
-			JobDispatchArgs args;
-			args.groupID = job.groupID;
-			if (job.sharedMemorySize > 0)
-			{
-				args.sharedMemory = alloca(job.sharedMemorySize);        //a stack memory. so no need to delete.
-			}
-			else
+			pendingJobs.fetch_sub(1);
+			auto block = job->block;
+
+			auto &scratch = getThreadScratch();
+			auto  marker  = scratch.group.getMarker();
+			scratch.depth++;
+
+			void *sharedMemory = nullptr;
+			if (block->sharedMemorySize > 0)
 			{
-				args.sharedMemory = nullptr;
+				sharedMemory = allocateScratch(block->sharedMemorySize);
 			}
 
-			for (uint32_t i = job.groupJobOffset; i < job.groupJobEnd; ++i)
+			block->invoke(block->object, job->groupID, job->groupJobOffset, job->groupJobEnd, sharedMemory);
+
+			scratch.depth--;
+			scratch.group.rewind(marker);
+
+			auto ctx = block->ctx;
+			if (block->remaining.fetch_sub(1) == 1)
 			{
-				args.jobIndex          = i;
-				args.groupIndex        = i - job.groupJobOffset;
-				args.isFirstJobInGroup = (i == job.groupJobOffset);
-				args.isLastJobInGroup  = (i == job.groupJobEnd - 1);
-				job.task(args);
+				const auto alignment = block->alignment;
+				block->destroy(block->object);
+				block->~JobBlock();
+				::operator delete(block, std::align_val_t(alignment));
 			}
 
-			if (job.ctx)
-				job.ctx->counter.fetch_sub(1);
+			if (ctx)
+				ctx->counter.fetch_sub(1);
 			return true;
 		}
 		return false;
 	}
 
-	auto init(uint32_t maxCores) -> void
+	auto init(uint32_t maxCores, threading::PlacementPolicy policy) -> void
 	{
 		PROFILE_FUNCTION();
-		const auto numCores = std::thread::hardware_concurrency();
-		numThreads          = std::max(1u, numCores - 1);
-		numThreads = std::min(maxCores, numThreads);
+		const auto &topology = threading::getTopology();
+		const auto  numCores = std::max<uint32_t>(1, (uint32_t) topology.logicalCores.size());
+		const auto  usable   = policy == threading::PlacementPolicy::PhysicalOnly ? topology.physicalCoreCount : numCores;
+
+		numThreads = std::max(1u, usable - 1);
+		numThreads = std::min(std::max(1u, maxCores), numThreads);
+
+		const auto placement = threading::getPlacement(numThreads, policy);
+
+		localQueues.clear();
+		for (uint32_t i = 0; i <= numThreads; ++i)
+		{
+			localQueues.emplace_back(std::make_unique<LocalQueue>());
+		}
+		threadIndex = numThreads;
 		for (uint32_t threadID = 0; threadID < numThreads; ++threadID)
 		{
 			std::thread worker([threadID] {
                             std::stringstream ss;
                             ss << "WorkerThread_" << threadID;
                             PROFILE_SETTHREADNAME(ss.str().c_str());
+                            threadIndex = threadID;
+                            threading::setHighPriority();
 
 							while(true)
                             {
@@ -120,59 +431,68 @@ namespace maple::JobSystem
                                 {
                                     // no job, put thread to sleep
                                     std::unique_lock<std::mutex> lock(wakeMutex);
-                                    wakeCondition.wait(lock);
+                                    sleepingThreads.fetch_add(1);
+                                    wakeCondition.wait(lock, [] { return pendingJobs.load() > 0; });
+                                    sleepingThreads.fetch_sub(1);
                                 }
                             } });
 
-			HANDLE handle = (HANDLE) worker.native_handle();
-
-			DWORD_PTR affinityMask   = 1ull << threadID;
-			DWORD_PTR affinityResult = SetThreadAffinityMask(handle, affinityMask);
-			MAPLE_ASSERT(affinityResult > 0, "");
-
-			BOOL priorityResult = SetThreadPriority(handle, THREAD_PRIORITY_HIGHEST);
-			MAPLE_ASSERT(priorityResult != 0, "");
-
-			std::wstringstream wss;
-			wss << "WorkerThread_" << threadID;
-			HRESULT hr = SetThreadDescription(handle, wss.str().c_str());
-
-			MAPLE_ASSERT(SUCCEEDED(hr), "");
+			if (placement[threadID] >= 0 && !threading::setAffinity(worker, placement[threadID]))
+			{
+				LOGW("JobSystem : failed to pin WorkerThread_{0} to logical core {1}", threadID, placement[threadID]);
+			}
+			threading::setName(worker, "WorkerThread_" + std::to_string(threadID));
 
 			worker.detach();
 		}
 
-		LOGI("Initialized JobSystem with [{0} cores] [{1} threads]", numCores, numThreads);
+		LOGI("Initialized JobSystem with [{0} cores] [{1} physical cores] [{2} numa nodes] [{3} threads]", numCores, topology.physicalCoreCount, topology.numaNodeCount, numThreads);
 	}
 
-	auto getThreadCount() -> uint32_t
+	auto allocateScratch(size_t size, size_t alignment, ScratchLifetime lifetime) -> void *
 	{
-		return numThreads;
-	}
+		auto &scratch = getThreadScratch();
 
-	auto executeInternal(Context *ctx, const std::function<void(JobDispatchArgs)> &task) -> void
-	{
-		if (ctx)
-			ctx->counter.fetch_add(1);
+		if (const auto frame = scratchFrame.load(); scratch.frameIndex != frame)
+		{
+			scratch.frame.rewind({0, 0, 0});
+			scratch.frameIndex = frame;
+		}
 
-		Job job;
-		job.ctx              = ctx;
-		job.task             = task;
-		job.groupID          = 0;
-		job.groupJobOffset   = 0;
-		job.groupJobEnd      = 1;
-		job.sharedMemorySize = 0;
+		const bool useFrame = lifetime == ScratchLifetime::Frame || scratch.depth == 0;
+		auto       memory   = (useFrame ? scratch.frame : scratch.group).allocate(size, alignment);
+		scratch.updateStats();
+		return memory;
+	}
 
-		while (!jobQueue.push(job))        // push fail, so consume it in context.
+	auto endFrame() -> void
+	{
+		PROFILE_FUNCTION();
+		ScratchStats stats;
 		{
-			wakeCondition.notify_all();
-			work();
+			std::lock_guard<std::mutex> locker(scratchMutex);
+			for (auto scratch : scratches)
+			{
+				stats.highWaterMark += scratch->peak.exchange(0, std::memory_order_relaxed);
+				stats.reserved += scratch->reserved.load(std::memory_order_relaxed);
+			}
+			scratchStats = stats;
 		}
+		scratchFrame.fetch_add(1);
+	}
 
-		wakeCondition.notify_one();
+	auto getScratchStats() -> ScratchStats
+	{
+		std::lock_guard<std::mutex> locker(scratchMutex);
+		return scratchStats;
+	}
+
+	auto getThreadCount() -> uint32_t
+	{
+		return numThreads;
 	}
 
-	auto dispatchInternal(Context *ctx, uint32_t jobCount, uint32_t groupSize, const std::function<void(JobDispatchArgs)> &task, size_t sharedMemorySize) -> void
+	auto internal::dispatch(Context *ctx, uint32_t jobCount, uint32_t groupSize, const Callable &callable, size_t sharedMemorySize) -> void
 	{
 		PROFILE_FUNCTION();
 		if (jobCount == 0 || groupSize == 0)
@@ -180,30 +500,48 @@ namespace maple::JobSystem
 			return;
 		}
 
-		const uint32_t groupCount = dispatchGroupCount(jobCount, groupSize);
+		const uint32_t groupCount   = dispatchGroupCount(jobCount, groupSize);
+		const size_t   alignment    = std::max(alignof(JobBlock), callable.alignment);
+		const size_t   jobsEnd      = sizeof(JobBlock) + sizeof(Job) * groupCount;
+		const size_t   objectOffset = (jobsEnd + callable.alignment - 1) / callable.alignment * callable.alignment;
+
+		auto memory = static_cast<uint8_t *>(::operator new(objectOffset + callable.size, std::align_val_t(alignment)));
+		auto block  = new (memory) JobBlock();
+
+		block->ctx              = ctx;
+		block->invoke           = callable.invoke;
+		block->destroy          = callable.destroy;
+		block->object           = memory + objectOffset;
+		block->alignment        = alignment;
+		block->sharedMemorySize = (uint32_t) sharedMemorySize;
+		block->remaining.store(groupCount);
+		callable.construct(block->object, callable.object);
 
 		if (ctx)
 			ctx->counter.fetch_add(groupCount);
 
-		Job job;
-		job.ctx              = ctx;
-		job.task             = task;
-		job.sharedMemorySize = (uint32_t) sharedMemorySize;
-
+		auto jobs = block->getJobs();
 		for (uint32_t groupID = 0; groupID < groupCount; ++groupID)
 		{
-			job.groupID        = groupID;
-			job.groupJobOffset = groupID * groupSize;
-			job.groupJobEnd    = std::min(job.groupJobOffset + groupSize, jobCount);
-
-			while (!jobQueue.push(job))
-			{
-				wakeCondition.notify_all();
-				work();
-			}
+			auto job            = new (&jobs[groupID]) Job();
+			job->block          = block;
+			job->groupID        = groupID;
+			job->groupJobOffset = groupID * groupSize;
+			job->groupJobEnd    = std::min(job->groupJobOffset + groupSize, jobCount);
+			pushJob(job);
 		}
 	}
 
+	auto executeInternal(Context *ctx, std::function<void(JobDispatchArgs)> task) -> void
+	{
+		internal::dispatch(ctx, 1, 1, internal::makeCallable(task), 0);
+	}
+
+	auto dispatchInternal(Context *ctx, uint32_t jobCount, uint32_t groupSize, std::function<void(JobDispatchArgs)> task, size_t sharedMemorySize) -> void
+	{
+		internal::dispatch(ctx, jobCount, groupSize, internal::makeCallable(task), sharedMemorySize);
+	}
+
 	auto execute(Context &ctx, const std::function<void(JobDispatchArgs)> &task) -> void
 	{
 		executeInternal(&ctx, task);
@@ -236,10 +574,146 @@ namespace maple::JobSystem
 
 	auto wait(const Context &ctx) -> void
 	{
-		wakeCondition.notify_all();
 		while (isBusy(ctx))
 		{
-			work();
+			if (!work())
+			{
+				//the remaining jobs are running on other threads.
+				std::this_thread::yield();
+			}
+		}
+	}
+
+	class TaskNode
+	{
+	  public:
+		TaskNode()
+		{
+			ctx.counter.store(1);
+		}
+
+		std::function<void()>                task;
+		std::function<void(JobDispatchArgs)> parallelTask;
+		uint32_t                             jobCount         = 0;
+		uint32_t                             groupSize        = 0;
+		size_t                               sharedMemorySize = 0;
+
+		std::atomic<uint32_t> dependencies{1};        //the extra one is released once all predecessors are linked
+		std::atomic<uint32_t> remainingGroups{0};
+		Context               ctx;                    //busy until the task and its continuations have been released
+
+		std::mutex              lock;
+		bool                    finished = false;
+		std::vector<TaskHandle> continuations;
+	};
+
+	namespace
+	{
+		auto launch(const TaskHandle &node) -> void;
+
+		auto release(const TaskHandle &node) -> void
+		{
+			if (node->dependencies.fetch_sub(1) == 1)
+				launch(node);
+		}
+
+		auto complete(const TaskHandle &node) -> void
+		{
+			std::vector<TaskHandle> continuations;
+			{
+				std::lock_guard<std::mutex> locker(node->lock);
+				node->finished = true;
+				continuations.swap(node->continuations);
+			}
+
+			for (auto &next : continuations)
+			{
+				release(next);
+			}
+			node->ctx.counter.fetch_sub(1);
+		}
+
+		auto launch(const TaskHandle &node) -> void
+		{
+			if (node->parallelTask && node->jobCount > 0 && node->groupSize > 0)
+			{
+				node->remainingGroups.store(dispatchGroupCount(node->jobCount, node->groupSize));
+				auto task = [node](JobDispatchArgs args) {
+					node->parallelTask(args);
+					if (args.isLastJobInGroup && node->remainingGroups.fetch_sub(1) == 1)
+						complete(node);
+				};
+				internal::dispatch(nullptr, node->jobCount, node->groupSize, internal::makeCallable(task), node->sharedMemorySize);
+			}
+			else if (node->task)
+			{
+				auto task = [node](JobDispatchArgs) {
+					node->task();
+					complete(node);
+				};
+				internal::dispatch(nullptr, 1, 1, internal::makeCallable(task), 0);
+			}
+			else
+			{
+				//pure join node, nothing to run.
+				complete(node);
+			}
+		}
+
+		auto link(const TaskHandle &node, const std::vector<TaskHandle> &dependencies) -> TaskHandle
+		{
+			for (auto &dependency : dependencies)
+			{
+				if (dependency == nullptr)
+					continue;
+
+				std::lock_guard<std::mutex> locker(dependency->lock);
+				if (!dependency->finished)
+				{
+					node->dependencies.fetch_add(1);
+					dependency->continuations.emplace_back(node);
+				}
+			}
+			release(node);
+			return node;
 		}
+	}        // namespace
+
+	auto schedule(const std::function<void()> &task, const std::vector<TaskHandle> &dependencies) -> TaskHandle
+	{
+		auto node  = std::make_shared<TaskNode>();
+		node->task = task;
+		return link(node, dependencies);
+	}
+
+	auto schedule(uint32_t jobCount, uint32_t groupSize, const std::function<void(JobDispatchArgs)> &task, const std::vector<TaskHandle> &dependencies, size_t sharedMemorySize) -> TaskHandle
+	{
+		auto node              = std::make_shared<TaskNode>();
+		node->parallelTask     = task;
+		node->jobCount         = jobCount;
+		node->groupSize        = groupSize;
+		node->sharedMemorySize = sharedMemorySize;
+		return link(node, dependencies);
+	}
+
+	auto then(const TaskHandle &task, const std::function<void()> &continuation) -> TaskHandle
+	{
+		return schedule(continuation, {task});
+	}
+
+	auto whenAll(const std::vector<TaskHandle> &tasks) -> TaskHandle
+	{
+		return link(std::make_shared<TaskNode>(), tasks);
+	}
+
+	auto isDone(const TaskHandle &task) -> bool
+	{
+		return task == nullptr || !isBusy(task->ctx);
+	}
+
+	auto wait(const TaskHandle &task) -> void
+	{
+		if (task != nullptr)
+			wait(task->ctx);
 	}
-}        // namespace maple::JobSystem
\ No newline at end of file
+}        // namespace maple::JobSystem
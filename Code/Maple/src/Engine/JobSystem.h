@@ -4,11 +4,17 @@
 
 #pragma once
 
+#include <atomic>
 #include <condition_variable>
+#include <cstddef>
 #include <functional>
 #include <memory>
 #include <mutex>
+#include <new>
+#include <type_traits>
+#include <vector>
 #include "Engine/Core.h"
+#include "Engine/Threading.h"
 
 namespace maple::JobSystem
 {
@@ -22,12 +28,32 @@ namespace maple::JobSystem
 		void *   sharedMemory;
 	};
 
+	enum class ScratchLifetime : uint8_t
+	{
+		Group,        //released when the current job group finishes. outside a job it behaves as Frame.
+		Frame         //released by the first allocation of the calling thread after JobSystem::endFrame.
+	};
+
+	struct ScratchStats
+	{
+		size_t highWaterMark = 0;        //peak scratch bytes in use during the last frame, summed over threads
+		size_t reserved      = 0;        //bytes currently owned by all scratch arenas
+	};
+
 	struct Context
 	{
 		std::atomic<uint32_t> counter{0};
 	};
 
-	auto init(uint32_t maxCores) -> void;
+	class TaskNode;
+
+	using TaskHandle = std::shared_ptr<TaskNode>;
+
+	/**
+	 * workers are pinned according to the cpu topology, PhysicalOnly keeps them off smt siblings
+	 * and caps the worker count to the physical cores.
+	 */
+	auto MAPLE_EXPORT init(uint32_t maxCores, threading::PlacementPolicy policy = threading::PlacementPolicy::PhysicalFirst) -> void;
 
 	auto MAPLE_EXPORT getThreadCount() -> uint32_t;
 	auto MAPLE_EXPORT execute(const std::function<void(JobDispatchArgs)> &task) -> void;
@@ -37,4 +63,92 @@ namespace maple::JobSystem
 	auto MAPLE_EXPORT dispatchGroupCount(uint32_t jobCount, uint32_t groupSize) -> uint32_t;
 	auto MAPLE_EXPORT isBusy(const Context &ctx) -> bool;
 	auto MAPLE_EXPORT wait(const Context &ctx) -> void;
+
+	/**
+	 * Per-thread linear scratch memory. JobDispatchArgs::sharedMemory is carved from the same arena with Group lifetime.
+	 */
+	auto MAPLE_EXPORT allocateScratch(size_t size, size_t alignment = alignof(std::max_align_t), ScratchLifetime lifetime = ScratchLifetime::Group) -> void *;
+	auto MAPLE_EXPORT endFrame() -> void;
+	auto MAPLE_EXPORT getScratchStats() -> ScratchStats;
+
+	namespace internal
+	{
+		/**
+		 * Type-erased view of a dispatch callable. The job system moves the callable once into the
+		 * per-dispatch control block and every group invokes it through a single indirect call.
+		 */
+		struct Callable
+		{
+			using Invoke    = void (*)(void *object, uint32_t groupID, uint32_t groupJobOffset, uint32_t groupJobEnd, void *sharedMemory);
+			using Construct = void (*)(void *dst, void *src);
+			using Destroy   = void (*)(void *object);
+
+			void *    object;
+			size_t    size;
+			size_t    alignment;
+			Invoke    invoke;
+			Construct construct;
+			Destroy   destroy;
+		};
+
+		template <typename T>
+		inline auto makeCallable(T &task) -> Callable
+		{
+			Callable callable;
+			callable.object    = &task;
+			callable.size      = sizeof(T);
+			callable.alignment = alignof(T);
+			callable.invoke    = [](void *object, uint32_t groupID, uint32_t groupJobOffset, uint32_t groupJobEnd, void *sharedMemory) {
+				auto &          task = *static_cast<T *>(object);
+				JobDispatchArgs args;
+				args.groupID      = groupID;
+				args.sharedMemory = sharedMemory;
+				for (uint32_t i = groupJobOffset; i < groupJobEnd; ++i)
+				{
+					args.jobIndex          = i;
+					args.groupIndex        = i - groupJobOffset;
+					args.isFirstJobInGroup = (i == groupJobOffset);
+					args.isLastJobInGroup  = (i == groupJobEnd - 1);
+					task(args);
+				}
+			};
+			callable.construct = [](void *dst, void *src) {
+				new (dst) T(std::move(*static_cast<T *>(src)));
+			};
+			callable.destroy = [](void *object) {
+				static_cast<T *>(object)->~T();
+			};
+			return callable;
+		}
+
+		auto MAPLE_EXPORT dispatch(Context *ctx, uint32_t jobCount, uint32_t groupSize, const Callable &callable, size_t sharedMemorySize) -> void;
+	}        // namespace internal
+
+	/**
+	 * Allocation-free dispatch : the callable is stored once per dispatch instead of being copied into every group.
+	 */
+	template <typename Task, typename = std::enable_if_t<std::is_invocable_v<std::decay_t<Task> &, JobDispatchArgs>>>
+	inline auto dispatch(uint32_t jobCount, uint32_t groupSize, Task &&task, size_t sharedMemorySize = 0) -> void
+	{
+		std::decay_t<Task> object(std::forward<Task>(task));
+		internal::dispatch(nullptr, jobCount, groupSize, internal::makeCallable(object), sharedMemorySize);
+	}
+
+	template <typename Task, typename = std::enable_if_t<std::is_invocable_v<std::decay_t<Task> &, JobDispatchArgs>>>
+	inline auto dispatch(Context &ctx, uint32_t jobCount, uint32_t groupSize, Task &&task, size_t sharedMemorySize = 0) -> void
+	{
+		std::decay_t<Task> object(std::forward<Task>(task));
+		internal::dispatch(&ctx, jobCount, groupSize, internal::makeCallable(object), sharedMemorySize);
+	}
+
+	/**
+	 * Task graph. A task is pushed to the workers once all of its dependencies have finished,
+	 * so chaining work never blocks a thread. Null handles in the dependency list are ignored.
+	 */
+	auto MAPLE_EXPORT schedule(const std::function<void()> &task, const std::vector<TaskHandle> &dependencies = {}) -> TaskHandle;
+	auto MAPLE_EXPORT schedule(uint32_t jobCount, uint32_t groupSize, const std::function<void(JobDispatchArgs)> &task, const std::vector<TaskHandle> &dependencies = {}, size_t sharedMemorySize = 0) -> TaskHandle;
+	auto MAPLE_EXPORT then(const TaskHandle &task, const std::function<void()> &continuation) -> TaskHandle;
+	auto MAPLE_EXPORT whenAll(const std::vector<TaskHandle> &tasks) -> TaskHandle;
+	auto MAPLE_EXPORT isDone(const TaskHandle &task) -> bool;
+	auto MAPLE_EXPORT wait(const TaskHandle &task) -> void;
 }// namespace maple::job_system
\ No newline at end of file
@@ -9,6 +9,7 @@
 
 
 #include "Application.h"
+#include "IO/Loader.h"
 #include "Mesh.h"
 #include "RHI/StorageBuffer.h"
 #include "Vertex.h"
@@ -38,10 +39,13 @@ namespace maple
 		{
 			boundingBox->merge(vertex.pos);
 		}
-		vertexBuffer = VertexBuffer::create(vertices.data(), sizeof(Vertex) * vertices.size());
-		indexBuffer  = IndexBuffer::create(indices.data(), indices.size());
-		meshId       = idGenerator++;
-		subMeshIndex.emplace_back(indexBuffer->getCount());
+		if (!io::isHeadless())
+		{
+			vertexBuffer = VertexBuffer::create(vertices.data(), sizeof(Vertex) * vertices.size());
+			indexBuffer  = IndexBuffer::create(indices.data(), indices.size());
+		}
+		meshId = idGenerator++;
+		subMeshIndex.emplace_back(static_cast<uint32_t>(indices.size()));
 	}
 
 	auto Mesh::setIndicies(uint32_t range) -> void
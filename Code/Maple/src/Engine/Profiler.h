@@ -31,5 +31,6 @@ namespace maple::global::component
 		uint32_t frameCount;
 		uint32_t drawCall;
 		float fps;
+		size_t scratchHighWaterMark;
 	};
 }
\ No newline at end of file
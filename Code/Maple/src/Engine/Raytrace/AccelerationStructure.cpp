@@ -4,6 +4,7 @@
 #include "AccelerationStructure.h"
 #include "Engine/Mesh.h"
 #include "Engine/Raytrace/RaytraceConfig.h"
+#include "Engine/Renderer/RenderSnapshot.h"
 #include "Engine/Renderer/RendererData.h"
 #include "RHI/AccelerationStructure.h"
 #include "RHI/GraphicsContext.h"
@@ -25,30 +26,29 @@ namespace maple
 		{
 			inline auto system(global::component::TopLevelAs& topLevel,
 				const maple::component::RendererData& renderData,
-				maple::global::component::SceneTransformChanged* sceneChanged,
+				const maple::component::RenderSnapshot& snapshot,
 				maple::global::component::Bindless& bindless,
 				const maple::global::component::GraphicsContext& context,
-				const trace::global::component::RaytraceConfig& config,
-				ioc::Registry registry)
+				const trace::global::component::RaytraceConfig& config)
 			{
 				if (!context.context->isRaytracingSupported() || trace::isSoftTrace(config))
 					return;
 
-				auto meshGroup = registry.getRegistry().view<component::MeshRenderer, component::Transform>();
+				const auto& frame = snapshot.front();
 
 				if (topLevel.topLevelAs == nullptr)
 				{
-					if (meshGroup.begin() != meshGroup.end())
+					if (!frame.meshes.empty())
 					{
 						topLevel.topLevelAs = AccelerationStructure::createTopLevel(MAX_SCENE_MESH_INSTANCE_COUNT);
 						auto     tasks = BatchTask::create();
 						uint32_t meshCount = 0;
 
-						for (auto [meshEntity , mesh, transform]: meshGroup.each())
+						for (auto& instance : frame.meshes)
 						{
-							auto blas = mesh.mesh->getAccelerationStructure(tasks);
-							bindless.meshIndices[(uint32_t)meshEntity] = meshCount;
-							topLevel.topLevelAs->updateTLAS(transform.getWorldMatrix(), meshCount++, blas->getDeviceAddress());
+							auto blas = instance.mesh->getAccelerationStructure(tasks);
+							bindless.meshIndices[(uint32_t)instance.entity] = meshCount;
+							topLevel.topLevelAs->updateTLAS(instance.worldMatrix, meshCount++, blas->getDeviceAddress());
 						}
 						if (meshCount > 0)
 						{
@@ -58,15 +58,15 @@ namespace maple
 						}
 					}
 				}
-				else if (sceneChanged && sceneChanged->dirty)
+				else if (frame.transformChanged)
 				{
 					auto     tasks = BatchTask::create();
 					uint32_t meshCount = 0;
-					for (auto [meshEntity, mesh, transform] : meshGroup.each())
+					for (auto& instance : frame.meshes)
 					{
-						auto blas = mesh.mesh->getAccelerationStructure(tasks);
-						bindless.meshIndices[(uint32_t)meshEntity] = meshCount;
-						topLevel.topLevelAs->updateTLAS(transform.getWorldMatrix(), meshCount++, blas->getDeviceAddress());
+						auto blas = instance.mesh->getAccelerationStructure(tasks);
+						bindless.meshIndices[(uint32_t)instance.entity] = meshCount;
+						topLevel.topLevelAs->updateTLAS(instance.worldMatrix, meshCount++, blas->getDeviceAddress());
 					}
 					if (meshCount > 0)
 					{
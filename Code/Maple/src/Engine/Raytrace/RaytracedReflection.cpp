@@ -171,7 +171,7 @@ namespace maple
 					pipeline.pushConsts.numLights = descriptor.numLights;
 					pipeline.pushConsts.approximateWithDDGI = reflection.approximateWithDDGI ? 1 : 0;
 
-					pipeline.pushConsts.cameraPosition = { cameraView.cameraTransform->getWorldPosition(), 1.f };
+					pipeline.pushConsts.cameraPosition = { cameraView.position, 1.f };
 					pipeline.pushConsts.viewProjInv = glm::inverse(cameraView.projView);
 					pipeline.pushConsts.viewProj = cameraView.projView;
 					pipeline.pushConsts.view = cameraView.view;
@@ -374,7 +374,7 @@ namespace maple
 				accumulator.descriptorSets[0]->setTexture("uInput", pipeline.outColor);        //noised reflection
 				accumulator.descriptorSets[0]->setUniform("UniformBufferObject", "viewProjInv", glm::value_ptr(glm::inverse(cameraView.projView)));
 				accumulator.descriptorSets[0]->setUniform("UniformBufferObject", "prevViewProj", glm::value_ptr(cameraView.projViewOld));
-				accumulator.descriptorSets[0]->setUniform("UniformBufferObject", "cameraPos", glm::value_ptr(cameraView.cameraTransform->getWorldPosition()));
+				accumulator.descriptorSets[0]->setUniform("UniformBufferObject", "cameraPos", glm::value_ptr(cameraView.position));
 
 				accumulator.descriptorSets[1]->setTexture("uColorSampler", renderData.gbuffer->getBuffer(GBufferTextures::COLOR));
 				accumulator.descriptorSets[1]->setTexture("uNormalSampler", renderData.gbuffer->getBuffer(GBufferTextures::NORMALS));
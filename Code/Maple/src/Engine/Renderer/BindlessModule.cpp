@@ -6,6 +6,7 @@
 
 #include "Engine/Mesh.h"
 #include "Engine/Raytrace/AccelerationStructure.h"
+#include "Engine/Renderer/RenderSnapshot.h"
 #include "Engine/Renderer/RendererData.h"
 #include "Engine/Renderer/SkyboxRenderer.h"
 #include "Engine/Raytrace/RaytraceConfig.h"
@@ -160,16 +161,15 @@ namespace maple
 				}
 			}
 
-			inline auto system(ioc::Registry registry,
+			inline auto system(const maple::component::RenderSnapshot& snapshot,
 				const skybox_renderer::global::component::SkyboxData* skybox,
 				const maple::component::RendererData& rendererData,
 				const maple::raytracing::global::component::TopLevelAs& topLevels,
 				global::component::Bindless& bindless,
-				global::component::GraphicsContext& context,
+				const global::component::GraphicsContext& context,
 				global::component::RaytracingDescriptor& descriptor,
-				global::component::SceneTransformChanged* sceneChanged,
 				const trace::global::component::RaytraceConfig& config,
-				global::component::MaterialChanged* materialChanged)
+				const global::component::MaterialChanged* materialChanged)
 			{
 				if (!context.context->isRaytracingSupported() || trace::isSoftTrace(config))
 					return;
@@ -177,10 +177,8 @@ namespace maple
 				if (bindless.meshIndices.empty())
 					return;
 
-				auto lightGroup = registry.getRegistry().view<component::Light, component::Transform>();
-				auto meshGroup = registry.getRegistry().view<component::MeshRenderer, component::Transform>();
-
-				if (sceneChanged && sceneChanged->dirty && topLevels.topLevelAs)
+				const auto& frame = snapshot.front();
+				if (frame.transformChanged && topLevels.topLevelAs)
 				{
 					descriptor.updated = true;
 					std::unordered_set<uint32_t>           processedMeshes;
@@ -192,7 +190,7 @@ namespace maple
 					std::vector<VertexBuffer::Ptr> vbos;
 					std::vector<IndexBuffer::Ptr>  ibos;
 					std::vector<StorageBuffer::Ptr> materialIndices;
-					materialIndices.resize(std::distance(meshGroup.begin(), meshGroup.end()));
+					materialIndices.resize(frame.meshes.size());
 
 					context.context->waitIdle();
 
@@ -203,7 +201,7 @@ namespace maple
 					auto tasks = BatchTask::create();
 					std::unordered_map<uint32_t, uint32_t> vertexMapping;
 
-					for (auto [entity, mesh, transform] : meshGroup.each())
+					for (auto& mesh : frame.meshes)
 					{
 						if (processedMeshes.count(mesh.mesh->getId()) == 0)
 						{
@@ -253,22 +251,20 @@ namespace maple
 
 						auto blas = mesh.mesh->getAccelerationStructure(tasks);
 
-						auto instanceId = bindless.meshIndices[(uint32_t)entity];
+						auto instanceId = bindless.meshIndices[(uint32_t)mesh.entity];
 						materialIndices[instanceId] = buffer;
 						//vertex buffer Id;
 						transformBuffer[instanceId].meshIndex = vertexMapping[mesh.mesh->getId()];
-						transformBuffer[instanceId].model = transform.getWorldMatrix();
-						transformBuffer[instanceId].normalMatrix = glm::transpose(glm::inverse(glm::mat3(transform.getWorldMatrix())));
+						transformBuffer[instanceId].model = mesh.worldMatrix;
+						transformBuffer[instanceId].normalMatrix = glm::transpose(glm::inverse(glm::mat3(mesh.worldMatrix)));
 						buffer->unmap();
 					}
 
 					uint32_t lightIndicator = 0;
 
-					for (auto [lightEntity, light, transform] : lightGroup.each())
+					for (auto& light : frame.lights)
 					{
-						light.lightData.position = { transform.getWorldPosition(), 1.f };
-						light.lightData.direction = { glm::normalize(transform.getWorldOrientation() * maple::FORWARD), light.lightData.direction.w };
-						lightBuffer[lightIndicator++] = light.lightData;
+						lightBuffer[lightIndicator++] = light.light.lightData;
 					}
 
 					descriptor.sceneDescriptor->setTexture("uSkybox", rendererData.unitCube);
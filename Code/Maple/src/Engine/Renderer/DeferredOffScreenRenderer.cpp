@@ -35,6 +35,7 @@
 #include "Application.h"
 #include "ImGui/ImGuiHelpers.h"
 #include "Others/Randomizer.h"
+#include "RenderSnapshot.h"
 #include "RendererData.h"
 #include "IoC/Registry.h"
 #include <glm/gtc/type_ptr.hpp>
@@ -92,20 +93,17 @@ namespace maple
 			const component::CameraView& cameraView,
 			const component::RendererData& renderData,
 			const skybox_renderer::global::component::SkyboxData* skyboxData,
-			ioc::Registry registry
+			const component::RenderSnapshot& snapshot
 			)
 		{
-			auto lightQuery = registry.getRegistry().view<component::Light, component::Transform>();
-			auto env = registry.getRegistry().view<component::Environment>();
-			auto ddgiGroup = registry.getRegistry().view<ddgi::component::IrradianceVolume>();
-			auto meshQuery = registry.getRegistry().view<component::MeshRenderer, component::Transform>();
-
 			data.commandQueue.clear();
 			auto descriptorSet = data.descriptorColorSet[0];
 
-			if (cameraView.cameraTransform == nullptr)
+			if (!cameraView.valid)
 				return;
 
+			const auto& frame = snapshot.front();
+
 			data.descriptorColorSet[0]->setUniform("UniformBufferObject", "projView", &cameraView.projView);
 			data.descriptorColorSet[0]->setUniform("UniformBufferObject", "view", &cameraView.view);
 			data.descriptorColorSet[0]->setUniform("UniformBufferObject", "projViewOld", &cameraView.projViewOld);
@@ -114,35 +112,24 @@ namespace maple
 			data.descriptorColorSet[2]->setUniform("UBO", "nearPlane", &cameraView.nearPlane);
 			data.descriptorColorSet[2]->setUniform("UBO", "farPlane", &cameraView.farPlane);
 
-			data.defaultMaterial->bind(renderData.commandBuffer);
-
-			component::Light* directionaLight = nullptr;
+			const component::Light* directionaLight = nullptr;
 
 			component::LightData lights[32] = {};
 			uint32_t             numLights = 0;
 
 			{
 				PROFILE_SCOPE("Get Light");
-				for (auto [entity, light, transform] : lightQuery.each())
+				for (auto& instance : frame.lights)
 				{
-					light.lightData.position = { transform.getWorldPosition(), 1.f };
-					light.lightData.direction = { glm::normalize(transform.getWorldOrientation() * maple::FORWARD), light.lightData.direction.w };
-
-					if (static_cast<component::LightType>(light.lightData.type) == component::LightType::DirectionalLight)
-						directionaLight = &light;
+					if (static_cast<component::LightType>(instance.light.lightData.type) == component::LightType::DirectionalLight)
+						directionaLight = &instance.light;
 
-					lights[numLights] = light.lightData;
+					lights[numLights] = instance.light.lightData;
 					numLights++;
 				}
 			}
 
-			int32_t ddgiEanble = 0;
-
-			if (!ddgiGroup.empty())
-			{
-				auto [entity, ddgi] = *ddgiGroup.each().begin();
-				ddgiEanble = ddgi.enable ? 1 : 0;
-			}
+			int32_t ddgiEanble = frame.ddgiEnable ? 1 : 0;
 
 			int32_t vxgiEnable = 0;
 			int32_t lpvEnable = 0;
@@ -155,7 +142,7 @@ namespace maple
 			const auto       numShadows = shadowData.shadowMapNum;
 			//auto cubeMapMipLevels = envData->environmentMap ? envData->environmentMap->getMipMapLevels() - 1 : 0;
 			int32_t renderMode = data.deferredOut;
-			auto    cameraPos = glm::vec4{ cameraView.cameraTransform->getWorldPosition(), 1.f };
+			auto    cameraPos = glm::vec4{ cameraView.position, 1.f };
 
 			data.descriptorLightSet[0]->setUniform("UniformBufferLight", "lights", lights, sizeof(component::LightData) * numLights, false);
 			data.descriptorLightSet[0]->setUniform("UniformBufferLight", "shadowTransform", shadowTransforms);
@@ -189,9 +176,9 @@ namespace maple
 			data.descriptorLightSet[0]->setTexture("uPreintegratedFG", data.preintegratedFG);
 			data.descriptorLightSet[0]->setTexture("uShadowMap", shadowData.shadowTexture);
 
-			if (!env.empty())
+			if (frame.hasEnvironment)
 			{
-				auto [entity, evnData] = *env.each().begin();
+				auto& evnData = frame.environment;
 				data.descriptorLightSet[0]->setTexture("uPrefilterMap", evnData.prefilteredEnvironment == nullptr ? renderData.unitCube : evnData.prefilteredEnvironment);
 				data.descriptorLightSet[0]->setTexture("uIrradianceSH", evnData.irradianceSH == nullptr ? renderData.unitTexture : evnData.irradianceSH);
 				enableIBL = evnData.envLighting;
@@ -244,7 +231,6 @@ namespace maple
 						cmd.mesh = mesh.get();
 						cmd.transform = worldTransform;
 						cmd.material = mesh->getSubMeshIndex().size() > mesh->getMaterial().size() ? data.defaultMaterial.get() : mesh->getMaterial()[i].get();
-						cmd.material->bind(renderData.commandBuffer);
 						cmd.start = start;
 						cmd.count = mesh->getSubMeshIndex()[i] - start;
 
@@ -262,11 +248,9 @@ namespace maple
 				}
 			};
 
-			for (auto [entityHandle, mesh, trans] : meshQuery.each())
+			for (auto& mesh : frame.meshes)
 			{
-				const auto& worldTransform = trans.getWorldMatrix();
-
-				auto hasSDF = registry.getRegistry().any_of<sdf::component::MeshDistanceField>(entityHandle);
+				const auto& worldTransform = mesh.worldMatrix;
 
 				forEachMesh(
 					worldTransform,
@@ -276,8 +260,10 @@ namespace maple
 			}
 		}
 
-		inline auto onRender(deferred::global::component::DeferredData& data,const component::RendererData& renderData,ioc::Registry registry) -> void
+		inline auto onRender(deferred::global::component::DeferredData& data,const component::RendererData& renderData) -> void
 		{
+			//materials are bound here rather than while culling, the begin queue runs on the job system.
+			data.defaultMaterial->bind(renderData.commandBuffer);
 			data.descriptorColorSet[0]->update(renderData.commandBuffer);
 			data.descriptorColorSet[2]->update(renderData.commandBuffer);
 
@@ -303,6 +289,7 @@ namespace maple
 					descriptors = data.descriptorColorSet;
 				}
 
+				command.material->bind(renderData.commandBuffer);
 				auto materialDescriptor = command.material->getDescriptorSet(pipeline->getShader()->getName());
 				bool bindDescriptor = false;
 				if (materialDescriptor != lastDescriptor)
@@ -25,8 +25,7 @@ namespace maple
 {
 	namespace final_screen_pass
 	{
-		inline auto system(ioc::Registry  registry,
-		                   const component::FinalPass &           finalData,
+		inline auto system(const component::FinalPass &           finalData,
 		                   capture_graph::component::RenderGraph &graph,
 		                   const component::RendererData &        renderData)
 		{
@@ -26,11 +26,14 @@
 #include "RHI/Pipeline.h"
 #include "RHI/VertexBuffer.h"
 
+#include "Scene/Component/Environment.h"
 #include "Scene/Component/Light.h"
 #include "Scene/Component/MeshRenderer.h"
+#include "Scene/Component/Transform.h"
 #include "Scene/Component/VolumetricCloud.h"
 #include "Scene/Scene.h"
 #include "Engine/Renderer/BindlessModule.h"
+#include "Engine/Renderer/RenderSnapshot.h"
 
 #include "Math/BoundingBox.h"
 #include "Math/MathUtils.h"
@@ -88,12 +91,14 @@ namespace maple
 		winSize.width = width;
 		builder->getGlobalComponent<capture_graph::component::RenderGraph>();
 		builder->getGlobalComponent<component::CameraView>();
+		builder->getGlobalComponent<component::RenderSnapshot>();
 		builder->getGlobalComponent<component::FinalPass>();
 
 		static SystemQueue beginQ("BegineScene");
 		static SystemQueue renderQ("OnRender");
 
-		builder->registerQueue(beginQ);
+		//culling and upload preparation only share read access, the begin queue runs them concurrently.
+		builder->registerQueue(beginQ, true);
 		builder->registerQueue(renderQ);
 		builder->registerWithinQueue<on_begin_renderer::system>(renderQ);
 
@@ -114,11 +119,97 @@ namespace maple
 		final_screen_pass::registerFinalPass(renderQ, builder);
 	}
 
+	auto RenderGraph::extract(Scene* scene) -> void
+	{
+		PROFILE_FUNCTION();
+		auto  builder  = Application::getBuilder();
+		auto& registry = builder->getRegistry();
+		auto& snapshot = builder->getGlobalComponent<component::RenderSnapshot>();
+		auto& previous = snapshot.front();
+		auto& frame    = snapshot.back();
+
+		//extracted again without being published (minimized), the changes of the skipped frame are kept.
+		const bool pending = frame.frame > previous.frame;
+		frame.frame        = previous.frame + 1;
+		frame.camera       = previous.camera;
+
+		auto camera        = scene->getCamera();
+		frame.camera.valid = camera.first != nullptr && camera.second != nullptr;
+		if (frame.camera.valid)
+		{
+			auto& cameraView        = frame.camera;
+			cameraView.proj         = camera.first->getProjectionMatrix();
+			cameraView.view         = camera.second->getWorldMatrixInverse();
+			cameraView.projViewOld  = previous.camera.projView;
+			cameraView.projView     = cameraView.proj * cameraView.view;
+			cameraView.nearPlane    = camera.first->getNear();
+			cameraView.farPlane     = camera.first->getFar();
+			cameraView.frustum      = camera.first->getFrustum(cameraView.view);
+			cameraView.fov          = camera.first->getFov();
+			cameraView.aspect       = camera.first->getAspectRatio();
+			cameraView.position     = camera.second->getWorldPosition();
+			cameraView.prevPosition = previous.camera.position;
+			cameraView.cameraDelta  = cameraView.position - cameraView.prevPosition;
+		}
+
+		frame.meshes.clear();
+		for (auto [entity, mesh, transform] : registry.view<component::MeshRenderer, component::Transform>().each())
+		{
+			frame.meshes.push_back({entity, mesh.mesh, transform.getWorldMatrix(), mesh.castShadow, mesh.active});
+		}
+
+		frame.lights.clear();
+		for (auto [entity, light] : registry.view<component::Light>().each())
+		{
+			if (auto transform = registry.try_get<component::Transform>(entity))
+			{
+				light.lightData.position  = {transform->getWorldPosition(), 1.f};
+				light.lightData.direction = {glm::normalize(transform->getWorldOrientation() * maple::FORWARD), light.lightData.direction.w};
+			}
+			frame.lights.push_back({entity, light});
+		}
+
+		auto environments    = registry.view<component::Environment>();
+		frame.hasEnvironment = !environments.empty();
+		if (frame.hasEnvironment)
+		{
+			auto& environment                         = environments.get<component::Environment>(*environments.begin());
+			frame.environment.prefilteredEnvironment = environment.prefilteredEnvironment;
+			frame.environment.irradianceSH           = environment.irradianceSH;
+			frame.environment.envLighting            = environment.envLighting;
+		}
+		else
+		{
+			frame.environment = {};
+		}
+
+		auto volumes     = registry.view<ddgi::component::IrradianceVolume>();
+		frame.ddgiEnable = !volumes.empty() && volumes.get<ddgi::component::IrradianceVolume>(*volumes.begin()).enable;
+
+		//the snapshot takes the changes over, the hierarchy collects the next ones from here.
+		auto& changed          = builder->getGlobalComponent<global::component::SceneTransformChanged>();
+		frame.transformChanged = changed.dirty || (pending && frame.transformChanged);
+		if (!pending)
+			frame.changedEntities.clear();
+		frame.changedEntities.insert(frame.changedEntities.end(), changed.entities.begin(), changed.entities.end());
+		changed.dirty = false;
+		changed.entities.clear();
+		for (auto [entity, transform] : registry.view<component::Transform>().each())
+		{
+			transform.setHasUpdated(false);
+		}
+	}
+
 	auto RenderGraph::beginScene(Scene* scene) -> void
 	{
 		PROFILE_FUNCTION();
+		auto  builder  = Application::getBuilder();
+		auto& snapshot = builder->getGlobalComponent<component::RenderSnapshot>();
+		snapshot.publish();
+		//render systems read the camera as CameraView, it only changes here between two recorded frames.
+		builder->getGlobalComponent<component::CameraView>() = snapshot.front().camera;
 
-		auto& renderData = Application::getBuilder()->getGlobalComponent<component::RendererData>();
+		auto& renderData = builder->getGlobalComponent<component::RendererData>();
 		renderData.commandBuffer = Application::getGraphicsContext()->getSwapChain()->getCurrentCommandBuffer();
 
 		for (auto& task : tasks)
@@ -126,25 +217,6 @@ namespace maple
 			task(renderData.commandBuffer);
 		}
 		tasks.clear();
-
-		auto camera = scene->getCamera();
-		if (camera.first == nullptr || camera.second == nullptr)
-		{
-			return;
-		}
-
-		auto& cameraView = Application::getBuilder()->getGlobalComponent<component::CameraView>();
-		cameraView.proj = camera.first->getProjectionMatrix();
-		cameraView.view = camera.second->getWorldMatrixInverse();
-		cameraView.projView = cameraView.proj * cameraView.view;
-		cameraView.nearPlane = camera.first->getNear();
-		cameraView.farPlane = camera.first->getFar();
-		cameraView.frustum = camera.first->getFrustum(cameraView.view);
-		cameraView.cameraTransform = camera.second;
-		cameraView.fov = camera.first->getFov();
-		cameraView.aspect = camera.first->getAspectRatio();
-		cameraView.cameraDelta = camera.second->getWorldPosition() - cameraView.prevPosition;
-		cameraView.prevPosition = camera.second->getWorldPosition();
 	}
 
 	auto RenderGraph::onUpdate(const Timestep& step, Scene* scene) -> void
@@ -181,7 +253,5 @@ namespace maple
 	auto RenderGraph::pingPong() -> void
 	{
 		gBuffer->pingPong();
-		auto& cameraView = Application::getBuilder()->getGlobalComponent<component::CameraView>();
-		cameraView.projViewOld = cameraView.projView;
 	}
 };        // namespace maple
@@ -30,6 +30,9 @@ namespace maple
 		~RenderGraph() = default;
 		auto init(uint32_t width, uint32_t height) -> void;
 		auto onResize(uint32_t width, uint32_t height) -> void;
+		//main thread, after the update : copies what the next frame renders into the back of the RenderSnapshot.
+		auto extract(Scene *scene) -> void;
+		//publishes the extracted frame and prepares the command buffer, the render side must be idle.
 		auto beginScene(Scene *scene) -> void;
 
 		auto onUpdate(const Timestep &timeStep, Scene *scene) -> void;
@@ -0,0 +1,88 @@
+//////////////////////////////////////////////////////////////////////////////
+// This file is part of the Maple Engine                              		//
+//////////////////////////////////////////////////////////////////////////////
+#pragma once
+#include "RendererData.h"
+#include "Scene/Component/Light.h"
+
+#include <array>
+#include <entt.hpp>
+#include <memory>
+#include <vector>
+
+namespace maple
+{
+	class Mesh;
+	class TextureCube;
+	class Texture2D;
+
+	namespace component
+	{
+		/**
+		 * what the render side needs from the simulation for one frame, copied on the main thread after the update.
+		 * recording only reads this, so the next update can run while the frame is recorded.
+		 */
+		struct RenderFrame
+		{
+			struct MeshInstance
+			{
+				entt::entity          entity;
+				std::shared_ptr<Mesh> mesh;
+				glm::mat4             worldMatrix;
+				bool                  castShadow;
+				bool                  active;
+			};
+
+			struct LightInstance
+			{
+				entt::entity entity;
+				Light        light;        //position and direction are in world space
+			};
+
+			struct EnvironmentInstance
+			{
+				std::shared_ptr<TextureCube> prefilteredEnvironment;
+				std::shared_ptr<Texture2D>   irradianceSH;
+				bool                         envLighting = false;
+			};
+
+			uint64_t                   frame = 0;
+			CameraView                 camera;
+			std::vector<MeshInstance>  meshes;
+			std::vector<LightInstance> lights;
+
+			bool                hasEnvironment = false;
+			EnvironmentInstance environment;
+			bool                ddgiEnable = false;
+
+			//transforms which changed since the previous snapshot
+			bool                      transformChanged = false;
+			std::vector<entt::entity> changedEntities;
+		};
+
+		/**
+		 * back() is filled by the main thread while the render side still reads front(),
+		 * publish() swaps them once the previous frame is recorded.
+		 */
+		struct RenderSnapshot
+		{
+			std::array<RenderFrame, 2> frames;
+			uint32_t                   readIndex = 0;
+
+			inline auto &front() const
+			{
+				return frames[readIndex];
+			}
+
+			inline auto &back()
+			{
+				return frames[readIndex ^ 1];
+			}
+
+			inline auto publish()
+			{
+				readIndex ^= 1;
+			}
+		};
+	}        // namespace component
+}        // namespace maple
@@ -29,9 +29,10 @@ namespace maple
 			float                 fov;
 			float                 aspect;
 			Frustum               frustum;
-			component::Transform *cameraTransform;
+			glm::vec3             position{};
 			glm::vec3             prevPosition{};
 			glm::vec3             cameraDelta{};
+			bool                  valid = false;        //the scene has a camera
 		};
 
 		struct EnvironmentData
@@ -19,6 +19,7 @@
 #include "Engine/Material.h"
 #include "Engine/Mesh.h"
 #include "Engine/Profiler.h"
+#include "Engine/Renderer/RenderSnapshot.h"
 #include "Engine/Renderer/RendererData.h"
 #include "Engine/JobSystem.h"
 
@@ -28,7 +29,7 @@ namespace maple
 {
 	namespace        //private block
 	{
-		inline auto updateCascades(const component::CameraView& camera, component::ShadowMapData& shadowData, component::Light* light)
+		inline auto updateCascades(const component::CameraView& camera, component::ShadowMapData& shadowData, const component::Light* light)
 		{
 			PROFILE_FUNCTION();
 
@@ -108,13 +109,10 @@ namespace maple
 	{
 		auto beginScene(component::ShadowMapData& shadowData,
 			const component::CameraView& cameraView,
-			const global::component::SceneTransformChanged& sceneChanged,
-			ioc::Registry registry)
+			const component::RenderSnapshot& snapshot)
 		{
-			auto lightQuery = registry.getRegistry().view<component::Light>();
-			auto meshQuery = registry.getRegistry().view<component::MeshRenderer, component::Transform>();
-
-			if (sceneChanged.dirty || shadowData.dirty)
+			const auto& frame = snapshot.front();
+			if (frame.transformChanged || shadowData.dirty)
 			{
 				shadowData.dirty = false;
 				for (uint32_t i = 0; i < shadowData.shadowMapNum; i++)
@@ -122,15 +120,15 @@ namespace maple
 					shadowData.cascadeCommandQueue[i].clear();
 				}
 
-				if (!lightQuery.empty())
+				if (!frame.lights.empty())
 				{
-					component::Light* directionaLight = nullptr;
+					const component::Light* directionaLight = nullptr;
 
-					for (auto [entity, light] : lightQuery.each())
+					for (auto& instance : frame.lights)
 					{
-						if (static_cast<component::LightType>(light.lightData.type) == component::LightType::DirectionalLight)
+						if (static_cast<component::LightType>(instance.light.lightData.type) == component::LightType::DirectionalLight)
 						{
-							directionaLight = &light;
+							directionaLight = &instance.light;
 							break;
 						}
 					}
@@ -149,17 +147,17 @@ namespace maple
 
 						JobSystem::Context context;
 						JobSystem::dispatch(context, shadowData.shadowMapNum, 1, [&](JobSystem::JobDispatchArgs args) {
-							for (auto [entity, mesh, trans] : meshQuery.each())
+							for (auto& mesh : frame.meshes)
 							{
 								if (mesh.castShadow && mesh.active && mesh.mesh != nullptr)
 								{
-									auto bb = mesh.mesh->getBoundingBox()->transform(trans.getWorldMatrix());
+									auto bb = mesh.mesh->getBoundingBox()->transform(mesh.worldMatrix);
 									auto inside = shadowData.cascadeFrustums[args.jobIndex].isInside(bb);
 									if (inside)
 									{
 										auto& cmd = shadowData.cascadeCommandQueue[args.jobIndex].emplace_back();
 										cmd.mesh = mesh.mesh.get();
-										cmd.transform = trans.getWorldMatrix();
+										cmd.transform = mesh.worldMatrix;
 									}
 								}
 							}});
@@ -174,12 +172,11 @@ namespace maple
 		inline auto onRender(component::ShadowMapData& shadowData,
 			const component::RendererData& rendererData,
 			capture_graph::component::RenderGraph& renderGraph,
-			const global::component::SceneTransformChanged& sceneChanged,
-			ioc::Registry registry
+			const component::RenderSnapshot& snapshot
 			)
 		{
 
-			if (sceneChanged.dirty)
+			if (snapshot.front().transformChanged)
 			{
 				shadowData.descriptorSet[0]->update(rendererData.commandBuffer);
 
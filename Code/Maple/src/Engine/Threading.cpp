@@ -0,0 +1,62 @@
+//////////////////////////////////////////////////////////////////////////////
+// This file is part of the Maple Engine                              		//
+//////////////////////////////////////////////////////////////////////////////
+
+#include "Threading.h"
+#include <algorithm>
+#include <tuple>
+
+namespace maple::threading
+{
+	auto internal::makeFlatTopology() -> CpuTopology
+	{
+		CpuTopology topology;
+		const auto  count = std::max(1u, std::thread::hardware_concurrency());
+		for (uint32_t i = 0; i < count; ++i)
+		{
+			topology.logicalCores.push_back({i, i, 0, 0, 0});
+		}
+		topology.physicalCoreCount = count;
+		return topology;
+	}
+
+	auto getTopology() -> const CpuTopology &
+	{
+		static CpuTopology topology = internal::detectTopology();
+		return topology;
+	}
+
+	auto getPlacement(uint32_t threadCount, PlacementPolicy policy) -> std::vector<int32_t>
+	{
+		std::vector<int32_t> placement(threadCount, -1);
+		if (policy == PlacementPolicy::None)
+			return placement;
+
+		const auto &topology = getTopology();
+		auto        cores    = topology.logicalCores;
+
+		uint32_t mainCore = cores.empty() ? 0 : cores.front().core;
+		for (auto &logical : cores)
+		{
+			if (logical.id == 0)
+				mainCore = logical.core;
+		}
+
+		if (policy == PlacementPolicy::PhysicalOnly)
+		{
+			cores.erase(std::remove_if(cores.begin(), cores.end(), [](const LogicalCore &logical) { return logical.smtIndex != 0; }), cores.end());
+		}
+
+		//physical cores before siblings, filled node by node, main thread's core last within each smt level.
+		std::stable_sort(cores.begin(), cores.end(), [&](const LogicalCore &a, const LogicalCore &b) {
+			return std::make_tuple(a.smtIndex, a.core == mainCore, a.numaNode, a.package, a.core) <
+			       std::make_tuple(b.smtIndex, b.core == mainCore, b.numaNode, b.package, b.core);
+		});
+
+		for (uint32_t i = 0; i < threadCount && i < cores.size(); ++i)
+		{
+			placement[i] = cores[i].id;
+		}
+		return placement;
+	}
+}        // namespace maple::threading
@@ -0,0 +1,61 @@
+//////////////////////////////////////////////////////////////////////////////
+// This file is part of the Maple Engine                              		//
+//////////////////////////////////////////////////////////////////////////////
+#pragma once
+#include "Engine/Core.h"
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace maple::threading
+{
+	struct LogicalCore
+	{
+		uint32_t id;              //os index used for affinity
+		uint32_t core;            //physical core, unique across packages
+		uint32_t package;
+		uint32_t numaNode;
+		uint32_t smtIndex;        //0 for the first hardware thread of a physical core, 1.. for its siblings
+	};
+
+	struct CpuTopology
+	{
+		std::vector<LogicalCore> logicalCores;
+		uint32_t                 physicalCoreCount = 0;
+		uint32_t                 numaNodeCount     = 1;
+	};
+
+	enum class PlacementPolicy : uint8_t
+	{
+		None,                 //leave the scheduling to the os
+		PhysicalFirst,        //one worker per physical core, then fill the smt siblings
+		PhysicalOnly          //never place workers on smt siblings, for heavy jobs such as baking
+	};
+
+	/**
+	 * detected once and cached. falls back to one physical core per logical core when detection is not available.
+	 */
+	auto MAPLE_EXPORT getTopology() -> const CpuTopology &;
+
+	/**
+	 * logical core for each of the threadCount workers, -1 means the worker is not pinned.
+	 * every physical core gets a worker before any smt sibling does. within each of these levels the core hosting
+	 * logical core 0 comes last, it is usually shared with the main thread.
+	 */
+	auto MAPLE_EXPORT getPlacement(uint32_t threadCount, PlacementPolicy policy) -> std::vector<int32_t>;
+
+	auto MAPLE_EXPORT setAffinity(std::thread &thread, uint32_t logicalCore) -> bool;
+	auto MAPLE_EXPORT setName(std::thread &thread, const std::string &name) -> bool;
+
+	/**
+	 * raises the calling thread a little above normal, like THREAD_PRIORITY_HIGHEST. it stays in the normal
+	 * time sharing class, so it never starves the main thread or the rest of the system.
+	 */
+	auto MAPLE_EXPORT setHighPriority() -> bool;
+
+	namespace internal
+	{
+		auto detectTopology() -> CpuTopology;
+		auto makeFlatTopology() -> CpuTopology;
+	}        // namespace internal
+}        // namespace maple::threading
@@ -0,0 +1,141 @@
+//////////////////////////////////////////////////////////////////////////////
+// This file is part of the Maple Engine                              		//
+//////////////////////////////////////////////////////////////////////////////
+
+#include "Threading.h"
+
+#ifdef PLATFORM_LINUX
+#	include <algorithm>
+#	include <cerrno>
+#	include <fstream>
+#	include <map>
+#	include <pthread.h>
+#	include <sched.h>
+#	include <sstream>
+#	include <sys/resource.h>
+#	include <sys/syscall.h>
+#	include <unistd.h>
+
+namespace maple::threading
+{
+	namespace
+	{
+		constexpr const char *CpuRoot  = "/sys/devices/system/cpu/";
+		constexpr const char *NodeRoot = "/sys/devices/system/node/";
+
+		auto readLine(const std::string &path, std::string &line) -> bool
+		{
+			std::ifstream file(path);
+			return file.is_open() && std::getline(file, line) && !line.empty();
+		}
+
+		//parses the kernel cpu list format, e.g. "0-3,8,10-11"
+		auto parseList(const std::string &list) -> std::vector<uint32_t>
+		{
+			std::vector<uint32_t> values;
+			std::stringstream     ss(list);
+			std::string           range;
+			while (std::getline(ss, range, ','))
+			{
+				if (range.empty())
+					continue;
+				const auto dash  = range.find('-');
+				const auto first = (uint32_t) std::stoul(range.substr(0, dash));
+				const auto last  = dash == std::string::npos ? first : (uint32_t) std::stoul(range.substr(dash + 1));
+				for (uint32_t i = first; i <= last; ++i)
+				{
+					values.emplace_back(i);
+				}
+			}
+			return values;
+		}
+	}        // namespace
+
+	auto internal::detectTopology() -> CpuTopology
+	{
+		std::string online;
+		if (!readLine(std::string(CpuRoot) + "online", online))
+			return makeFlatTopology();
+
+		CpuTopology                                      topology;
+		std::map<std::pair<uint32_t, uint32_t>, uint32_t> physicalCores;        //(package, core_id) -> core index
+		std::map<uint32_t, uint32_t>                      siblingsCount;
+
+		try
+		{
+			for (auto cpu : parseList(online))
+			{
+				const auto  dir = std::string(CpuRoot) + "cpu" + std::to_string(cpu) + "/topology/";
+				std::string coreId;
+				std::string packageId;
+				if (!readLine(dir + "core_id", coreId) || !readLine(dir + "physical_package_id", packageId))
+					return makeFlatTopology();
+
+				LogicalCore logical{};
+				logical.id      = cpu;
+				logical.package = (uint32_t) std::max(0l, std::stol(packageId));
+
+				const auto key   = std::make_pair(logical.package, (uint32_t) std::stoul(coreId));
+				auto       iter  = physicalCores.try_emplace(key, (uint32_t) physicalCores.size()).first;
+				logical.core     = iter->second;
+				logical.smtIndex = siblingsCount[logical.core]++;
+				topology.logicalCores.emplace_back(logical);
+			}
+
+			std::string nodes;
+			if (readLine(std::string(NodeRoot) + "online", nodes))
+			{
+				for (auto node : parseList(nodes))
+				{
+					std::string cpus;
+					if (!readLine(std::string(NodeRoot) + "node" + std::to_string(node) + "/cpulist", cpus))
+						continue;
+					for (auto cpu : parseList(cpus))
+					{
+						for (auto &logical : topology.logicalCores)
+						{
+							if (logical.id == cpu)
+								logical.numaNode = node;
+						}
+					}
+					topology.numaNodeCount = std::max(topology.numaNodeCount, node + 1);
+				}
+			}
+		}
+		catch (const std::exception &)
+		{
+			return makeFlatTopology();
+		}
+
+		topology.physicalCoreCount = (uint32_t) physicalCores.size();
+		return topology;
+	}
+
+	auto setAffinity(std::thread &thread, uint32_t logicalCore) -> bool
+	{
+		if (logicalCore >= CPU_SETSIZE)
+			return false;
+		cpu_set_t set;
+		CPU_ZERO(&set);
+		CPU_SET(logicalCore, &set);
+		return pthread_setaffinity_np(thread.native_handle(), sizeof(cpu_set_t), &set) == 0;
+	}
+
+	auto setName(std::thread &thread, const std::string &name) -> bool
+	{
+		//the kernel limits names to 15 characters plus the terminator.
+		return pthread_setname_np(thread.native_handle(), name.substr(0, 15).c_str()) == 0;
+	}
+
+	auto setHighPriority() -> bool
+	{
+		//nice is per thread on linux, two steps up is about THREAD_PRIORITY_HIGHEST.
+		//lowering it needs CAP_SYS_NICE or an RLIMIT_NICE, without them the thread keeps its nice value.
+		const auto tid = static_cast<id_t>(syscall(SYS_gettid));
+		errno          = 0;
+		const int nice = getpriority(PRIO_PROCESS, tid);
+		return errno == 0 && setpriority(PRIO_PROCESS, tid, std::max(nice - 2, -20)) == 0;
+	}
+}        // namespace maple::threading
+
+#endif
@@ -0,0 +1,117 @@
+//////////////////////////////////////////////////////////////////////////////
+// This file is part of the Maple Engine                              		//
+//////////////////////////////////////////////////////////////////////////////
+
+#include "Threading.h"
+
+#ifdef PLATFORM_WINDOWS
+#	ifndef WIN32_LEAN_AND_MEAN
+#		define WIN32_LEAN_AND_MEAN
+#	endif
+#	include <Windows.h>
+#	include <map>
+
+namespace maple::threading
+{
+	namespace
+	{
+		template <typename Func>
+		auto forEachProcessorInfo(LOGICAL_PROCESSOR_RELATIONSHIP relationship, const Func &func)
+		{
+			DWORD length = 0;
+			GetLogicalProcessorInformationEx(relationship, nullptr, &length);
+			if (length == 0)
+				return false;
+
+			std::vector<uint8_t> buffer(length);
+			if (!GetLogicalProcessorInformationEx(relationship, reinterpret_cast<PSYSTEM_LOGICAL_PROCESSOR_INFORMATION_EX>(buffer.data()), &length))
+				return false;
+
+			for (DWORD offset = 0; offset < length;)
+			{
+				auto info = reinterpret_cast<PSYSTEM_LOGICAL_PROCESSOR_INFORMATION_EX>(buffer.data() + offset);
+				func(*info);
+				offset += info->Size;
+			}
+			return true;
+		}
+
+		template <typename Func>
+		auto forEachBit(KAFFINITY mask, const Func &func)
+		{
+			for (uint32_t bit = 0; bit < sizeof(KAFFINITY) * 8; ++bit)
+			{
+				if (mask & (KAFFINITY(1) << bit))
+					func(bit);
+			}
+		}
+	}        // namespace
+
+	auto internal::detectTopology() -> CpuTopology
+	{
+		//only processor group 0 is handled, which matches what SetThreadAffinityMask could address.
+		std::map<uint32_t, LogicalCore> cores;
+		uint32_t                        coreIndex    = 0;
+		uint32_t                        packageIndex = 0;
+
+		bool succeed = forEachProcessorInfo(RelationProcessorCore, [&](const SYSTEM_LOGICAL_PROCESSOR_INFORMATION_EX &info) {
+			uint32_t smt = 0;
+			if (info.Processor.GroupMask[0].Group == 0)
+			{
+				forEachBit(info.Processor.GroupMask[0].Mask, [&](uint32_t bit) {
+					cores[bit] = {bit, coreIndex, 0, 0, smt++};
+				});
+			}
+			coreIndex++;
+		});
+
+		if (!succeed || cores.empty())
+			return makeFlatTopology();
+
+		forEachProcessorInfo(RelationProcessorPackage, [&](const SYSTEM_LOGICAL_PROCESSOR_INFORMATION_EX &info) {
+			forEachBit(info.Processor.GroupMask[0].Mask, [&](uint32_t bit) {
+				if (auto iter = cores.find(bit); iter != cores.end() && info.Processor.GroupMask[0].Group == 0)
+					iter->second.package = packageIndex;
+			});
+			packageIndex++;
+		});
+
+		CpuTopology topology;
+		forEachProcessorInfo(RelationNumaNode, [&](const SYSTEM_LOGICAL_PROCESSOR_INFORMATION_EX &info) {
+			if (info.NumaNode.GroupMask.Group != 0)
+				return;
+			forEachBit(info.NumaNode.GroupMask.Mask, [&](uint32_t bit) {
+				if (auto iter = cores.find(bit); iter != cores.end())
+					iter->second.numaNode = info.NumaNode.NodeNumber;
+			});
+			topology.numaNodeCount = std::max<uint32_t>(topology.numaNodeCount, info.NumaNode.NodeNumber + 1);
+		});
+
+		for (auto &[id, logical] : cores)
+		{
+			topology.logicalCores.emplace_back(logical);
+		}
+		topology.physicalCoreCount = coreIndex;
+		return topology;
+	}
+
+	auto setAffinity(std::thread &thread, uint32_t logicalCore) -> bool
+	{
+		if (logicalCore >= sizeof(DWORD_PTR) * 8)
+			return false;
+		return SetThreadAffinityMask((HANDLE) thread.native_handle(), DWORD_PTR(1) << logicalCore) != 0;
+	}
+
+	auto setName(std::thread &thread, const std::string &name) -> bool
+	{
+		std::wstring wname(name.begin(), name.end());
+		return SUCCEEDED(SetThreadDescription((HANDLE) thread.native_handle(), wname.c_str()));
+	}
+
+	auto setHighPriority() -> bool
+	{
+		return SetThreadPriority(GetCurrentThread(), THREAD_PRIORITY_HIGHEST) != 0;
+	}
+}        // namespace maple::threading
+
+#endif
@@ -172,7 +172,7 @@ namespace maple::io
 		{
 			const ofbx::Texture *      ofbxTexture = material->getTexture(type);
 			std::shared_ptr<Texture2D> texture2D;
-			if (ofbxTexture)
+			if (ofbxTexture && !isHeadless())
 			{
 				ofbx::DataView filename = ofbxTexture->getRelativeFileName();
 				if (filename == "")
@@ -120,7 +120,7 @@ namespace maple::io
 					imageAndSampler.sampler = &gltfModel.samplers.at(gltfTexture.sampler);
 				}
 
-				if (imageAndSampler.image && loadedTextures[gltfTexture.source] == nullptr)
+				if (imageAndSampler.image && loadedTextures[gltfTexture.source] == nullptr && !isHeadless())
 				{
 					TextureParameters params;
 					if (gltfTexture.sampler != -1)
@@ -16,6 +16,7 @@ namespace maple
 		std::unordered_map<std::string, std::vector<std::shared_ptr<IResource>>> cache;
 		std::unordered_set<std::string>                                          supportExtensions;
 		std::vector<std::shared_ptr<IResource>>                                  nullOut;
+		bool                                                                     headless = false;
 
 		auto load(const std::string &obj) -> std::vector<std::shared_ptr<IResource>>&
 		{
@@ -62,6 +63,16 @@ namespace maple
 			addLoader<FBXLoader>();
 		}
 
+		auto setHeadless(bool enable) -> void
+		{
+			headless = enable;
+		}
+
+		auto isHeadless() -> bool
+		{
+			return headless;
+		}
+
 		auto addLoader(const std::string &extension, const AssetsArchive::Ptr &loader) -> void
 		{
 			loaders.emplace(extension, loader);
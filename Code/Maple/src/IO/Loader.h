@@ -31,6 +31,12 @@ namespace maple
 
 		auto MAPLE_EXPORT init() -> void;
 
+		/**
+		 * headless loading keeps meshes on the cpu and skips textures, so tools can load assets without a graphics context.
+		 */
+		auto MAPLE_EXPORT setHeadless(bool headless) -> void;
+		auto MAPLE_EXPORT isHeadless() -> bool;
+
 		auto MAPLE_EXPORT addLoader(const std::string &extension, const AssetsArchive::Ptr &loader) -> void;
 
 		auto MAPLE_EXPORT getSupportExtensions() -> const std::unordered_set<std::string> &;
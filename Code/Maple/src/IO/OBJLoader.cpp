@@ -16,6 +16,9 @@ namespace maple::io
 {
 	std::shared_ptr<Texture2D> loadMaterialTextures(const std::string &typeName, std::vector<std::shared_ptr<Texture2D>> &texturesLoaded, const std::string &name, const std::string &directory, TextureParameters format)
 	{
+		if (isHeadless())
+			return nullptr;
+
 		for (uint32_t j = 0; j < texturesLoaded.size(); j++)
 		{
 			if (std::strcmp(texturesLoaded[j]->getFilePath().c_str(), (directory + "/" + name).c_str()) == 0)
@@ -0,0 +1,78 @@
+//////////////////////////////////////////////////////////////////////////////
+// This file is part of the Maple Engine                              		//
+//////////////////////////////////////////////////////////////////////////////
+#pragma once
+#include "TypeList.h"
+#include <entt.hpp>
+
+namespace maple::ioc
+{
+	/**
+	 * entity components a system iterates, declared in its signature instead of reached through Registry.
+	 * const components are read and the others written, so the system is not scheduled as exclusive.
+	 * the storages are created when the system is registered, building the view only looks them up.
+	 */
+	template <typename... Components>
+	class Query
+	{
+	  public:
+		using View = decltype(std::declval<entt::registry &>().template view<Components...>());
+
+		Query(entt::registry &r) :
+		    view(r.template view<Components...>())
+		{}
+
+		inline auto each()
+		{
+			return view.each();
+		}
+
+		template <typename Func>
+		inline auto each(Func func)
+		{
+			view.each(func);
+		}
+
+		inline auto begin() const
+		{
+			return view.begin();
+		}
+
+		inline auto end() const
+		{
+			return view.end();
+		}
+
+		inline auto empty() const
+		{
+			return view.begin() == view.end();
+		}
+
+		inline auto contains(entt::entity entity) const
+		{
+			return view.contains(entity);
+		}
+
+		template <typename... T>
+		inline decltype(auto) get(entt::entity entity) const
+		{
+			return view.template get<T...>(entity);
+		}
+
+	  private:
+		View view;
+	};
+
+	template <typename T>
+	struct QueryTraits
+	{
+		static constexpr bool value = false;
+	};
+
+	template <typename... Components>
+	struct QueryTraits<Query<Components...>>
+	{
+		static constexpr bool value = true;
+		using Types                 = TypeList<Components...>;
+	};
+}        // namespace maple::ioc
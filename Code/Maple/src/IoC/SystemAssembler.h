@@ -4,6 +4,7 @@
 
 #pragma once
 #include "DependencyBuilder.h"
+#include "Query.h"
 #include "SystemInfo.h"
 #include "TypeList.h"
 
@@ -20,6 +21,46 @@ namespace maple::ioc
 		};
 	};
 
+	template <typename T>
+	struct AccessTraits
+	{
+		static constexpr bool exclusive = true;
+		static constexpr bool write     = true;
+		using Type                      = void;
+	};
+
+	template <typename T>
+	struct AccessTraits<T &>
+	{
+		static constexpr bool exclusive = false;
+		static constexpr bool write     = true;
+		using Type                      = T;
+	};
+
+	template <typename T>
+	struct AccessTraits<const T &>
+	{
+		static constexpr bool exclusive = false;
+		static constexpr bool write     = false;
+		using Type                      = T;
+	};
+
+	template <typename T>
+	struct AccessTraits<T *>
+	{
+		static constexpr bool exclusive = false;
+		static constexpr bool write     = true;
+		using Type                      = T;
+	};
+
+	template <typename T>
+	struct AccessTraits<const T *>
+	{
+		static constexpr bool exclusive = false;
+		static constexpr bool write     = false;
+		using Type                      = T;
+	};
+
 	struct SystemAssembler
 	{
 		static constexpr auto leftSize = sizeof("struct ecs::SystemFunction<&__cdecl");
@@ -61,6 +102,96 @@ namespace maple::ioc
 			return reflectVariables(r, entity, ioc::TypeList<TArgs...>{});
 		}
 
+		template <typename T>
+		static auto globalAccess() -> ComponentAccess
+		{
+			ComponentAccess access;
+			access.typeId   = entt::type_hash<T>::value();
+			access.typeName = entt::type_name<T>::value();
+			access.size     = sizeof(T);
+			access.snapshot = [](entt::registry &r, std::vector<uint8_t> &bytes) {
+				auto ptr = reinterpret_cast<const uint8_t *>(r.ctx().template find<T>());
+				bytes.assign(ptr, ptr == nullptr ? ptr : ptr + sizeof(T));
+			};
+			return access;
+		}
+
+		template <typename T>
+		static auto entityAccess() -> ComponentAccess
+		{
+			ComponentAccess access;
+			access.typeId   = entt::type_hash<T>::value();
+			access.typeName = entt::type_name<T>::value();
+			access.size     = sizeof(T);
+			access.entity   = true;
+			access.snapshot = [](entt::registry &r, std::vector<uint8_t> &bytes) {
+				bytes.clear();
+				if constexpr (!entt::ignore_as_empty_v<T>)
+				{
+					for (auto &component : r.template storage<T>())
+					{
+						auto ptr = reinterpret_cast<const uint8_t *>(&component);
+						bytes.insert(bytes.end(), ptr, ptr + sizeof(T));
+					}
+				}
+			};
+			return access;
+		}
+
+		template <typename... Components>
+		static auto reflectQuery(SystemInfo &info, TypeList<Components...>) -> void
+		{
+			((std::is_const_v<Components> ? info.reads : info.writes).emplace_back(entityAccess<std::remove_const_t<Components>>()), ...);
+		}
+
+		template <typename... Components>
+		static auto assureQuery(entt::registry &r, TypeList<Components...>) -> void
+		{
+			(r.template storage<std::remove_const_t<Components>>(), ...);
+		}
+
+		template <typename TArg>
+		static auto assureStorage(entt::registry &r) -> void
+		{
+			if constexpr (QueryTraits<TArg>::value)
+			{
+				assureQuery(r, typename QueryTraits<TArg>::Types{});
+			}
+		}
+
+		//creates the storages of every Query in the signature when the system is registered.
+		//building a view of a missing storage inserts into the registry's pool map, which races with the other systems of a parallel queue.
+		template <auto System, typename... TArgs>
+		static auto assureStorages(entt::registry &r, SystemFunction<System, void (*)(TArgs...)>) -> void
+		{
+			(assureStorage<TArgs>(r), ...);
+		}
+
+		template <typename TArg>
+		static auto reflectAccess(SystemInfo &info) -> void
+		{
+			using Traits = AccessTraits<TArg>;
+			if constexpr (QueryTraits<TArg>::value)
+			{
+				reflectQuery(info, typename QueryTraits<TArg>::Types{});
+			}
+			else if constexpr (Traits::exclusive)
+			{
+				info.exclusive = true;
+			}
+			else
+			{
+				using T = typename Traits::Type;
+				(Traits::write ? info.writes : info.reads).emplace_back(globalAccess<T>());
+			}
+		}
+
+		template <auto System, typename... TArgs>
+		static auto reflectAccess(SystemFunction<System, void (*)(TArgs...)>, SystemInfo &info) -> void
+		{
+			(reflectAccess<TArgs>(info), ...);
+		}
+
 		template <auto System, typename... TArgs>
 		static constexpr auto getSystemFullName(SystemFunction<System, void (*)(TArgs...)> system)
 		{
@@ -5,6 +5,10 @@
 #include "SystemBuilder.h"
 #include "Scene/Component/Component.h"
 #include "Scene/Entity/Entity.h"
+#include "Others/Console.h"
+
+#include <algorithm>
+#include <functional>
 
 namespace maple
 {
@@ -73,4 +77,212 @@ namespace maple
 		}
 		return {};
 	}
+
+	namespace
+	{
+		inline auto buildDependencies(SystemQueue &queue)
+		{
+			queue.dependencies.assign(queue.jobs.size(), {});
+			for (uint32_t i = 0; i < queue.jobs.size(); ++i)
+			{
+				for (uint32_t j = 0; j < i; ++j)
+				{
+					//conflicting systems keep their registration order.
+					if (queue.jobs[i]->conflictsWith(*queue.jobs[j]))
+						queue.dependencies[i].emplace_back(j);
+				}
+			}
+			queue.dirty = false;
+		}
+
+		inline auto declares(const std::vector<ioc::ComponentAccess> &accesses, entt::id_type typeId)
+		{
+			return std::any_of(accesses.begin(), accesses.end(), [&](auto &access) { return access.typeId == typeId; });
+		}
+	}        // namespace
+
+	auto SystemBuilder::flushParallel(SystemQueue &queue) -> void
+	{
+		PROFILE_FUNCTION();
+		if (queue.dirty)
+			buildDependencies(queue);
+
+		std::vector<JobSystem::TaskHandle> tasks(queue.jobs.size());
+		std::vector<JobSystem::TaskHandle> dependencies;
+		for (uint32_t i = 0; i < queue.jobs.size(); ++i)
+		{
+			dependencies.clear();
+			for (auto dependency : queue.dependencies[i])
+			{
+				dependencies.emplace_back(tasks[dependency]);
+			}
+			auto info = queue.jobs[i];
+			tasks[i]  = JobSystem::schedule([this, info]() { info->systemCall(registry); }, dependencies);
+		}
+		JobSystem::wait(JobSystem::whenAll(tasks));
+	}
+
+	namespace
+	{
+		struct StorageState
+		{
+			entt::id_type    typeId;
+			std::string_view typeName;
+			size_t           size;
+			size_t           hash;        //of the entity list, changes when components are added or removed
+		};
+
+		inline auto captureStorages(entt::registry &registry, std::vector<StorageState> &states)
+		{
+			states.clear();
+			for (auto [id, storage] : registry.storage())
+			{
+				auto entities = std::string_view{reinterpret_cast<const char *>(storage.data()), storage.size() * sizeof(entt::entity)};
+				states.push_back({id, storage.type().name(), storage.size(), std::hash<std::string_view>{}(entities)});
+			}
+		}
+	}        // namespace
+
+	auto SystemBuilder::flushValidated(SystemQueue &queue) -> void
+	{
+		PROFILE_FUNCTION();
+		std::vector<std::vector<uint8_t>> snapshots;
+		std::vector<uint8_t>              current;
+		std::vector<StorageState>         before;
+		std::vector<StorageState>         after;
+		for (auto &info : queue.jobs)
+		{
+			if (info->exclusive)
+			{
+				//it declares the whole registry, nothing is undeclared.
+				info->systemCall(registry);
+				continue;
+			}
+
+			snapshots.resize(info->reads.size());
+			for (size_t i = 0; i < info->reads.size(); ++i)
+			{
+				info->reads[i].snapshot(registry, snapshots[i]);
+			}
+			captureStorages(registry, before);
+
+			info->systemCall(registry);
+
+			for (size_t i = 0; i < info->reads.size(); ++i)
+			{
+				auto &read = info->reads[i];
+				read.snapshot(registry, current);
+				if (current != snapshots[i])
+				{
+					LOGW("[{0}] {1} modified {2} which is declared as const", queue.name, info->systemName, read.typeName);
+				}
+			}
+
+			//components can only be added or removed through a writable Query or the Registry.
+			captureStorages(registry, after);
+			for (auto &state : after)
+			{
+				auto iter    = std::find_if(before.begin(), before.end(), [&](auto &old) { return old.typeId == state.typeId; });
+				auto changed = iter == before.end() ? state.size != 0 : iter->size != state.size || iter->hash != state.hash;
+				if (changed && !declares(info->writes, state.typeId))
+				{
+					LOGW("[{0}] {1} added or removed {2} components without declaring it writable", queue.name, info->systemName, state.typeName);
+				}
+			}
+		}
+	}
+
+	auto SystemBuilder::markLocked(SystemQueue &queue) -> void
+	{
+		queue.locked.assign(queue.jobs.size(), false);
+		queue.lockedFor = countSimulationSystems();
+		for (size_t i = 0; i < queue.jobs.size(); ++i)
+		{
+			auto info = queue.jobs[i];
+			//the update may move entities or add components at any time, so only globals can be shared.
+			auto entity = [](auto &access) { return access.entity; };
+			if (info->exclusive || std::any_of(info->reads.begin(), info->reads.end(), entity) || std::any_of(info->writes.begin(), info->writes.end(), entity))
+			{
+				queue.locked[i] = true;
+				continue;
+			}
+
+			//exclusive update systems are not considered, they reach globals through the registry context on their own.
+			for (auto simulationQueue : getSimulationQueues())
+			{
+				for (auto other : simulationQueue->jobs)
+				{
+					for (auto &write : other->writes)
+					{
+						if (declares(info->reads, write.typeId) || declares(info->writes, write.typeId))
+							queue.locked[i] = true;
+					}
+					for (auto &read : other->reads)
+					{
+						if (declares(info->writes, read.typeId))
+							queue.locked[i] = true;
+					}
+				}
+			}
+		}
+	}
+
+	auto SystemBuilder::flushPipelined(SystemQueue &queue) -> void
+	{
+		PROFILE_FUNCTION();
+		if (queue.dirty)
+			buildDependencies(queue);
+
+		if (queue.locked.size() != queue.jobs.size() || queue.lockedFor != countSimulationSystems())
+			markLocked(queue);
+
+		if (queue.validate)
+		{
+			//the validation compares the whole registry before and after each system.
+			std::lock_guard<std::mutex> lock(simulation);
+			flushValidated(queue);
+			return;
+		}
+
+		if (!queue.parallel || queue.jobs.size() < 2)
+		{
+			for (size_t i = 0; i < queue.jobs.size(); ++i)
+			{
+				if (queue.locked[i])
+				{
+					std::lock_guard<std::mutex> lock(simulation);
+					queue.jobs[i]->systemCall(registry);
+				}
+				else
+				{
+					queue.jobs[i]->systemCall(registry);
+				}
+			}
+			return;
+		}
+
+		//locked systems run on this thread, the main thread would deadlock if it picked one up while waiting inside the update.
+		std::vector<JobSystem::TaskHandle> tasks(queue.jobs.size());
+		std::vector<JobSystem::TaskHandle> dependencies;
+		for (uint32_t i = 0; i < queue.jobs.size(); ++i)
+		{
+			dependencies.clear();
+			for (auto dependency : queue.dependencies[i])
+			{
+				dependencies.emplace_back(tasks[dependency]);
+			}
+
+			auto info = queue.jobs[i];
+			if (!queue.locked[i])
+			{
+				tasks[i] = JobSystem::schedule([this, info]() { info->systemCall(registry); }, dependencies);
+				continue;
+			}
+
+			JobSystem::wait(JobSystem::whenAll(dependencies));
+			std::lock_guard<std::mutex> lock(simulation);
+			info->systemCall(registry);
+		}
+		JobSystem::wait(JobSystem::whenAll(tasks));
+	}
 };        // namespace maple
@@ -12,6 +12,9 @@
 #include "SystemAssembler.h"
 #include "Registry.h"
 
+#include <array>
+#include <mutex>
+
 namespace maple
 {
 	namespace ioc
@@ -46,6 +49,17 @@ namespace maple
 		std::vector<ioc::SystemInfo*> jobs;
 		//SysytemId -> Dependency
 		std::unordered_map<uint32_t, ioc::SystemInfo> systemInfos;
+
+		bool parallel = false;        //run systems with disjoint component access concurrently on the JobSystem
+		bool validate = false;        //debug : run serially and report writes to const components and undeclared component additions or removals
+
+		//for each job, the earlier jobs it conflicts with. rebuilt when the queue changes.
+		std::vector<std::vector<uint32_t>> dependencies;
+		bool                               dirty = true;
+
+		//pipelined : the jobs which touch state the update owns, they hold the simulation lock while running.
+		std::vector<bool> locked;
+		size_t            lockedFor = 0;        //number of update side systems the flags were built against
 	};
 
 	class MAPLE_EXPORT SystemBuilder
@@ -61,8 +75,9 @@ namespace maple
 			factoryQueue("Factory"),
 			frameEndQueue("FrmeEnd") {};
 
-		inline auto registerQueue(SystemQueue& queue)
+		inline auto registerQueue(SystemQueue& queue, bool parallel = false)
 		{
+			queue.parallel = parallel;
 			graph.emplace_back(&queue);
 		}
 
@@ -201,12 +216,45 @@ namespace maple
 
 		inline auto flushJobs(SystemQueue& queue)
 		{
+			if (queue.validate)
+			{
+				flushValidated(queue);
+				return;
+			}
+
+			if (queue.parallel && queue.jobs.size() > 1)
+			{
+				flushParallel(queue);
+				return;
+			}
+
 			for (auto& func : queue.jobs)
 			{
 				func->systemCall(registry);
 			}
 		}
 
+		auto flushParallel(SystemQueue& queue) -> void;
+		auto flushValidated(SystemQueue& queue) -> void;
+		auto flushPipelined(SystemQueue& queue) -> void;
+		auto markLocked(SystemQueue& queue) -> void;
+
+		//the queues the main thread runs during the update
+		inline auto getSimulationQueues() const
+		{
+			return std::array<const SystemQueue*, 4>{&updateQueue, &imGuiQueue, &gameStartQueue, &gameEndedQueue};
+		}
+
+		inline auto countSimulationSystems() const
+		{
+			size_t count = 0;
+			for (auto queue : getSimulationQueues())
+			{
+				count += queue->jobs.size();
+			}
+			return count;
+		}
+
 		template <auto Candidate>
 		static auto delegateComponent(entt::registry& registry, entt::entity entity)
 		{
@@ -233,6 +281,7 @@ namespace maple
 			{
 				flushJobs(factoryQueue);
 				factoryQueue.jobs.clear();
+				factoryQueue.dirty = true;
 			}
 
 			for (auto g : graph)
@@ -242,6 +291,27 @@ namespace maple
 			flushJobs(frameEndQueue);
 		}
 
+		/**
+		 * pipelined : runs the same queues as execute on the render thread while the main thread updates the next frame.
+		 * systems which only read the RenderSnapshot and render side globals run right away, the others take the
+		 * simulation lock, which the main thread holds for the whole update.
+		 */
+		inline auto executePipelined()
+		{
+			if (!factoryQueue.jobs.empty())
+			{
+				flushPipelined(factoryQueue);
+				factoryQueue.jobs.clear();
+				factoryQueue.dirty = true;
+			}
+
+			for (auto g : graph)
+			{
+				flushPipelined(*g);
+			}
+			flushPipelined(frameEndQueue);
+		}
+
 		template <auto System>
 		inline auto expand(ioc::SystemFunction<System> system, SystemQueue& queue) -> void
 		{
@@ -259,7 +329,13 @@ namespace maple
 				auto call = ioc::SystemAssembler::template assembleSystem(TSystem{});
 				call(TSystem{}, ioc::SystemAssembler::template reflectVariables(reg, TSystem{}));
 			};
+			queue.systemInfos[id].reads.clear();
+			queue.systemInfos[id].writes.clear();
+			queue.systemInfos[id].exclusive = false;
+			ioc::SystemAssembler::template reflectAccess(TSystem{}, queue.systemInfos[id]);
+			ioc::SystemAssembler::template assureStorages(registry, TSystem{});
 			queue.jobs.emplace_back(&queue.systemInfos[id]);
+			queue.dirty = true;
 		}
 
 		SystemQueue gameStartQueue;
@@ -277,5 +353,7 @@ namespace maple
 		std::vector<SystemQueue*> graph;
 
 		entt::registry registry;
+
+		std::mutex simulation;        //held by the main thread while it updates, see executePipelined
 	};
 };        // namespace maple
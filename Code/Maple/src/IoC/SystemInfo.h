@@ -1,10 +1,24 @@
 //////////////////////////////////////////////////////////////////////////////
 // This file is part of the Maple Engine                              		//
 //////////////////////////////////////////////////////////////////////////////
+#include <cstdint>
+#include <string_view>
 #include <unordered_map>
+#include <vector>
 
 namespace maple::ioc
 {
+	struct ComponentAccess
+	{
+		using Snapshot = void (*)(entt::registry &, std::vector<uint8_t> &);
+
+		entt::id_type    typeId;
+		std::string_view typeName;
+		size_t           size;
+		Snapshot         snapshot;        //copies the bytes of the global instance or of every entity component, used by the debug validation
+		bool             entity = false;        //a component of the entities rather than a global one
+	};
+
 	struct SystemInfo
 	{
 		using SystemCall = void (*)(entt::registry &);
@@ -12,5 +26,30 @@ namespace maple::ioc
 		uint32_t                                    systemId;
 		std::string_view                            systemName;
 		SystemCall                                  systemCall;
+
+		//derived from the system signature : T& and T* write, const T& and const T* read.
+		//Query<T...> adds its entity components the same way, const ones are read.
+		std::vector<ComponentAccess> reads;
+		std::vector<ComponentAccess> writes;
+		bool                         exclusive = false;        //takes the Registry or another by-value dependency, so it could touch anything
+
+		inline auto conflictsWith(const SystemInfo &other) const -> bool
+		{
+			if (exclusive || other.exclusive)
+				return true;
+
+			auto overlaps = [](const std::vector<ComponentAccess> &left, const std::vector<ComponentAccess> &right) {
+				for (auto &l : left)
+				{
+					for (auto &r : right)
+					{
+						if (l.typeId == r.typeId)
+							return true;
+					}
+				}
+				return false;
+			};
+			return overlaps(writes, other.writes) || overlaps(writes, other.reads) || overlaps(reads, other.writes);
+		}
 	};
 }        // namespace ecs
@@ -0,0 +1,256 @@
+//////////////////////////////////////////////////////////////////////////////
+// This file is part of the Maple Engine                              		//
+//////////////////////////////////////////////////////////////////////////////
+
+#include "DynamicAABBTree.h"
+
+#include <algorithm>
+
+namespace maple
+{
+	namespace
+	{
+		inline auto surfaceArea(const BoundingBox &box)
+		{
+			const auto size = box.size();
+			return 2.f * (size.x * size.y + size.y * size.z + size.z * size.x);
+		}
+
+		inline auto combine(const BoundingBox &a, const BoundingBox &b)
+		{
+			BoundingBox box = a;
+			box.merge(b);
+			return box;
+		}
+
+		inline auto contains(const BoundingBox &outer, const BoundingBox &inner)
+		{
+			return glm::all(glm::lessThanEqual(outer.min, inner.min)) && glm::all(glm::lessThanEqual(inner.max, outer.max));
+		}
+	}        // namespace
+
+	DynamicAABBTree::DynamicAABBTree(float margin) :
+	    margin(margin)
+	{
+	}
+
+	auto DynamicAABBTree::createProxy(const BoundingBox &box, uint32_t userData) -> int32_t
+	{
+		const auto proxy      = allocateNode();
+		nodes[proxy].box      = fatten(box);
+		nodes[proxy].userData = userData;
+		nodes[proxy].height   = 0;
+		insertLeaf(proxy);
+		proxyCount++;
+		return proxy;
+	}
+
+	auto DynamicAABBTree::destroyProxy(int32_t proxy) -> void
+	{
+		removeLeaf(proxy);
+		freeNode(proxy);
+		proxyCount--;
+	}
+
+	auto DynamicAABBTree::moveProxy(int32_t proxy, const BoundingBox &box) -> bool
+	{
+		if (contains(nodes[proxy].box, box))
+			return false;
+
+		removeLeaf(proxy);
+		nodes[proxy].box = fatten(box);
+		insertLeaf(proxy);
+		return true;
+	}
+
+	auto DynamicAABBTree::fatten(const BoundingBox &box) const -> BoundingBox
+	{
+		const auto extension = box.size() * margin;
+		return {box.min - extension, box.max + extension};
+	}
+
+	auto DynamicAABBTree::allocateNode() -> int32_t
+	{
+		if (freeList == Null)
+		{
+			nodes.emplace_back();
+			return static_cast<int32_t>(nodes.size() - 1);
+		}
+
+		const auto node = freeList;
+		freeList        = nodes[node].parent;
+		nodes[node]     = Node{};
+		return node;
+	}
+
+	auto DynamicAABBTree::freeNode(int32_t node) -> void
+	{
+		nodes[node].parent = freeList;
+		nodes[node].height = -1;
+		freeList           = node;
+	}
+
+	auto DynamicAABBTree::insertLeaf(int32_t leaf) -> void
+	{
+		if (root == Null)
+		{
+			root               = leaf;
+			nodes[root].parent = Null;
+			return;
+		}
+
+		// descend towards the sibling with the lowest cost, the cost of a subtree includes the growth of every ancestor.
+		const auto leafBox = nodes[leaf].box;
+		auto       index   = root;
+		while (!nodes[index].isLeaf())
+		{
+			const auto &node   = nodes[index];
+			const float area   = surfaceArea(node.box);
+			const float merged = surfaceArea(combine(node.box, leafBox));
+
+			const float cost        = 2.f * merged;
+			const float inheritance = 2.f * (merged - area);
+
+			auto childCost = [&](int32_t child) {
+				const auto box = combine(leafBox, nodes[child].box);
+				if (nodes[child].isLeaf())
+					return surfaceArea(box) + inheritance;
+				return surfaceArea(box) - surfaceArea(nodes[child].box) + inheritance;
+			};
+
+			const float cost1 = childCost(node.child1);
+			const float cost2 = childCost(node.child2);
+
+			if (cost < cost1 && cost < cost2)
+				break;
+
+			index = cost1 < cost2 ? node.child1 : node.child2;
+		}
+
+		const auto sibling   = index;
+		const auto oldParent = nodes[sibling].parent;
+		const auto newParent = allocateNode();
+
+		nodes[newParent].parent = oldParent;
+		nodes[newParent].box    = combine(leafBox, nodes[sibling].box);
+		nodes[newParent].height = nodes[sibling].height + 1;
+		nodes[newParent].child1 = sibling;
+		nodes[newParent].child2 = leaf;
+		nodes[sibling].parent   = newParent;
+		nodes[leaf].parent      = newParent;
+
+		if (oldParent != Null)
+		{
+			if (nodes[oldParent].child1 == sibling)
+				nodes[oldParent].child1 = newParent;
+			else
+				nodes[oldParent].child2 = newParent;
+		}
+		else
+		{
+			root = newParent;
+		}
+
+		// walk back up refitting boxes and heights.
+		for (index = nodes[leaf].parent; index != Null; index = nodes[index].parent)
+		{
+			index = balance(index);
+
+			const auto child1   = nodes[index].child1;
+			const auto child2   = nodes[index].child2;
+			nodes[index].height = 1 + std::max(nodes[child1].height, nodes[child2].height);
+			nodes[index].box    = combine(nodes[child1].box, nodes[child2].box);
+		}
+	}
+
+	auto DynamicAABBTree::removeLeaf(int32_t leaf) -> void
+	{
+		if (leaf == root)
+		{
+			root = Null;
+			return;
+		}
+
+		const auto parent      = nodes[leaf].parent;
+		const auto grandParent = nodes[parent].parent;
+		const auto sibling     = nodes[parent].child1 == leaf ? nodes[parent].child2 : nodes[parent].child1;
+
+		if (grandParent != Null)
+		{
+			if (nodes[grandParent].child1 == parent)
+				nodes[grandParent].child1 = sibling;
+			else
+				nodes[grandParent].child2 = sibling;
+			nodes[sibling].parent = grandParent;
+			freeNode(parent);
+
+			for (auto index = grandParent; index != Null; index = nodes[index].parent)
+			{
+				index = balance(index);
+
+				const auto child1   = nodes[index].child1;
+				const auto child2   = nodes[index].child2;
+				nodes[index].box    = combine(nodes[child1].box, nodes[child2].box);
+				nodes[index].height = 1 + std::max(nodes[child1].height, nodes[child2].height);
+			}
+		}
+		else
+		{
+			root                  = sibling;
+			nodes[sibling].parent = Null;
+			freeNode(parent);
+		}
+	}
+
+	// rotates the taller child of a up when the children heights differ by more than one, returns the new subtree root.
+	auto DynamicAABBTree::balance(int32_t a) -> int32_t
+	{
+		auto &nodeA = nodes[a];
+		if (nodeA.isLeaf() || nodeA.height < 2)
+			return a;
+
+		const auto b = nodeA.child1;
+		const auto c = nodeA.child2;
+
+		const auto diff = nodes[c].height - nodes[b].height;
+		if (diff > 1 || diff < -1)
+		{
+			// up is the taller child, it takes a's place and a adopts the smaller of up's children.
+			const auto up   = diff > 1 ? c : b;
+			const auto down = diff > 1 ? b : c;
+			const auto f    = nodes[up].child1;
+			const auto g    = nodes[up].child2;
+
+			nodes[up].child1 = a;
+			nodes[up].parent = nodeA.parent;
+			nodeA.parent     = up;
+
+			if (nodes[up].parent != Null)
+			{
+				if (nodes[nodes[up].parent].child1 == a)
+					nodes[nodes[up].parent].child1 = up;
+				else
+					nodes[nodes[up].parent].child2 = up;
+			}
+			else
+			{
+				root = up;
+			}
+
+			const auto keep  = nodes[f].height > nodes[g].height ? f : g;
+			const auto adopt = keep == f ? g : f;
+
+			nodes[up].child2    = keep;
+			nodeA.child1        = down;
+			nodeA.child2        = adopt;
+			nodes[adopt].parent = a;
+
+			nodeA.box        = combine(nodes[down].box, nodes[adopt].box);
+			nodeA.height     = 1 + std::max(nodes[down].height, nodes[adopt].height);
+			nodes[up].box    = combine(nodeA.box, nodes[keep].box);
+			nodes[up].height = 1 + std::max(nodeA.height, nodes[keep].height);
+			return up;
+		}
+		return a;
+	}
+};        // namespace maple
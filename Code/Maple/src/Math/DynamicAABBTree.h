@@ -0,0 +1,116 @@
+//////////////////////////////////////////////////////////////////////////////
+// This file is part of the Maple Engine                              		//
+//////////////////////////////////////////////////////////////////////////////
+#pragma once
+#include "BoundingBox.h"
+#include "Engine/Core.h"
+
+#include <cstdint>
+#include <vector>
+
+namespace maple
+{
+	/**
+	 * incrementally updated bounding volume hierarchy over moving boxes.
+	 * every leaf stores a fattened copy of its box, so small motions do not touch the tree.
+	 * inserts pick the sibling with the lowest surface area cost and the tree is kept balanced with avl rotations.
+	 */
+	class MAPLE_EXPORT DynamicAABBTree
+	{
+	  public:
+		static constexpr int32_t Null = -1;
+
+		// margin is the fraction of the box size added on every side of the stored box.
+		DynamicAABBTree(float margin = 0.1f);
+
+		auto createProxy(const BoundingBox &box, uint32_t userData) -> int32_t;
+		auto destroyProxy(int32_t proxy) -> void;
+
+		/**
+		 * returns true when the leaf had to be re-inserted, a box still inside its fat box is left alone.
+		 */
+		auto moveProxy(int32_t proxy, const BoundingBox &box) -> bool;
+
+		inline auto getUserData(int32_t proxy) const
+		{
+			return nodes[proxy].userData;
+		}
+
+		inline auto &getFatBox(int32_t proxy) const
+		{
+			return nodes[proxy].box;
+		}
+
+		inline auto getProxyCount() const
+		{
+			return proxyCount;
+		}
+
+		inline auto getHeight() const
+		{
+			return root == Null ? 0 : nodes[root].height;
+		}
+
+		/**
+		 * calls callback(proxy) for every leaf whose fat box overlaps box, a false return ends the query.
+		 */
+		template <typename Callback>
+		inline auto query(const BoundingBox &box, Callback &&callback) const -> void
+		{
+			if (root == Null)
+				return;
+
+			std::vector<int32_t> stack;
+			stack.reserve(64);
+			stack.emplace_back(root);
+			while (!stack.empty())
+			{
+				const auto  id   = stack.back();
+				const auto &node = nodes[id];
+				stack.pop_back();
+				if (!node.box.intersects(box))
+					continue;
+
+				if (node.isLeaf())
+				{
+					if (!callback(id))
+						return;
+				}
+				else
+				{
+					stack.emplace_back(node.child1);
+					stack.emplace_back(node.child2);
+				}
+			}
+		}
+
+	  private:
+		struct Node
+		{
+			BoundingBox box;
+			int32_t     parent   = Null;        // next free node while unused
+			int32_t     child1   = Null;
+			int32_t     child2   = Null;
+			int32_t     height   = -1;          // leaf = 0, free = -1
+			uint32_t    userData = 0;
+
+			inline auto isLeaf() const
+			{
+				return child1 == Null;
+			}
+		};
+
+		auto allocateNode() -> int32_t;
+		auto freeNode(int32_t node) -> void;
+		auto insertLeaf(int32_t leaf) -> void;
+		auto removeLeaf(int32_t leaf) -> void;
+		auto balance(int32_t node) -> int32_t;
+		auto fatten(const BoundingBox &box) const -> BoundingBox;
+
+		std::vector<Node> nodes;
+		int32_t           root       = Null;
+		int32_t           freeList   = Null;
+		uint32_t          proxyCount = 0;
+		float             margin;
+	};
+};        // namespace maple
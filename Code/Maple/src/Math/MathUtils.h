@@ -12,9 +12,12 @@
 
 #ifndef M_PI
 #	define M_PI 3.14159265358979323846            // pi
-#	define M_PI_TWO 6.28318530717958647692        // pi
 #endif                                             // !M_PI
 
+#ifndef M_PI_TWO
+#	define M_PI_TWO 6.28318530717958647692        // 2 pi
+#endif                                             // !M_PI_TWO
+
 namespace maple
 {
 	namespace math
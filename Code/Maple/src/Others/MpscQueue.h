@@ -0,0 +1,84 @@
+//////////////////////////////////////////////////////////////////////////////
+// This file is part of the Maple Engine                              		//
+//////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+#include <atomic>
+
+namespace maple
+{
+	/**
+	 * Intrusive multi-producer single-consumer queue (Vyukov).
+	 * push is wait-free and never allocates, pop must only be called from the consumer thread.
+	 * Node needs a default constructor and a std::atomic<Node*> next member.
+	 *
+	 * the queue always keeps one node as its stub, so the node returned by pop carries the value
+	 * while the node it hands back through 'released' is the previous stub and can be recycled.
+	 */
+	template <typename Node>
+	class MpscQueue
+	{
+	  public:
+		MpscQueue() :
+		    head(&stub), tail(&stub)
+		{
+			stub.next.store(nullptr, std::memory_order_relaxed);
+		}
+
+		MpscQueue(const MpscQueue &) = delete;
+		auto operator=(const MpscQueue &) -> MpscQueue & = delete;
+
+		inline auto push(Node *node) -> void
+		{
+			node->next.store(nullptr, std::memory_order_relaxed);
+			auto prev = head.exchange(node, std::memory_order_acq_rel);
+			prev->next.store(node, std::memory_order_release);
+		}
+
+		/**
+		 * returns nullptr when the queue is empty, or when a producer is between its exchange and link;
+		 * that element shows up on the next pop. released is nullptr when it is the embedded stub.
+		 */
+		inline auto pop(Node *&released) -> Node *
+		{
+			released  = nullptr;
+			auto next = tail->next.load(std::memory_order_acquire);
+			if (next == nullptr)
+				return nullptr;
+			if (tail != &stub)
+				released = tail;
+			tail = next;
+			return next;
+		}
+
+		inline auto empty() const -> bool
+		{
+			return tail->next.load(std::memory_order_acquire) == nullptr;
+		}
+
+		/**
+		 * consumer only, once the producers are gone. hands every node to release, the unpopped ones and
+		 * the one kept as stub, then the queue is empty on its embedded stub again.
+		 */
+		template <typename Release>
+		inline auto drain(Release &&release) -> void
+		{
+			auto node = tail;
+			while (node != nullptr)
+			{
+				auto next = node->next.load(std::memory_order_acquire);
+				if (node != &stub)
+					release(node);
+				node = next;
+			}
+			stub.next.store(nullptr, std::memory_order_relaxed);
+			head.store(&stub, std::memory_order_relaxed);
+			tail = &stub;
+		}
+
+	  private:
+		alignas(64) std::atomic<Node *> head;
+		alignas(64) Node *tail;
+		Node stub;
+	};
+};        // namespace maple
@@ -156,6 +156,14 @@ namespace maple
 			MAPLE_ASSERT(false, "");
 		}
 
+		/**
+		 * uploads w * h * d tightly packed texels into mip 0 at (x, y, z).
+		 */
+		virtual auto updateRegion(const CommandBuffer *cmd, const void *buffer, uint32_t x, uint32_t y, uint32_t z, uint32_t w, uint32_t h, uint32_t d) -> void
+		{
+			MAPLE_ASSERT(false, "");
+		}
+
 		virtual auto buildTexture(TextureFormat internalformat, uint32_t width, uint32_t height, bool srgb = false, bool depth = false, bool samplerShadow = false, bool mipmap = false, bool image = false, uint32_t accessFlag = 0) -> void
 		{}
 
@@ -245,6 +245,7 @@ namespace maple
 
 		fence->reset();
 
+		std::lock_guard<std::mutex> locker(VulkanDevice::get()->getQueueMutex());
 		VK_CHECK_RESULT(vkQueueSubmit(
 		    cmdBufferType == CommandBufferType::Graphics ?
                 VulkanDevice::get()->getGraphicsQueue() :
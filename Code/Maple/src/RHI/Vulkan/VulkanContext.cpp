@@ -283,6 +283,7 @@ namespace maple
 
 	auto VulkanContext::waitIdle() const -> void
 	{
+		std::lock_guard<std::mutex> locker(VulkanDevice::get()->getQueueMutex());
 		vkDeviceWaitIdle(*VulkanDevice::get());
 	}
 
@@ -376,7 +377,10 @@ namespace maple
 		submitInfo.signalSemaphoreCount = 0;
 		submitInfo.waitSemaphoreCount   = 0;
 
-		VK_CHECK_RESULT(vkQueueSubmit(VulkanDevice::get()->getGraphicsQueue(), 1, &submitInfo, updateFence->getHandle()));
+		{
+			std::lock_guard<std::mutex> locker(VulkanDevice::get()->getQueueMutex());
+			VK_CHECK_RESULT(vkQueueSubmit(VulkanDevice::get()->getGraphicsQueue(), 1, &submitInfo, updateFence->getHandle()));
+		}
 		updateFence->waitAndReset();
 	}
 }        // namespace maple
@@ -10,6 +10,7 @@
 #include <TracyVulkan.hpp>
 #include <assert.h>
 #include <memory>
+#include <mutex>
 #include <string>
 #include <unordered_set>
 #include <vector>
@@ -111,6 +112,15 @@ namespace maple
 			return computeQueue;
 		}
 
+		/**
+		 * queues need external synchronization, hold this for every submit/present/wait idle
+		 * because frame submission could run on a job thread while the main thread uploads resources.
+		 */
+		inline auto &getQueueMutex()
+		{
+			return queueMutex;
+		}
+
 		inline auto getCommandPool()
 		{
 			return commandPool;
@@ -157,6 +167,8 @@ namespace maple
 		VkQueue  presentQueue;
 		VkQueue  computeQueue;
 
+		std::mutex queueMutex;
+
 		VkPhysicalDeviceFeatures enabledFeatures;
 		VkPipelineCache          pipelineCache;
 
@@ -419,7 +419,11 @@ namespace maple
 		present.pWaitSemaphores    = &getFrameData().commandBuffer->getSemaphore();
 		present.pResults           = VK_NULL_HANDLE;
 
-		auto error = vkQueuePresentKHR(VulkanDevice::get()->getPresentQueue(), &present);
+		VkResult error;
+		{
+			std::lock_guard<std::mutex> locker(VulkanDevice::get()->getQueueMutex());
+			error = vkQueuePresentKHR(VulkanDevice::get()->getPresentQueue(), &present);
+		}
 
 		if (error == VK_ERROR_OUT_OF_DATE_KHR)
 		{
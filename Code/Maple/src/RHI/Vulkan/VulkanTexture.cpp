@@ -1188,6 +1188,18 @@ namespace maple
 		}
 	}
 
+	auto VulkanTexture3D::updateRegion(const CommandBuffer *cmd, const void *buffer, uint32_t x, uint32_t y, uint32_t z, uint32_t w, uint32_t h, uint32_t d) -> void
+	{
+		if (buffer != nullptr)
+		{
+			auto stagingBuffer = std::make_unique<VulkanBuffer>(VK_BUFFER_USAGE_TRANSFER_SRC_BIT, w * h * d * tools::getFormatSize(parameters.format), buffer);
+			auto oldLayout     = imageLayout;
+			transitionImage(VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, static_cast<const VulkanCommandBuffer *>(cmd));
+			VulkanHelper::copyBufferToImage(stagingBuffer->getVkBuffer(), textureImage, w, h, d, x, y, z, static_cast<const VulkanCommandBuffer *>(cmd));
+			transitionImage(oldLayout, static_cast<const VulkanCommandBuffer *>(cmd));
+		}
+	}
+
 	auto VulkanTexture3D::updateMipmap(const CommandBuffer *cmd, uint32_t mipLevel, const void *buffer) -> void
 	{
 		if (buffer != nullptr)
@@ -541,6 +541,8 @@ namespace maple
 
 		auto update(const CommandBuffer *cmd, const void *buffer, uint32_t x = 0, uint32_t y = 0, uint32_t z = 0) -> void override;
 
+		auto updateRegion(const CommandBuffer *cmd, const void *buffer, uint32_t x, uint32_t y, uint32_t z, uint32_t w, uint32_t h, uint32_t d) -> void override;
+
 		virtual auto getFilePath() const -> const std::string & override
 		{
 			return filePath;
@@ -85,19 +85,6 @@ namespace maple
 			}
 		}        // namespace update_none_hierarchy
 
-		namespace reset_update
-		{
-			inline auto system(ioc::Registry registry, global::component::SceneTransformChanged& sceneChanged)
-			{
-				for (auto [entity, transform] : registry.getRegistry().view<maple::component::Transform>().each())
-				{
-					transform.setHasUpdated(false);
-					sceneChanged.dirty = false;
-					sceneChanged.entities.clear();
-				}
-			}
-		}        // namespace reset_update
-
 		//delegate method
 		//update hierarchy components when hierarchy component is added
 		inline auto onConstruct(component::Hierarchy& hierarchy, Entity entity, ioc::Registry world) -> void
@@ -263,7 +250,6 @@ namespace maple
 
 			builder->registerSystem<update_none_hierarchy::system>();
 			builder->registerSystem<update_hierarchy::system>();
-			builder->registerSystemInFrameEnd<reset_update::system>();
 			builder->getGlobalComponent<global::component::SceneTransformChanged>();
 		}
 	}        // namespace hierarchy
@@ -9,6 +9,7 @@ struct GlobalSDFData
     float resolution;
     float nearPlane;
     float farPlane;
+    vec4 cascadeUVOffset[4];//toroidal origin of the cascade in its own uvw
 };
 
 #endif
\ No newline at end of file
@@ -9,12 +9,16 @@ struct ObjectRasterizeData
 {
 	mat4  worldToVolume;
 	mat4  volumeToWorld;
-	vec3  volumeToUVWMul;
-	float mipOffset;
+	vec3  volumeToUVWMul; // volume space to atlas page uvw
+	uint  atlasPage;
     vec3  volumeToUVWAdd;
 	float decodeMul;
 	vec3  volumeLocalBoundsExtent;
 	float decodeAdd;
+	vec3  uvwMin;         // outer texel centers of the atlas region
+	float padding0;
+	vec3  uvwMax;
+	float padding1;
 };
 
 #endif
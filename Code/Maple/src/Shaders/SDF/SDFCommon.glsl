@@ -8,6 +8,7 @@
 #define GLOBAL_SDF_WORLD_SIZE 60000.0f
 #define GLOBAL_SDF_RASTERIZE_CHUNK_SIZE 32
 #define GLOBAL_SDF_RASTERIZE_CHUNK_MARGIN 4
+#define GLOBAL_SDF_MIP_FACTOR 4
 
 #include "ObjectRasterizeData.glsl"
 #include "GlobalSDFData.glsl"
@@ -39,7 +40,8 @@ float distanceToModelSDF(float minDistance, in ObjectRasterizeData modelData, sa
 {
 	// Compute SDF volume UVs and distance in world-space to the volume bounds
 	vec3 volumePos = (modelData.worldToVolume * vec4(worldPos, 1)).xyz;
-	vec3 volumeUV = volumePos * modelData.volumeToUVWMul + modelData.volumeToUVWAdd;
+	// regions share a page with their neighbours, clamp to our own texels before filtering.
+	vec3 volumeUV = clamp(volumePos * modelData.volumeToUVWMul + modelData.volumeToUVWAdd, modelData.uvwMin, modelData.uvwMax);
 
 	vec3 volumePosClamped = clamp(volumePos, -modelData.volumeLocalBoundsExtent, modelData.volumeLocalBoundsExtent);
 	vec4 worldPosClamped = modelData.volumeToWorld * vec4(volumePosClamped,1);
@@ -51,7 +53,7 @@ float distanceToModelSDF(float minDistance, in ObjectRasterizeData modelData, sa
 
 	if (minDistance <= distanceToVolume) return distanceToVolume;
 
-	float volumeDistance = (textureLod(modelSDFTex, volumeUV, modelData.mipOffset).r * 2.f - 1.) * modelData.decodeMul;
+	float volumeDistance = (textureLod(modelSDFTex, volumeUV, 0).r * 2.f - 1.) * modelData.decodeMul;
 
 	float result = combineDistanceToSDF(volumeDistance, distanceToVolume);
 	if (distanceToVolume > 0)
@@ -61,13 +63,26 @@ float distanceToModelSDF(float minDistance, in ObjectRasterizeData modelData, sa
 	return result;
 }
 
+// cascades scroll toroidally, coord and offset are in [0, resolution).
+ivec3 wrapCascadeCoord(ivec3 coord, ivec3 offset, int resolution)
+{
+    return (coord + offset) % resolution;
+}
+
 void getGlobalSDFCascadeUV(in GlobalSDFData data, uint cascade, vec3 worldPosition, out float cascadeMaxDistance, out vec3 cascadeUV, out vec3 textureUV)
 {
     vec4 cascadePosDistance = data.cascadePosDistance[cascade];
     vec3 posInCascade = worldPosition - cascadePosDistance.xyz;
     cascadeMaxDistance = cascadePosDistance.w * 2;
-    cascadeUV = clamp( posInCascade / cascadeMaxDistance + 0.5f, vec3(0) , vec3(1) );
-    textureUV = vec3((cascade + cascadeUV.x) / float(data.cascadesCount), cascadeUV.y, cascadeUV.z);
+    float halfTexel = 0.5f / data.resolution;
+    cascadeUV = clamp( posInCascade / cascadeMaxDistance + 0.5f, vec3(halfTexel) , vec3(1 - halfTexel) );
+
+    // y and z wrap with the sampler, x has to stay inside the slice of this cascade.
+    // at the wrap seam x is snapped to the nearest mip texel instead of being filtered across it.
+    vec3 wrappedUV = fract(cascadeUV + data.cascadeUVOffset[cascade].xyz);
+    float seam = halfTexel * GLOBAL_SDF_MIP_FACTOR;
+    wrappedUV.x = clamp(wrappedUV.x, seam, 1 - seam);
+    textureUV = vec3((cascade + wrappedUV.x) / float(data.cascadesCount), wrappedUV.y, wrappedUV.z);
 }
 
 bool isHit(in GlobalSDFHit hit)
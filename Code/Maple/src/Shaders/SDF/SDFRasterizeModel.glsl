@@ -19,8 +19,8 @@ layout(set = 0, binding = 0) uniform ModelsRasterizeData
 	float maxDistance;
 	vec3  cascadeCoordToPosAdd;
 	int   cascadeResolution;
+	ivec3 cascadeTexelOffset;
 	int   cascadeIndex;
-	vec3  padding;
 }ubo;
 
 layout(set = 0, binding = 1, std430) readonly buffer SDFObjectData{
@@ -29,7 +29,7 @@ layout(set = 0, binding = 1, std430) readonly buffer SDFObjectData{
 
 layout(set = 0, binding = 2,r16f) uniform image3D uGlobalSDF;
 
-layout(set = 0, binding = 3) uniform sampler3D uMeshSDF[];
+layout(set = 0, binding = 3) uniform sampler3D uMeshSDF[]; // MeshSDFAtlas pages
 
 layout(push_constant) uniform PushConsts
 {
@@ -44,6 +44,7 @@ void main()
     ivec3 uvw = ivec3(gl_GlobalInvocationID.xyz);
 	ivec3 voxelCoord = pushConsts.chunkCoord + uvw;//from every chunk..
 	vec3 voxelWorldPos = voxelCoord * ubo.cascadeCoordToPosMul + ubo.cascadeCoordToPosAdd;
+	voxelCoord = wrapCascadeCoord(voxelCoord, ubo.cascadeTexelOffset, ubo.cascadeResolution);
 	voxelCoord.x += ubo.cascadeIndex *  ubo.cascadeResolution;//
 	float minDistance =  ubo.maxDistance;
 
@@ -55,7 +56,7 @@ void main()
 	{
 		uint objId = pushConsts.objects[i];
 		ObjectRasterizeData objectData = data[objId];
-		float objectDistance = distanceToModelSDF(minDistance, objectData, uMeshSDF[objId], voxelWorldPos);
+		float objectDistance = distanceToModelSDF(minDistance, objectData, uMeshSDF[objectData.atlasPage], voxelWorldPos);
 		minDistance = min(minDistance, objectDistance);
 	}
  	vec4 v = vec4( clamp(minDistance / ubo.maxDistance, -1, 1));
@@ -0,0 +1,124 @@
+//////////////////////////////////////////////////////////////////////////////
+// This file is part of the Maple Engine                              		//
+//////////////////////////////////////////////////////////////////////////////
+#include "Others/MpscQueue.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+/**
+ * MpscQueueStress [--producers n] [--items n]
+ * several threads push numbered nodes while one thread pops them. every item has to arrive exactly once,
+ * in push order per producer, and every node except the last stub has to come back through 'released'.
+ */
+namespace
+{
+	using namespace maple;
+
+	struct Node
+	{
+		std::atomic<Node *> next{nullptr};
+		uint32_t            producer = 0;
+		uint32_t            sequence = 0;
+		bool                released = false;
+	};
+
+	auto fail(const char *message, uint32_t producer, uint32_t sequence) -> int32_t
+	{
+		fprintf(stderr, "FAILED: %s (producer %u, item %u)\n", message, producer, sequence);
+		return EXIT_FAILURE;
+	}
+}        // namespace
+
+auto main(int32_t argc, char **argv) -> int32_t
+{
+	uint32_t producers = std::max(4u, std::thread::hardware_concurrency());
+	uint32_t items     = 200000;
+	for (int32_t i = 1; i + 1 < argc; i += 2)
+	{
+		if (std::string_view(argv[i]) == "--producers")
+			producers = std::max(1, atoi(argv[i + 1]));
+		else if (std::string_view(argv[i]) == "--items")
+			items = std::max(1, atoi(argv[i + 1]));
+	}
+
+	std::vector<std::vector<Node>> nodes(producers);
+	for (uint32_t p = 0; p < producers; p++)
+	{
+		nodes[p] = std::vector<Node>(items);
+		for (uint32_t i = 0; i < items; i++)
+		{
+			nodes[p][i].producer = p;
+			nodes[p][i].sequence = i;
+		}
+	}
+
+	MpscQueue<Node>          queue;
+	std::atomic<uint32_t>    ready{0};
+	std::vector<std::thread> threads;
+	for (uint32_t p = 0; p < producers; p++)
+	{
+		threads.emplace_back([&, p]() {
+			//start together so the pushes actually contend on head.
+			ready.fetch_add(1);
+			while (ready.load() < producers)
+				std::this_thread::yield();
+			for (auto &node : nodes[p])
+				queue.push(&node);
+		});
+	}
+
+	std::vector<uint32_t> expected(producers, 0);
+	const uint64_t        total    = uint64_t(producers) * items;
+	uint64_t              popped   = 0;
+	uint64_t              released = 0;
+	Node *                previous = nullptr;
+	while (popped < total)
+	{
+		Node *recycled = nullptr;
+		auto  node     = queue.pop(recycled);
+		if (recycled != nullptr)
+		{
+			//only the node returned by the previous pop can be handed back.
+			if (recycled != previous || recycled->released)
+				return fail("released a node that is not the previous stub", recycled->producer, recycled->sequence);
+			recycled->released = true;
+			released++;
+		}
+		if (node == nullptr)
+		{
+			//empty, or a producer is between its exchange and link.
+			std::this_thread::yield();
+			continue;
+		}
+		if (node->sequence != expected[node->producer])
+			return fail("out of order", node->producer, node->sequence);
+		expected[node->producer]++;
+		previous = node;
+		popped++;
+	}
+
+	for (auto &thread : threads)
+		thread.join();
+
+	Node *recycled = nullptr;
+	if (queue.pop(recycled) != nullptr || !queue.empty())
+		return fail("queue not empty after every item arrived", 0, 0);
+
+	//the last node stays in the queue as stub.
+	if (released != total - 1)
+		return fail("not every node came back through released", 0, uint32_t(released));
+
+	std::vector<Node *> drained;
+	queue.drain([&](Node *node) { drained.emplace_back(node); });
+	if (drained.size() != 1 || drained[0] != previous || !queue.empty())
+		return fail("drain did not hand back the stub", 0, 0);
+
+	printf("%u producers x %u items passed\n", producers, items);
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,141 @@
+//////////////////////////////////////////////////////////////////////////////
+// This file is part of the Maple Engine                              		//
+//////////////////////////////////////////////////////////////////////////////
+#include "Engine/DDGI/SDFAtlasAllocator.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+/**
+ * SDFAtlasAllocator
+ * allocates and frees fields of random sizes the way the atlas does while streaming, and mirrors every allocation
+ * in a block grid per page. allocations have to stay inside their page and never overlap, the counters have to
+ * follow them, and freeing everything has to leave the allocator empty.
+ */
+namespace
+{
+	using namespace maple;
+	using sdf::atlas::AtlasAllocator;
+	using sdf::atlas::Allocation;
+	using sdf::atlas::BlockSize;
+
+	constexpr uint32_t Page     = 64;
+	constexpr uint32_t MaxPages = 3;
+
+	// the reference : which allocation covers each block, -1 when none.
+	struct Occupancy
+	{
+		static constexpr uint32_t Blocks = Page / BlockSize;
+		std::vector<int32_t>      owners = std::vector<int32_t>(MaxPages * Blocks * Blocks * Blocks, -1);
+
+		template <typename Callback>
+		auto forEach(const Allocation &allocation, Callback &&callback)
+		{
+			const auto begin = allocation.offset / BlockSize;
+			const auto end   = (allocation.offset + allocation.size + BlockSize - 1u) / BlockSize;
+			for (uint32_t z = begin.z; z < end.z; z++)
+				for (uint32_t y = begin.y; y < end.y; y++)
+					for (uint32_t x = begin.x; x < end.x; x++)
+						callback(owners[((allocation.page * Blocks + z) * Blocks + y) * Blocks + x]);
+		}
+	};
+}        // namespace
+
+auto main() -> int32_t
+{
+	AtlasAllocator allocator(glm::uvec3(Page), MaxPages);
+	Occupancy      occupancy;
+
+	std::mt19937                            random(5);
+	std::uniform_int_distribution<uint32_t> size(1, Page / 2);
+
+	std::vector<Allocation> live;
+	std::vector<int32_t>    ids;
+	int32_t                 nextId = 0, failures = 0;
+	uint32_t                allocated = 0, full = 0;
+
+	for (uint32_t step = 0; step < 20000; step++)
+	{
+		// grows while mostly allocating, then shrinks, so the pages fill up and fragment.
+		const bool grow = (step / 2000) % 2 == 0 ? random() % 4 != 0 : random() % 4 == 0;
+		if (grow || live.empty())
+		{
+			const glm::uvec3 extent(size(random), size(random), size(random));
+			Allocation       allocation;
+			if (!allocator.allocate(extent, allocation))
+			{
+				full++;
+				continue;
+			}
+			allocated++;
+
+			if (allocation.page >= MaxPages || allocation.size != extent || glm::any(glm::notEqual(allocation.offset % BlockSize, glm::uvec3(0))) ||
+			    glm::any(glm::greaterThan(allocation.offset + allocation.size, glm::uvec3(Page))))
+			{
+				printf("step %u : allocation of %u %u %u placed outside its page\n", step, extent.x, extent.y, extent.z);
+				failures++;
+				continue;
+			}
+
+			const int32_t id = nextId++;
+			occupancy.forEach(allocation, [&](int32_t &owner) {
+				if (owner >= 0)
+					failures++;
+				owner = id;
+			});
+			live.push_back(allocation);
+			ids.push_back(id);
+		}
+		else
+		{
+			const auto index = random() % live.size();
+			occupancy.forEach(live[index], [&](int32_t &owner) {
+				if (owner != ids[index])
+					failures++;
+				owner = -1;
+			});
+			allocator.free(live[index]);
+			live[index] = live.back();
+			ids[index]  = ids.back();
+			live.pop_back();
+			ids.pop_back();
+		}
+
+		if (allocator.getAllocationCount() != live.size())
+		{
+			printf("step %u : %u allocations counted, %zu live\n", step, allocator.getAllocationCount(), live.size());
+			failures++;
+		}
+	}
+
+	uint64_t usedBlocks = 0;
+	for (auto owner : occupancy.owners)
+		usedBlocks += owner >= 0;
+	if (allocator.getUsedTexels() != usedBlocks * BlockSize * BlockSize * BlockSize)
+	{
+		printf("%llu texels counted as used, %llu covered\n", (unsigned long long) allocator.getUsedTexels(), (unsigned long long) (usedBlocks * BlockSize * BlockSize * BlockSize));
+		failures++;
+	}
+
+	for (const auto &allocation : live)
+		allocator.free(allocation);
+
+	// nothing left, so a whole page fits in every page again.
+	Allocation whole;
+	uint32_t   wholePages = 0;
+	while (allocator.allocate(glm::uvec3(Page), whole))
+		wholePages++;
+	if (allocator.getUsedTexels() != uint64_t(wholePages) * Page * Page * Page || wholePages != MaxPages || allocator.getPageCount() != MaxPages)
+	{
+		printf("after freeing everything %u whole pages fit, %u expected\n", wholePages, MaxPages);
+		failures++;
+	}
+
+	printf("%u allocations, %u refused as full, %d failures\n", allocated, full, failures);
+	if (allocated == 0 || full == 0)
+		failures++;
+	printf(failures == 0 ? "atlas allocations never overlapped\n" : "atlas allocator is broken\n");
+	return failures == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
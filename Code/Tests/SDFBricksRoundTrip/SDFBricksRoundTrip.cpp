@@ -0,0 +1,192 @@
+//////////////////////////////////////////////////////////////////////////////
+// This file is part of the Maple Engine                              		//
+//////////////////////////////////////////////////////////////////////////////
+#include "Engine/DDGI/SDFBricks.h"
+#include "Engine/DDGI/SDFContainer.h"
+
+#include <glm/gtc/packing.hpp>
+
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <random>
+#include <string>
+#include <vector>
+
+/**
+ * SDFBricksRoundTrip
+ * encodes a dense field into bricks and checks fetch, sample and the container decode against it :
+ * voxels of stored bricks come back exactly, empty bricks give +-band with the right sign and never overestimate.
+ */
+namespace
+{
+	using namespace maple::sdf;
+
+	// not a multiple of the brick size, so the border bricks are partial.
+	const glm::uvec3 Resolution(37, 29, 21);
+	constexpr float  Band = 0.1f;
+
+	inline auto flatten(const glm::uvec3 &voxel)
+	{
+		return voxel.x + (voxel.y + voxel.z * Resolution.y) * Resolution.x;
+	}
+
+	inline auto decode(uint16_t value)
+	{
+		return glm::unpackHalf1x16(value) * 2.f - 1.f;
+	}
+
+	// trilinear lookup of the dense field, clamped like the texture.
+	auto sampleDense(const std::vector<uint16_t> &dense, const glm::vec3 &uvw)
+	{
+		const glm::vec3 position = uvw * glm::vec3(Resolution) - 0.5f;
+		const glm::vec3 base     = glm::floor(position);
+		const glm::vec3 t        = position - base;
+
+		float corners[8];
+		for (uint32_t i = 0; i < 8; i++)
+		{
+			const auto voxel = glm::clamp(glm::ivec3(base) + glm::ivec3(i & 1, (i >> 1) & 1, i >> 2), glm::ivec3(0), glm::ivec3(Resolution) - 1);
+			corners[i]       = decode(dense[flatten(glm::uvec3(voxel))]);
+		}
+		const float c00 = glm::mix(corners[0], corners[1], t.x);
+		const float c10 = glm::mix(corners[2], corners[3], t.x);
+		const float c01 = glm::mix(corners[4], corners[5], t.x);
+		const float c11 = glm::mix(corners[6], corners[7], t.x);
+		return glm::mix(glm::mix(c00, c10, t.y), glm::mix(c01, c11, t.y), t.z);
+	}
+
+	auto fail(const char *message, const glm::uvec3 &voxel) -> int32_t
+	{
+		fprintf(stderr, "FAILED: %s at %u %u %u\n", message, voxel.x, voxel.y, voxel.z);
+		return EXIT_FAILURE;
+	}
+}        // namespace
+
+auto main() -> int32_t
+{
+	// two spheres, normalized by the largest extent like the baker does.
+	std::vector<uint16_t> dense(size_t(Resolution.x) * Resolution.y * Resolution.z);
+	for (uint32_t z = 0; z < Resolution.z; z++)
+	{
+		for (uint32_t y = 0; y < Resolution.y; y++)
+		{
+			for (uint32_t x = 0; x < Resolution.x; x++)
+			{
+				const glm::vec3 position(x, y, z);
+				const float     distance = std::min(glm::distance(position, glm::vec3(10, 12, 9)) - 6.f, glm::distance(position, glm::vec3(27, 15, 12)) - 4.f) / 37.f;
+				dense[flatten({x, y, z})] = glm::packHalf1x16((distance + 1.f) / 2.f);
+			}
+		}
+	}
+
+	const auto volume = bricks::encode(dense.data(), Resolution, Band);
+	if (volume.getBrickSlots() == 0 || volume.getBrickSlots() == volume.indirection.size())
+	{
+		fprintf(stderr, "FAILED: expected both stored and empty bricks, got %u of %zu\n", volume.getBrickSlots(), volume.indirection.size());
+		return EXIT_FAILURE;
+	}
+
+	for (uint32_t z = 0; z < Resolution.z; z++)
+	{
+		for (uint32_t y = 0; y < Resolution.y; y++)
+		{
+			for (uint32_t x = 0; x < Resolution.x; x++)
+			{
+				const glm::uvec3 voxel(x, y, z);
+				const auto       brick    = voxel / bricks::BrickSize;
+				const auto       slot     = volume.indirection[brick.x + (brick.y + brick.z * volume.brickCount.y) * volume.brickCount.x];
+				const float      expected = decode(dense[flatten(voxel)]);
+				const float      fetched  = bricks::fetch(volume, glm::ivec3(voxel));
+
+				if (slot != bricks::EmptyInside && slot != bricks::EmptyOutside)
+				{
+					if (fetched != expected)
+						return fail("stored voxel does not round trip", voxel);
+				}
+				else if (std::abs(fetched) != Band || (fetched < 0) != (expected < 0) || std::abs(expected) < Band)
+				{
+					return fail("empty brick is not a conservative +-band", voxel);
+				}
+			}
+		}
+	}
+
+	// where every corner of the cell is stored, sample has to match the dense lookup.
+	std::mt19937                          random(7);
+	std::uniform_real_distribution<float> uniform(0.f, 1.f);
+	uint32_t                              compared = 0;
+	for (uint32_t i = 0; i < 100000; i++)
+	{
+		const glm::vec3 uvw(uniform(random), uniform(random), uniform(random));
+		const float     expected = sampleDense(dense, uvw);
+		const float     sampled  = bricks::sample(volume, uvw);
+		if (std::abs(expected) < Band * 0.5f)
+		{
+			compared++;
+			if (std::abs(sampled - expected) > 1e-5f)
+				return fail("sample differs from the dense field near the surface", glm::uvec3(uvw * glm::vec3(Resolution)));
+		}
+		else if ((sampled < 0) != (expected < 0) && std::abs(expected) > Band)
+		{
+			return fail("sample has the wrong sign away from the surface", glm::uvec3(uvw * glm::vec3(Resolution)));
+		}
+	}
+
+	// the container stores the bricks instead of mip0 and decodes them back.
+	std::error_code error;
+	const auto      path = (std::filesystem::temp_directory_path(error) / "MapleSDFBricksRoundTrip.sdf").string();
+
+	container::Header header{};
+	header.format      = container::Format::R16Float;
+	header.width       = Resolution.x;
+	header.height      = Resolution.y;
+	header.depth       = Resolution.z;
+	header.aabbMin     = glm::vec3(0.f);
+	header.aabbMax     = glm::vec3(Resolution);
+	header.maxDistance = 37.f;
+
+	std::vector<uint8_t> mip0(dense.size() * sizeof(uint16_t));
+	memcpy(mip0.data(), dense.data(), mip0.size());
+	if (!container::write(path, header, {mip0}, &volume))
+		return fail("could not write the container", {});
+
+	int32_t exitCode = EXIT_SUCCESS;
+	{
+		container::MappedFile file;
+		std::string           reason;
+		if (!file.open(path, reason))
+		{
+			fprintf(stderr, "FAILED: %s\n", reason.c_str());
+			exitCode = EXIT_FAILURE;
+		}
+		else if (file.getHeader().mips[0].size != 0 || file.getMipBytes(0) != mip0.size())
+		{
+			fprintf(stderr, "FAILED: mip0 is stored densely next to the bricks\n");
+			exitCode = EXIT_FAILURE;
+		}
+		else
+		{
+			// stored voxels keep their bits, empty bricks are +-band in the file encoding.
+			std::vector<uint8_t> decoded;
+			const auto *         texels = file.getMip(0, decoded);
+			for (uint32_t i = 0; i < dense.size() && exitCode == EXIT_SUCCESS; i++)
+			{
+				uint16_t half;
+				memcpy(&half, texels + i * sizeof(uint16_t), sizeof(uint16_t));
+				const glm::uvec3 voxel(i % Resolution.x, i / Resolution.x % Resolution.y, i / (Resolution.x * Resolution.y));
+				const float      fetched  = bricks::fetch(volume, glm::ivec3(voxel));
+				const uint16_t   expected = std::abs(fetched) == Band && fetched != decode(dense[i]) ? glm::packHalf1x16((fetched + 1.f) / 2.f) : dense[i];
+				if (half != expected)
+					exitCode = fail("decoded mip0 differs from fetch", voxel);
+			}
+		}
+	}
+	std::filesystem::remove(path, error);
+
+	if (exitCode == EXIT_SUCCESS)
+		printf("%u of %zu bricks stored, %u samples near the surface matched\n", volume.getBrickSlots(), volume.indirection.size(), compared);
+	return exitCode;
+}
@@ -0,0 +1,184 @@
+//////////////////////////////////////////////////////////////////////////////
+// This file is part of the Maple Engine                              		//
+//////////////////////////////////////////////////////////////////////////////
+#include "Engine/DDGI/SDFCascadeScheduler.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <limits>
+#include <vector>
+
+/**
+ * SDFCascadeSchedule
+ * drives the cascade scheduler through a scripted flight : a calm start, a fast camera over a busy scene and
+ * a teleport that resets every cascade. the simulated cascades rasterize what they are given and keep the rest.
+ * checks that the estimated frame cost stays in the budget unless an update was forced, that no cascade waits
+ * longer than its maxStaleFrames {2, 3, 5, 11}, and that the same script gives the same schedule twice.
+ */
+namespace
+{
+	using namespace maple;
+
+	constexpr uint32_t Cascades = 4;
+	constexpr uint32_t Frames   = 600;
+	constexpr uint32_t Slab     = 36;        // chunks entering a 6^3 cascade when it scrolls by one chunk
+
+	// same chunk sizes as the cascades of the global sdf.
+	const float CascadeScales[Cascades] = {1.0f, 2.5f, 5.0f, 10.0f};
+
+	// an lcg rather than <random>, the distributions differ between standard libraries.
+	struct Random
+	{
+		uint32_t state;
+
+		auto next(uint32_t range)
+		{
+			state = state * 1664525u + 1013904223u;
+			return (state >> 8) % range;
+		}
+	};
+
+	struct Result
+	{
+		uint64_t                  hash = 14695981039346656037ull;        // of every schedule and chunk budget
+		sdf::scheduler::Stats     stats;
+		uint32_t                  failures = 0;
+		uint32_t                  oldestWork[Cascades] = {};
+
+		auto mix(uint32_t value)
+		{
+			hash = (hash ^ value) * 1099511628211ull;
+		}
+	};
+
+	auto simulate(bool verbose) -> Result
+	{
+		sdf::scheduler::CascadeScheduler scheduler;
+		Result                           result;
+		Random                           random{11};
+
+		uint32_t pending[Cascades]  = {};        // chunks still to rasterize
+		uint32_t entering[Cascades] = {};        // of them scrolled in, reported once
+		uint32_t age[Cascades]      = {};        // frames the oldest pending chunk has waited
+		bool     reset              = true;
+		float    camera             = 0;
+
+		std::vector<sdf::scheduler::CascadeRequest> requests(Cascades);
+		for (uint32_t frame = 0; frame < Frames; frame++)
+		{
+			// calm, then a fast camera over moving objects, a teleport, and calm again.
+			const bool busy  = frame >= 150 && frame < 450;
+			const float speed = busy ? 0.35f : 0.02f;
+			if (frame == 300)
+				reset = true;
+
+			const float previous = camera;
+			camera += speed;
+			for (uint32_t i = 0; i < Cascades; i++)
+			{
+				const auto crossed = uint32_t(camera / CascadeScales[i]) - uint32_t(previous / CascadeScales[i]);
+				const auto dirty   = busy ? random.next(24) : random.next(8) == 0;
+				entering[i] += crossed * Slab;
+				pending[i] += crossed * Slab + dirty;
+				if (reset)
+					pending[i] = std::max(pending[i], Slab * 6);
+
+				requests[i].forced         = reset;
+				requests[i].enteringChunks = entering[i];
+				requests[i].dirtyChunks    = pending[i] - entering[i];
+				if (pending[i] > 0)
+					age[i]++;
+				entering[i] = 0;
+			}
+			reset = false;
+
+			float spent = 0, forcedCost = 0;
+			for (auto cascade : scheduler.schedule(requests))
+			{
+				const auto budget = scheduler.getChunkBudget(cascade);
+				result.mix(cascade);
+				result.mix(budget);
+				if (budget == 0)
+					continue;
+
+				const auto rasterized = std::min(budget, pending[cascade]);
+				const auto deferred   = pending[cascade] - rasterized;
+				scheduler.complete(cascade, rasterized, deferred);
+				spent += scheduler.getCost(rasterized);
+				if (budget == std::numeric_limits<uint32_t>::max())
+					forcedCost += scheduler.getCost(rasterized);
+
+				pending[cascade] = deferred;
+				if (deferred == 0)
+					age[cascade] = 0;
+			}
+
+			// only forced updates may go past the budget, whatever else ran had to fit in what they left.
+			if (spent > std::max(scheduler.budgetMs, forcedCost) + 1e-4f)
+			{
+				printf("frame %u : %.3f ms spent, %.3f ms budget, %.3f ms forced\n", frame, spent, scheduler.budgetMs, forcedCost);
+				result.failures++;
+			}
+
+			for (uint32_t i = 0; i < Cascades; i++)
+			{
+				result.oldestWork[i] = std::max(result.oldestWork[i], age[i]);
+				if (age[i] >= scheduler.maxStaleFrames[i])
+				{
+					printf("frame %u : cascade %u has waited %u frames, at most %u are allowed\n", frame, i, age[i], scheduler.maxStaleFrames[i]);
+					result.failures++;
+				}
+			}
+		}
+
+		result.stats = scheduler.getStats();
+		if (verbose)
+		{
+			printf("%u frames, %u over budget\n", result.stats.frames, result.stats.overBudgetFrames);
+			for (uint32_t i = 0; i < Cascades; i++)
+			{
+				const auto &cascade = result.stats.cascades[i];
+				printf("cascade %u : %u updates, %u partial, %u forced, stale at most %u of %u frames\n", i, cascade.updates,
+				       cascade.partialUpdates, cascade.forcedUpdates, cascade.maxStaleFrames, scheduler.maxStaleFrames[i]);
+			}
+		}
+		return result;
+	}
+}        // namespace
+
+auto main() -> int32_t
+{
+	const auto first  = simulate(true);
+	const auto second = simulate(false);
+
+	int32_t exitCode = first.failures == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+	if (first.hash != second.hash)
+	{
+		printf("the same frames were scheduled differently\n");
+		exitCode = EXIT_FAILURE;
+	}
+
+	const sdf::scheduler::CascadeScheduler defaults;
+	uint32_t partial = 0, forced = 0;
+	for (uint32_t i = 0; i < Cascades; i++)
+	{
+		const auto &cascade = first.stats.cascades[i];
+		partial += cascade.partialUpdates;
+		forced += cascade.forcedUpdates;
+
+		// the scheduler counts the frame it finishes the work in, the simulation only the ones it still waits after.
+		if (cascade.maxStaleFrames > defaults.maxStaleFrames[i] || first.oldestWork[i] >= defaults.maxStaleFrames[i])
+			exitCode = EXIT_FAILURE;
+	}
+
+	// the busy part has to defer chunks and force stale cascades, the teleport runs past the budget.
+	if (partial == 0 || forced <= Cascades || first.stats.overBudgetFrames == 0 || first.stats.overBudgetFrames >= first.stats.frames / 2)
+	{
+		printf("%u partial updates, %u forced, %u frames over budget, the script did not stress the budget\n", partial, forced, first.stats.overBudgetFrames);
+		exitCode = EXIT_FAILURE;
+	}
+
+	printf(exitCode == EXIT_SUCCESS ? "cascade schedule kept the budget and the staleness limits\n" : "cascade schedule broke the budget or the staleness limits\n");
+	return exitCode;
+}
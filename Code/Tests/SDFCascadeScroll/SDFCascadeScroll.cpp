@@ -0,0 +1,211 @@
+//////////////////////////////////////////////////////////////////////////////
+// This file is part of the Maple Engine                              		//
+//////////////////////////////////////////////////////////////////////////////
+#include "Engine/DDGI/SDFChunks.h"
+#include "Math/BoundingSphere.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+/**
+ * SDFCascadeScroll
+ * flies a cascade through a field of objects, some of them moving, and replays its dispatches on a cpu copy of the
+ * toroidal texture where every chunk slot holds the objects rasterized into it. after each frame the scrolled texture
+ * has to hold exactly what a cascade built from scratch at the same place holds.
+ */
+namespace
+{
+	using namespace maple;
+
+	constexpr int32_t ChunksPerAxis = 4;
+	constexpr float   VoxelSize     = 1.f;
+	constexpr float   ChunkExtent   = VoxelSize * sdf::chunks::ChunkSize;
+
+	struct Object
+	{
+		uint32_t    id;
+		BoundingBox bounds;
+	};
+
+	// the cpu stand in for the cascade texture, the objects of every chunk slot.
+	using Texture = std::vector<std::vector<uint32_t>>;
+
+	struct Cascade
+	{
+		sdf::chunks::CascadeData                cascade;
+		sdf::chunks::ChunkGrid                  chunks;
+		std::vector<sdf::chunks::ChunkDispatch> dispatches;
+		Texture                                 texture = Texture(ChunksPerAxis * ChunksPerAxis * ChunksPerAxis);
+		uint32_t                                rasterized = 0;
+
+		auto slot(const glm::ivec3 &coord) -> std::vector<uint32_t> &
+		{
+			const auto wrapped = sdf::chunks::wrapChunk(cascade.minChunk + coord, ChunksPerAxis);
+			return texture[sdf::chunks::flatten(wrapped, glm::ivec3(ChunksPerAxis))];
+		}
+
+		auto update(const std::vector<Object> &objects, const glm::ivec3 &minChunk, bool reset, uint32_t budget) -> uint32_t
+		{
+			if (reset)
+				sdf::chunks::resetCascade(cascade, minChunk, ChunksPerAxis);
+			else
+				sdf::chunks::scrollCascade(cascade, minChunk, ChunksPerAxis);
+
+			const auto center = glm::vec3(minChunk + ChunksPerAxis / 2) * ChunkExtent;
+			const auto extent = ChunksPerAxis * ChunkExtent / 2;
+			cascade.position  = center;
+			cascade.voxelSize = VoxelSize;
+			cascade.bounds    = {center - extent, center + extent};
+
+			chunks.reset(ChunksPerAxis, minChunk);
+			for (const auto &object : objects)
+			{
+				const BoundingSphere sphere = object.bounds;
+				if (cascade.bounds.intersectsWithSphere(sphere))
+					sdf::chunks::addObjectToChunks(chunks, VoxelSize, cascade.bounds, object.bounds, object.id);
+			}
+
+			const auto deferred = sdf::chunks::planChunkDispatches(cascade, chunks, ChunksPerAxis, budget, dispatches);
+			for (const auto &dispatch : dispatches)
+			{
+				auto &models = slot(dispatch.coord);
+				if (dispatch.type != sdf::chunks::ChunkDispatch::Type::RasterizeAdditive)
+					models.clear();
+				if (dispatch.type != sdf::chunks::ChunkDispatch::Type::Clear)
+				{
+					models.insert(models.end(), dispatch.chunk->models, dispatch.chunk->models + dispatch.chunk->modelsCount);
+					std::sort(models.begin(), models.end());
+					rasterized++;
+				}
+			}
+			return deferred;
+		}
+	};
+
+	// the chunks that differ between the scrolled cascade and one built from scratch at the same place.
+	auto compare(Cascade &scrolled, const std::vector<Object> &objects) -> uint32_t
+	{
+		Cascade fresh;
+		fresh.update(objects, scrolled.cascade.minChunk, true, UINT32_MAX);
+
+		uint32_t mismatches = 0;
+		for (int32_t z = 0; z < ChunksPerAxis; z++)
+		{
+			for (int32_t y = 0; y < ChunksPerAxis; y++)
+			{
+				for (int32_t x = 0; x < ChunksPerAxis; x++)
+				{
+					if (scrolled.slot({x, y, z}) != fresh.slot({x, y, z}))
+						mismatches++;
+				}
+			}
+		}
+		return mismatches;
+	}
+
+	auto move(std::vector<Object> &objects, std::vector<sdf::chunks::CascadeData> &cascades, std::mt19937 &random) -> void
+	{
+		std::uniform_real_distribution<float> step(-12.f, 12.f);
+		for (int32_t i = 0; i < 8; i++)
+		{
+			auto &object = objects[random() % objects.size()];
+			sdf::chunks::invalidateChunks(cascades, object.bounds);
+			const glm::vec3 offset(step(random), step(random), step(random));
+			object.bounds = {object.bounds.min + offset, object.bounds.max + offset};
+			sdf::chunks::invalidateChunks(cascades, object.bounds);
+		}
+	}
+}        // namespace
+
+auto main() -> int32_t
+{
+	std::mt19937                          random(7);
+	std::uniform_real_distribution<float> position(-160.f, 160.f);
+	std::uniform_real_distribution<float> size(1.f, 12.f);
+
+	std::vector<Object> objects;
+	for (uint32_t i = 0; i < 1500; i++)
+	{
+		const glm::vec3 center(position(random), position(random), position(random));
+		const glm::vec3 extent(size(random), size(random), size(random));
+		objects.push_back({i, {center - extent * 0.5f, center + extent * 0.5f}});
+	}
+	// a cluster that spills into overflow layers, and walls reaching past the cascade into its border chunks.
+	for (uint32_t i = 0; i < 70; i++)
+		objects.push_back({uint32_t(objects.size()), {glm::vec3(40.f + i % 5), glm::vec3(44.f + i % 7)}});
+	objects.push_back({uint32_t(objects.size()), {glm::vec3(-300.f, -20.f, 10.f), glm::vec3(300.f, -16.f, 14.f)}});
+	objects.push_back({uint32_t(objects.size()), {glm::vec3(-50.f, -300.f, -300.f), glm::vec3(-46.f, 300.f, 300.f)}});
+
+	// single chunk steps along every axis and diagonally, and jumps farther than the cascade.
+	const glm::ivec3 path[] = {{0, 0, 0}, {1, 0, 0}, {1, 0, 0}, {0, 1, 0}, {0, 0, -1}, {1, 1, 1}, {-1, 0, 0}, {-1, -1, 0},
+	                           {0, 0, 0}, {2, 0, -1}, {0, 0, 0}, {-3, 2, 1}, {6, 0, 0}, {0, -1, 0}, {-1, 0, 1}, {0, 0, 0}};
+
+	int32_t exitCode = EXIT_SUCCESS;
+
+	// every frame fits the budget, the scrolled texture matches a fresh one after each of them.
+	{
+		Cascade    scrolled;
+		glm::ivec3 minChunk(-2);
+		uint32_t   frames = 0, freshRasterized = 0;
+		for (uint32_t pass = 0; pass < 4; pass++)
+		{
+			for (const auto &step : path)
+			{
+				std::vector<sdf::chunks::CascadeData> cascades{scrolled.cascade};
+				move(objects, cascades, random);
+				scrolled.cascade.dirtyChunks = cascades[0].dirtyChunks;
+
+				minChunk += step;
+				scrolled.update(objects, minChunk, frames == 0, UINT32_MAX);
+
+				Cascade fresh;
+				fresh.update(objects, minChunk, true, UINT32_MAX);
+				freshRasterized += fresh.rasterized;
+
+				if (const auto mismatches = compare(scrolled, objects); mismatches > 0)
+				{
+					printf("frame %u at chunk (%d %d %d) : %u chunks differ from a fresh cascade\n", frames, minChunk.x, minChunk.y, minChunk.z, mismatches);
+					exitCode = EXIT_FAILURE;
+				}
+				frames++;
+			}
+		}
+		printf("%u frames scrolled, %u chunk rasterizations against %u rebuilding every frame\n", frames, scrolled.rasterized, freshRasterized);
+		if (scrolled.rasterized >= freshRasterized)
+		{
+			printf("scrolling rasterized as much as rebuilding\n");
+			exitCode = EXIT_FAILURE;
+		}
+	}
+
+	// a small budget defers chunks while the cascade moves, once it stops they are caught up.
+	{
+		Cascade    scrolled;
+		glm::ivec3 minChunk(-2);
+		uint32_t   frames = 0, deferred = 0;
+		for (const auto &step : path)
+		{
+			std::vector<sdf::chunks::CascadeData> cascades{scrolled.cascade};
+			move(objects, cascades, random);
+			scrolled.cascade.dirtyChunks = cascades[0].dirtyChunks;
+
+			minChunk += step;
+			deferred += scrolled.update(objects, minChunk, frames++ == 0, 6);
+		}
+
+		uint32_t settle = 0;
+		while (settle < 64 && scrolled.update(objects, minChunk, false, 6) > 0)
+			settle++;
+
+		const auto mismatches = compare(scrolled, objects);
+		printf("budget of 6 chunks : %u deferred while moving, settled after %u frames, %u chunks differ\n", deferred, settle, mismatches);
+		if (deferred == 0 || mismatches > 0)
+			exitCode = EXIT_FAILURE;
+	}
+
+	printf(exitCode == EXIT_SUCCESS ? "scrolled cascades match fresh ones\n" : "scrolled cascades do not match fresh ones\n");
+	return exitCode;
+}
@@ -0,0 +1,124 @@
+//////////////////////////////////////////////////////////////////////////////
+// This file is part of the Maple Engine                              		//
+//////////////////////////////////////////////////////////////////////////////
+#include "Engine/DDGI/SDFBricks.h"
+#include "Engine/DDGI/SDFContainer.h"
+
+#include <glm/gtc/packing.hpp>
+
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <iterator>
+#include <limits>
+#include <string>
+#include <vector>
+
+/**
+ * SDFContainerValidate
+ * writes a small field with bricks, then patches offsets and sizes so that offset + size wraps around.
+ * validate has to reject every patched header instead of reading past the buffer.
+ */
+namespace
+{
+	using namespace maple::sdf;
+
+	constexpr uint64_t Huge = std::numeric_limits<uint64_t>::max() - container::PayloadAlignment + 1;        // aligned, wraps when added to
+
+	auto writeSphere(const std::string &path) -> bool
+	{
+		const glm::uvec3 resolution(16);
+
+		std::vector<uint8_t> mip0(size_t(resolution.x) * resolution.y * resolution.z * sizeof(uint16_t));
+		for (uint32_t z = 0, index = 0; z < resolution.z; z++)
+		{
+			for (uint32_t y = 0; y < resolution.y; y++)
+			{
+				for (uint32_t x = 0; x < resolution.x; x++, index++)
+				{
+					const float    distance = glm::length(glm::vec3(x, y, z) / 15.f * 2.f - 1.f) - 0.6f;
+					const uint16_t half     = glm::packHalf1x16((distance / 2.f + 1.f) / 2.f);
+					memcpy(mip0.data() + index * sizeof(uint16_t), &half, sizeof(uint16_t));
+				}
+			}
+		}
+
+		container::Header header{};
+		header.format      = container::Format::R16Float;
+		header.width       = resolution.x;
+		header.height      = resolution.y;
+		header.depth       = resolution.z;
+		header.aabbMin     = glm::vec3(-1.f);
+		header.aabbMax     = glm::vec3(1.f);
+		header.maxDistance = 2.f;
+
+		const auto volume = bricks::encode(reinterpret_cast<const uint16_t *>(mip0.data()), resolution, 0.25f);
+		return container::write(path, header, {mip0}, &volume);
+	}
+}        // namespace
+
+auto main() -> int32_t
+{
+	std::error_code error;
+	const auto      path = (std::filesystem::temp_directory_path(error) / "MapleSDFContainerValidate.sdf").string();
+	if (!writeSphere(path))
+	{
+		fprintf(stderr, "FAILED: could not write %s\n", path.c_str());
+		return EXIT_FAILURE;
+	}
+
+	std::ifstream        is(path, std::ios::binary);
+	std::vector<uint8_t> file((std::istreambuf_iterator<char>(is)), std::istreambuf_iterator<char>());
+	is.close();
+	std::filesystem::remove(path, error);
+
+	std::string reason;
+	if (!container::validate(file.data(), file.size(), reason))
+	{
+		fprintf(stderr, "FAILED: the written file does not validate : %s\n", reason.c_str());
+		return EXIT_FAILURE;
+	}
+
+	container::Header original;
+	memcpy(&original, file.data(), sizeof(container::Header));
+	if (original.sparse.indirectionSize == 0)
+	{
+		fprintf(stderr, "FAILED: the sphere has no bricks\n");
+		return EXIT_FAILURE;
+	}
+
+	const std::pair<const char *, std::function<void(container::Header &)>> corruptions[] = {
+	    {"mip offset wraps", [](auto &header) { header.mips[0].offset = Huge; }},
+	    {"indirection offset wraps", [](auto &header) { header.sparse.indirectionOffset = Huge; }},
+	    {"brick offset wraps", [](auto &header) { header.sparse.brickOffset = Huge; }},
+	    {"brick size wraps", [](auto &header) { header.sparse.brickSize = Huge - Huge % (bricks::BrickVoxels * sizeof(uint16_t)); }},
+	    {"brick offset and size wrap", [](auto &header) {
+		     header.sparse.brickOffset = Huge;
+		     header.sparse.brickSize   = bricks::BrickVoxels * sizeof(uint16_t) * 2;
+	     }},
+	    {"indirection past the end", [&](auto &header) { header.sparse.indirectionOffset = file.size(); }},
+	};
+
+	int32_t exitCode = EXIT_SUCCESS;
+	for (auto &[name, corrupt] : corruptions)
+	{
+		auto header = original;
+		corrupt(header);
+		auto patched = file;
+		memcpy(patched.data(), &header, sizeof(container::Header));
+		if (container::validate(patched.data(), patched.size(), reason))
+		{
+			fprintf(stderr, "FAILED: %s passes validation\n", name);
+			exitCode = EXIT_FAILURE;
+		}
+		else
+		{
+			printf("%-28s rejected : %s\n", name, reason.c_str());
+		}
+	}
+	return exitCode;
+}
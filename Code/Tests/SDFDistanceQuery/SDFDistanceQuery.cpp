@@ -0,0 +1,270 @@
+//////////////////////////////////////////////////////////////////////////////
+// This file is part of the Maple Engine                              		//
+//////////////////////////////////////////////////////////////////////////////
+#include "Engine/DDGI/SDFContainer.h"
+#include "Engine/DDGI/SDFQuery.h"
+#include "Others/Console.h"
+
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/packing.hpp>
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <limits>
+#include <random>
+#include <string>
+#include <vector>
+
+/**
+ * SDFDistanceQuery
+ * bakes an analytic sphere into a container and queries two transformed copies of it through a shared box tree :
+ * sample matches a scalar trilinear reference (the sse path when it is compiled in), distance matches the
+ * exact sphere distance inside the volumes, and sphereTrace hits the spheres where a ray cast does.
+ */
+namespace
+{
+	using namespace maple;
+	using namespace maple::sdf;
+
+	constexpr int32_t Resolution  = 40;
+	constexpr float   Radius      = 0.6f;        // local, the volume spans -1..1
+	constexpr float   MaxDistance = 2.f;
+
+	// away from its center, trilinear interpolation of the sphere gives up less than a fifth of a texel (0.05), the half floats about 1e-3.
+	constexpr float Tolerance = 0.01f;
+
+	struct Sphere
+	{
+		uint32_t  id;
+		glm::mat4 world;
+		glm::vec3 center;
+		float     radius;
+	};
+
+	inline auto exact(const std::vector<Sphere> &spheres, const glm::vec3 &position)
+	{
+		float distance = std::numeric_limits<float>::max();
+		for (auto &sphere : spheres)
+			distance = std::min(distance, glm::distance(position, sphere.center) - sphere.radius);
+		return distance;
+	}
+
+	// the plain scalar lookup sample() has to agree with.
+	auto reference(const query::Volume &volume, const glm::vec3 &local) -> float
+	{
+		const glm::vec3  position = glm::clamp((local - volume.aabb.min) * volume.localToVoxel - 0.5f, glm::vec3(0.f), glm::vec3(volume.resolution - 1));
+		const glm::ivec3 base     = glm::min(glm::ivec3(position), volume.resolution - 2);
+		const glm::vec3  t        = position - glm::vec3(base);
+
+		auto texel = [&](int32_t x, int32_t y, int32_t z) {
+			return volume.distances[(base.x + x) + ((base.y + y) + (base.z + z) * volume.resolution.y) * size_t(volume.resolution.x)];
+		};
+
+		float result = 0;
+		for (int32_t i = 0; i < 8; i++)
+		{
+			const glm::ivec3 corner(i & 1, (i >> 1) & 1, i >> 2);
+			const glm::vec3  weight = glm::mix(1.f - t, t, glm::vec3(corner));
+			result += weight.x * weight.y * weight.z * texel(corner.x, corner.y, corner.z);
+		}
+		return result;
+	}
+
+	auto bake(const std::string &path) -> bool
+	{
+		container::Header header{};
+		header.format      = container::Format::R16Float;
+		header.width       = Resolution;
+		header.height      = Resolution;
+		header.depth       = Resolution;
+		header.aabbMin     = glm::vec3(-1.f);
+		header.aabbMax     = glm::vec3(1.f);
+		header.maxDistance = MaxDistance;
+
+		// texel centers, the same placement the atlas regions and sample() use.
+		std::vector<uint8_t> mip0(size_t(Resolution) * Resolution * Resolution * sizeof(uint16_t));
+		for (int32_t z = 0, index = 0; z < Resolution; z++)
+		{
+			for (int32_t y = 0; y < Resolution; y++)
+			{
+				for (int32_t x = 0; x < Resolution; x++, index++)
+				{
+					const glm::vec3 position = -1.f + (glm::vec3(x, y, z) + 0.5f) * (2.f / Resolution);
+					const uint16_t  half     = glm::packHalf1x16((glm::length(position) - Radius) / MaxDistance * 0.5f + 0.5f);
+					memcpy(mip0.data() + index * sizeof(uint16_t), &half, sizeof(uint16_t));
+				}
+			}
+		}
+		return container::write(path, header, {mip0});
+	}
+
+	auto fail(const char *message, const glm::vec3 &position, float value, float expected) -> int32_t
+	{
+		fprintf(stderr, "FAILED: %s at %f %f %f : %f, expected %f\n", message, position.x, position.y, position.z, value, expected);
+		return EXIT_FAILURE;
+	}
+}        // namespace
+
+auto main() -> int32_t
+{
+	Console::init();
+
+	std::error_code error;
+	const auto      path = (std::filesystem::temp_directory_path(error) / "MapleSDFDistanceQuery.sdf").string();
+	if (!bake(path))
+	{
+		fprintf(stderr, "FAILED: could not write the container\n");
+		return EXIT_FAILURE;
+	}
+
+	int32_t                               exitCode = EXIT_SUCCESS;
+	std::mt19937                          random(5);
+	std::uniform_real_distribution<float> uniform(-1.f, 1.f);
+	auto                                  randomVector = [&]() { return glm::vec3(uniform(random), uniform(random), uniform(random)); };
+
+	std::string reason;
+	const auto  volume = query::loadVolume(path, 0, reason);
+	if (volume == nullptr)
+	{
+		fprintf(stderr, "FAILED: %s\n", reason.c_str());
+		return EXIT_FAILURE;
+	}
+
+	// past the volume too, so the clamp to the outer texel centers is covered.
+	float sampleError = 0;
+	for (int32_t i = 0; i < 20000 && exitCode == EXIT_SUCCESS; i++)
+	{
+		const auto  local    = randomVector() * 1.2f;
+		const float sampled  = query::sample(*volume, local);
+		const float expected = reference(*volume, local);
+		sampleError          = std::max(sampleError, std::abs(sampled - expected));
+		if (std::abs(sampled - expected) > 1e-5f)
+			exitCode = fail("sample differs from the scalar reference", local, sampled, expected);
+	}
+
+	// far enough apart that neither volume is within reach of the other one's points.
+	std::vector<Sphere> spheres = {
+	    {3, glm::translate(glm::mat4(1.f), {-4.f, 0.f, 0.f})},
+	    {8, glm::scale(glm::rotate(glm::translate(glm::mat4(1.f), {4.f, 0.5f, -1.f}), 0.7f, glm::normalize(glm::vec3(1.f, 2.f, 3.f))), glm::vec3(1.5f))},
+	};
+
+	auto                 tree = std::make_shared<DynamicAABBTree>();
+	query::DistanceQuery distanceQuery(tree);
+	distanceQuery.mip = 0;
+	for (auto &sphere : spheres)
+	{
+		sphere.center = glm::vec3(sphere.world[3]);
+		sphere.radius = Radius * glm::length(glm::vec3(sphere.world[0]));
+		tree->createProxy(volume->aabb.transform(sphere.world), sphere.id);
+		if (!distanceQuery.updateObject(sphere.id, path, sphere.world))
+			exitCode = fail("could not add the object", sphere.center, 0, 0);
+	}
+
+	// in the tree but without a readable field, the query has to skip it.
+	tree->createProxy({glm::vec3(-1.f), glm::vec3(1.f)}, 12);
+	distanceQuery.updateObject(12, path + ".missing", glm::mat4(1.f));
+	if (distanceQuery.getObjectCount() != spheres.size())
+		exitCode = fail("a missing field was added", glm::vec3(0.f), float(distanceQuery.getObjectCount()), float(spheres.size()));
+
+	float distanceError = 0;
+	for (int32_t i = 0; i < 20000 && exitCode == EXIT_SUCCESS; i++)
+	{
+		// inside the outer texel centers, past them the lookup is clamped like on the gpu. the field has a cusp at
+		// the sphere center that no interpolation follows, it is skipped.
+		const auto &sphere = spheres[i % spheres.size()];
+		const auto  local  = randomVector() * (1.f - 1.f / Resolution);
+		if (glm::length(local) < 4.f / Resolution)
+			continue;
+
+		const auto position = glm::vec3(sphere.world * glm::vec4(local, 1.f));
+		float      distance = 0;
+		distanceQuery.distance(&position, &distance, 1, 10.f);
+
+		// the errors scale with the object.
+		const float expected = exact(spheres, position);
+		const float scale    = sphere.radius / Radius;
+		distanceError        = std::max(distanceError, std::abs(distance - expected) / scale);
+		if (std::abs(distance - expected) > Tolerance * scale)
+			exitCode = fail("distance differs from the sphere", position, distance, expected);
+	}
+
+	{
+		const glm::vec3 far(0.f, 20.f, 0.f);
+		float           distance = 0;
+		distanceQuery.distance(&far, &distance, 1, 3.f);
+		if (distance != 3.f)
+			exitCode = fail("nothing is in reach, expected maxDistance", far, distance, 3.f);
+	}
+
+	// rays start inside a volume outside its sphere and aim at the inner half of the sphere, so they all hit.
+	float    traceError = 0;
+	uint32_t steps      = 0;
+	for (int32_t i = 0; i < 2000 && exitCode == EXIT_SUCCESS; i++)
+	{
+		const auto &sphere = spheres[i % spheres.size()];
+		glm::vec3   local;
+		do
+		{
+			local = randomVector() * 0.95f;
+		} while (glm::length(local) < Radius + 0.15f);
+
+		query::Ray ray;
+		ray.origin      = glm::vec3(sphere.world * glm::vec4(local, 1.f));
+		ray.direction   = glm::normalize(sphere.center + randomVector() * sphere.radius * 0.5f - ray.origin);
+		ray.maxDistance = 10.f;
+
+		// analytic ray cast.
+		const auto  offset   = ray.origin - sphere.center;
+		const float b        = glm::dot(offset, ray.direction);
+		const float expected = -b - std::sqrt(b * b - glm::dot(offset, offset) + sphere.radius * sphere.radius);
+
+		query::RayHit hit;
+		distanceQuery.sphereTrace(&ray, &hit, 1);
+		steps += hit.steps;
+		if (!hit.hit || hit.object != sphere.id)
+		{
+			exitCode = fail("ray missed the sphere", ray.origin, hit.distance, expected);
+			break;
+		}
+
+		// the march stops in front of the surface, closer to it than hitDistance.
+		const float scale   = sphere.radius / Radius;
+		const float surface = glm::distance(hit.position, sphere.center) - sphere.radius;
+		traceError          = std::max(traceError, expected - hit.distance);
+		if (hit.distance > expected + Tolerance * scale)
+			exitCode = fail("ray went through the sphere", ray.origin, hit.distance, expected);
+		if (surface < -Tolerance * scale || surface > distanceQuery.hitDistance + Tolerance * scale)
+			exitCode = fail("ray stopped away from the surface", hit.position, surface, 0.f);
+
+		const auto normal = glm::normalize(hit.position - sphere.center);
+		if (glm::dot(hit.normal, normal) < 0.95f)
+			exitCode = fail("hit normal is off", hit.position, glm::dot(hit.normal, normal), 1.f);
+	}
+
+	{
+		const query::Ray away{{-4.f, 0.f, 0.9f}, {0.f, 0.f, 1.f}, 5.f};
+		query::RayHit    hit;
+		distanceQuery.sphereTrace(&away, &hit, 1);
+		if (hit.hit || hit.distance != away.maxDistance)
+			exitCode = fail("ray leaving the volume hit something", away.origin, hit.distance, away.maxDistance);
+	}
+
+	distanceQuery.removeObject(3);
+	distanceQuery.removeObject(8);
+	std::filesystem::remove(path, error);
+
+	if (exitCode == EXIT_SUCCESS)
+	{
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+		const char *variant = "sse2";
+#else
+		const char *variant = "scalar";
+#endif
+		printf("%s sample error %g, distance error %f, sphere trace stops %f short, %.1f steps per ray\n", variant, sampleError, distanceError, traceError, steps / 2000.f);
+	}
+	return exitCode;
+}
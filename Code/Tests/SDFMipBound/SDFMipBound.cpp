@@ -0,0 +1,118 @@
+//////////////////////////////////////////////////////////////////////////////
+// This file is part of the Maple Engine                              		//
+//////////////////////////////////////////////////////////////////////////////
+#include "Engine/DDGI/SDFBaker.h"
+#include "Engine/JobSystem.h"
+#include "Others/Console.h"
+
+#include <glm/gtc/packing.hpp>
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+/**
+ * SDFMipBound
+ * builds the mip chain of an exact sphere field and checks that every coarse texel is a lower bound :
+ * never farther from the surface than the exact distance at its center, and never on the other side of it.
+ */
+namespace
+{
+	using namespace maple;
+
+	// not a power of two, so footprints are uneven and the last texels are clamped.
+	const glm::uvec3 Resolution(45, 33, 27);
+	const glm::vec3  Extent(1.f, 0.75f, 0.6f);        // volume size / maxDistance
+	const glm::vec3  Center(0.55f, 0.35f, 0.3f);
+	constexpr float  Radius = 0.22f;
+
+	// the fine texels are rounded to nearest half floats, half an ulp at 1 is 2^-12 and doubled by the encoding.
+	constexpr float Tolerance = 1.f / 2048.f;
+
+	inline auto exact(const glm::vec3 &position)
+	{
+		return glm::distance(position, Center) - Radius;
+	}
+
+	inline auto decode(const std::vector<uint8_t> &mip, size_t index)
+	{
+		uint16_t half;
+		memcpy(&half, mip.data() + index * sizeof(uint16_t), sizeof(uint16_t));
+		return glm::unpackHalf1x16(half) * 2.f - 1.f;
+	}
+}        // namespace
+
+auto main() -> int32_t
+{
+	Console::init();
+	JobSystem::init(1);
+
+	const glm::vec3      spacing = Extent / glm::vec3(Resolution - 1u);
+	std::vector<uint8_t> mip0(size_t(Resolution.x) * Resolution.y * Resolution.z * sizeof(uint16_t));
+	for (uint32_t z = 0, index = 0; z < Resolution.z; z++)
+	{
+		for (uint32_t y = 0; y < Resolution.y; y++)
+		{
+			for (uint32_t x = 0; x < Resolution.x; x++, index++)
+			{
+				const uint16_t half = glm::packHalf1x16((exact(glm::vec3(x, y, z) * spacing) + 1.f) / 2.f);
+				memcpy(mip0.data() + index * sizeof(uint16_t), &half, sizeof(uint16_t));
+			}
+		}
+	}
+
+	const auto mips = sdf::baker::buildMipChain(mip0, Resolution, Extent, 2, 8);
+
+	int32_t    exitCode = mips.size() > 3 ? EXIT_SUCCESS : EXIT_FAILURE;
+	glm::uvec3 fine     = Resolution;
+	glm::vec3  scale(1.f), offset(0.f);        // coarse texel to mip0 texel coordinates
+	for (uint32_t level = 1; level < mips.size(); level++)
+	{
+		const glm::uvec3 coarse = glm::max(fine / 2u, glm::uvec3(1));
+		const glm::vec3  step   = glm::vec3(fine) / glm::vec3(coarse);
+
+		// same texel centers as the baker : fine = (coarse + 0.5) * step - 0.5.
+		offset += scale * (0.5f * step - 0.5f);
+		scale *= step;
+
+		uint32_t tested = 0, tight = 0;
+		float    slack  = 0;
+		for (uint32_t z = 0, index = 0; z < coarse.z; z++)
+		{
+			for (uint32_t y = 0; y < coarse.y; y++)
+			{
+				for (uint32_t x = 0; x < coarse.x; x++, index++)
+				{
+					const glm::vec3 position = (glm::vec3(x, y, z) * scale + offset) * spacing;
+					const float     bound    = decode(mips[level], index);
+					const float     distance = exact(position);
+					tested++;
+
+					if (std::abs(bound) > std::abs(distance) + Tolerance || (bound != 0.f && (bound < 0) != (distance < 0)))
+					{
+						fprintf(stderr, "FAILED: mip %u texel %u %u %u stores %f, the exact distance is %f\n", level, x, y, z, bound, distance);
+						exitCode = EXIT_FAILURE;
+					}
+					if (bound != 0.f)
+						tight++;
+					slack = std::max(slack, std::abs(distance) - std::abs(bound));
+				}
+			}
+		}
+
+		// a chain of zeros would pass too. every level may give up about one footprint radius, so a few texel diagonals in total.
+		const float diagonal = glm::length(scale * spacing);
+		if (slack > 2.f * diagonal)
+		{
+			fprintf(stderr, "FAILED: mip %u gives up %f, more than two texel diagonals (%f)\n", level, slack, diagonal);
+			exitCode = EXIT_FAILURE;
+		}
+		printf("mip %u %ux%ux%u : %u of %u texels non zero, largest slack %f, texel diagonal %f\n", level, coarse.x, coarse.y, coarse.z, tight, tested, slack, diagonal);
+		fine = coarse;
+	}
+
+	fflush(stdout);
+	fflush(stderr);
+	std::_Exit(exitCode);
+}
@@ -0,0 +1,260 @@
+//////////////////////////////////////////////////////////////////////////////
+// This file is part of the Maple Engine                              		//
+//////////////////////////////////////////////////////////////////////////////
+#include "Engine/DDGI/MeshDistanceField.h"
+#include "Engine/DDGI/SDFBaker.h"
+#include "Engine/DDGI/SDFContainer.h"
+#include "Engine/JobSystem.h"
+#include "Math/MathUtils.h"
+#include "Others/Console.h"
+
+#include <glm/gtc/packing.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <functional>
+#include <string>
+#include <thread>
+#include <vector>
+
+/**
+ * SDFSignAgreement [--threads n] [--resolution n]
+ * bakes analytic meshes with both sign methods and compares every voxel sign against the exact shape,
+ * skipping a band around the surface where the tessellation and the voxel size decide. prints the bake times.
+ */
+namespace
+{
+	using namespace maple;
+	using clock = std::chrono::steady_clock;
+
+	struct Shape
+	{
+		sdf::baker::MeshGeometry                geometry;
+		std::function<float(const glm::vec3 &)> distance;        // exact signed distance, negative inside
+		float                                   band;            // tessellation error, added to the skipped band
+	};
+
+	// the baker votes with clockwise front faces, so the triangles are emitted clockwise seen from outside.
+	auto addQuad(sdf::baker::MeshGeometry &geometry, uint32_t a, uint32_t b, uint32_t c, uint32_t d)
+	{
+		geometry.indices.insert(geometry.indices.end(), {a, c, b, a, d, c});
+	}
+
+	// grid of (segments + 1)^2 vertices per cube face, projected to a sphere when radius > 0.
+	auto makeCube(const std::string &name, const glm::vec3 &halfSize, uint32_t segments, float radius) -> sdf::baker::MeshGeometry
+	{
+		sdf::baker::MeshGeometry geometry;
+		geometry.name = name;
+
+		for (int32_t axis = 0; axis < 3; axis++)
+		{
+			for (float side : {-1.f, 1.f})
+			{
+				const int32_t u    = (axis + 1) % 3;
+				const int32_t v    = (axis + 2) % 3;
+				const auto    base = static_cast<uint32_t>(geometry.positions.size());
+				for (uint32_t j = 0; j <= segments; j++)
+				{
+					for (uint32_t i = 0; i <= segments; i++)
+					{
+						glm::vec3 position;
+						position[axis] = side;
+						position[u]    = float(i) / segments * 2 - 1;
+						position[v]    = float(j) / segments * 2 - 1;
+						geometry.positions.emplace_back(radius > 0 ? glm::normalize(position) * radius : position * halfSize);
+					}
+				}
+
+				const uint32_t stride = segments + 1;
+				for (uint32_t j = 0; j < segments; j++)
+				{
+					for (uint32_t i = 0; i < segments; i++)
+					{
+						const uint32_t a = base + j * stride + i;
+						// u x v points along +axis, flip the quad on the negative side.
+						if (side > 0)
+							addQuad(geometry, a, a + 1, a + 1 + stride, a + stride);
+						else
+							addQuad(geometry, a, a + stride, a + 1 + stride, a + 1);
+					}
+				}
+			}
+		}
+		return geometry;
+	}
+
+	auto makeTorus(const std::string &name, float major, float minor, uint32_t segments, uint32_t rings) -> sdf::baker::MeshGeometry
+	{
+		sdf::baker::MeshGeometry geometry;
+		geometry.name = name;
+		for (uint32_t j = 0; j < segments; j++)
+		{
+			const float phi = float(j) / segments * glm::two_pi<float>();
+			for (uint32_t i = 0; i < rings; i++)
+			{
+				const float theta  = float(i) / rings * glm::two_pi<float>();
+				const float radius = major + minor * std::cos(theta);
+				geometry.positions.emplace_back(radius * std::cos(phi), minor * std::sin(theta), radius * std::sin(phi));
+			}
+		}
+
+		for (uint32_t j = 0; j < segments; j++)
+		{
+			for (uint32_t i = 0; i < rings; i++)
+			{
+				const uint32_t j1 = (j + 1) % segments;
+				const uint32_t i1 = (i + 1) % rings;
+				addQuad(geometry, j * rings + i, j * rings + i1, j1 * rings + i1, j1 * rings + i);
+			}
+		}
+		return geometry;
+	}
+
+	auto makeShapes() -> std::vector<Shape>
+	{
+		std::vector<Shape> shapes;
+
+		const glm::vec3 halfSize(1.f, 0.5f, 0.75f);
+		shapes.push_back({makeCube("box", halfSize, 1, 0), [=](const glm::vec3 &p) {
+			                  const auto q = glm::abs(p) - halfSize;
+			                  return glm::length(glm::max(q, 0.f)) + std::min(math::max3(q), 0.f);
+		                  },
+		                  0.f});
+
+		// a chord of the tessellated sphere is at most r * (1 - cos(angle / 2)) inside the exact one.
+		shapes.push_back({makeCube("sphere", {}, 16, 1.f), [](const glm::vec3 &p) { return glm::length(p) - 1.f; }, 1.f - std::cos(glm::half_pi<float>() / 16)});
+
+		const float major = 1.f, minor = 0.35f;
+		shapes.push_back({makeTorus("torus", major, minor, 64, 24), [=](const glm::vec3 &p) {
+			                  const glm::vec2 q(glm::length(glm::vec2(p.x, p.z)) - major, p.y);
+			                  return glm::length(q) - minor;
+		                  },
+		                  major * (1.f - std::cos(glm::pi<float>() / 64)) + minor * (1.f - std::cos(glm::pi<float>() / 24))});
+		return shapes;
+	}
+
+	struct Result
+	{
+		double   milliseconds = 0;
+		uint32_t tested       = 0;
+		uint32_t wrong        = 0;
+		std::vector<int8_t> signs;        // 0 inside the skipped band
+	};
+
+	auto bakeAndCompare(const Shape &shape, const sdf::baker::SDFBakerConfig &config, Result &result) -> bool
+	{
+		sdf::component::MeshDistanceField field;
+
+		const auto start = clock::now();
+		if (!sdf::baker::bake(shape.geometry, config, field))
+			return false;
+		result.milliseconds = std::chrono::duration<double, std::milli>(clock::now() - start).count();
+
+		sdf::container::MappedFile file;
+		std::string                error;
+		if (!file.open(field.bakedPath, error))
+		{
+			fprintf(stderr, "%s : %s\n", field.bakedPath.c_str(), error.c_str());
+			return false;
+		}
+
+		const auto &header = file.getHeader();
+		const auto  size   = glm::uvec3(header.width, header.height, header.depth);
+		const auto  grid   = (header.aabbMax - header.aabbMin) / glm::vec3(size - glm::uvec3(1));
+		const float band   = glm::length(grid) + shape.band;
+		std::vector<uint8_t> decoded;
+		const auto *         texels = file.getMip(0, decoded);
+
+		result.signs.resize(size_t(size.x) * size.y * size.z);
+		for (uint32_t z = 0, index = 0; z < size.z; z++)
+		{
+			for (uint32_t y = 0; y < size.y; y++)
+			{
+				for (uint32_t x = 0; x < size.x; x++, index++)
+				{
+					const auto  position = glm::vec3(x, y, z) * grid + header.aabbMin;
+					const float exact    = shape.distance(position);
+					if (std::abs(exact) <= band)
+					{
+						result.signs[index] = 0;
+						continue;
+					}
+
+					uint16_t half;
+					memcpy(&half, texels + index * sizeof(uint16_t), sizeof(uint16_t));
+					const float baked = glm::unpackHalf1x16(half) * 2.f - 1.f;
+
+					result.signs[index] = baked < 0 ? -1 : 1;
+					result.tested++;
+					if ((baked < 0) != (exact < 0))
+						result.wrong++;
+				}
+			}
+		}
+		return true;
+	}
+}        // namespace
+
+auto main(int32_t argc, char **argv) -> int32_t
+{
+	uint32_t threads    = std::max(std::thread::hardware_concurrency(), 1u);
+	uint32_t resolution = 40;
+	for (int32_t i = 1; i + 1 < argc; i += 2)
+	{
+		if (strcmp(argv[i], "--threads") == 0)
+			threads = std::max(std::atoi(argv[i + 1]), 1);
+		else if (strcmp(argv[i], "--resolution") == 0)
+			resolution = std::max(std::atoi(argv[i + 1]), 8);
+	}
+
+	Console::init();
+	JobSystem::init(threads);
+
+	// bakes go through the sdf cache, which lives next to the working directory.
+	std::error_code error;
+	const auto      root = std::filesystem::temp_directory_path(error) / "MapleSDFSignAgreement";
+	std::filesystem::remove_all(root, error);
+	std::filesystem::create_directories(root, error);
+	std::filesystem::current_path(root, error);
+
+	sdf::baker::SDFBakerConfig rayVote(resolution, resolution);
+	sdf::baker::SDFBakerConfig windingNumber(resolution, resolution);
+	windingNumber.signMethod = sdf::baker::SignMethod::WindingNumber;
+
+	int32_t exitCode = EXIT_SUCCESS;
+	for (auto &shape : makeShapes())
+	{
+		Result vote, winding;
+		if (!bakeAndCompare(shape, rayVote, vote) || !bakeAndCompare(shape, windingNumber, winding))
+		{
+			fprintf(stderr, "FAILED: %s did not bake\n", shape.geometry.name.c_str());
+			exitCode = EXIT_FAILURE;
+			continue;
+		}
+
+		uint32_t disagree = 0;
+		for (size_t i = 0; i < vote.signs.size(); i++)
+			disagree += vote.signs[i] != winding.signs[i];
+
+		printf("%-8s %u voxels off the surface : ray vote %.1f ms %u wrong, winding number %.1f ms %u wrong, %u disagree\n",
+		       shape.geometry.name.c_str(), vote.tested, vote.milliseconds, vote.wrong, winding.milliseconds, winding.wrong, disagree);
+
+		if (vote.wrong != 0 || winding.wrong != 0 || disagree != 0)
+		{
+			fprintf(stderr, "FAILED: %s signs differ from the exact shape\n", shape.geometry.name.c_str());
+			exitCode = EXIT_FAILURE;
+		}
+	}
+
+	std::filesystem::current_path(root.parent_path(), error);
+	std::filesystem::remove_all(root, error);
+
+	// the job system workers never stop, leave before the static destructors pull the queues from under them.
+	fflush(stdout);
+	fflush(stderr);
+	std::_Exit(exitCode);
+}
@@ -0,0 +1,245 @@
+//////////////////////////////////////////////////////////////////////////////
+// This file is part of the Maple Engine                              		//
+//////////////////////////////////////////////////////////////////////////////
+#include <glm/glm.hpp>
+#include <glm/gtc/constants.hpp>
+#include <glm/gtx/norm.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <random>
+#include <vector>
+
+// libacc expects glm and the standard headers to be included first.
+#include <bvh_tree.h>
+
+#include "BinaryBVHTree.h"
+
+/**
+ * BVHBenchmark [--triangles n] [--queries n]
+ * build time and query throughput of the libacc BVHTree : single rays, packets sharing an origin like the sdf baker
+ * shoots them, and closest points. the node width follows the instruction set, BVHBenchmarkAVX runs the 8 wide nodes.
+ * the binary node tree libacc traversed before is measured on the same queries, every answer has to match it and
+ * the first ones are checked against a brute force loop over every triangle.
+ */
+namespace
+{
+	using clock = std::chrono::steady_clock;
+	using Tree  = acc::BVHTree<uint32_t, glm::vec3>;
+	using Binary = acc::binary::BVHTree<uint32_t, glm::vec3>;
+
+	constexpr uint32_t PacketSize = 16;        // sampleCount 4 of the baker
+	constexpr uint32_t Checked    = 256;
+
+	struct Options
+	{
+		uint32_t triangles = 200000;
+		uint32_t queries   = 200000;
+	};
+
+	struct Mesh
+	{
+		std::vector<glm::vec3> positions;
+		std::vector<uint32_t>  indices;
+	};
+
+	// a bumpy sphere, so the tree has to deal with uneven triangle sizes.
+	auto makeMesh(uint32_t triangles) -> Mesh
+	{
+		const uint32_t rings    = std::max(4u, uint32_t(std::sqrt(triangles / 4.f)));
+		const uint32_t segments = std::max(4u, triangles / (2 * rings));
+
+		Mesh mesh;
+		for (uint32_t j = 0; j <= rings; j++)
+		{
+			const float theta = float(j) / rings * glm::pi<float>();
+			for (uint32_t i = 0; i <= segments; i++)
+			{
+				const float phi    = float(i) / segments * glm::two_pi<float>();
+				const float radius = 1.f + 0.1f * std::sin(5 * theta) * std::cos(7 * phi);
+				mesh.positions.emplace_back(radius * std::sin(theta) * std::cos(phi), radius * std::cos(theta), radius * std::sin(theta) * std::sin(phi));
+			}
+		}
+
+		const uint32_t stride = segments + 1;
+		for (uint32_t j = 0; j < rings; j++)
+		{
+			for (uint32_t i = 0; i < segments; i++)
+			{
+				const uint32_t a = j * stride + i;
+				mesh.indices.insert(mesh.indices.end(), {a, a + stride, a + 1, a + 1, a + stride, a + stride + 1});
+			}
+		}
+		return mesh;
+	}
+
+	auto seconds(clock::time_point begin)
+	{
+		return std::chrono::duration<double>(clock::now() - begin).count();
+	}
+
+	auto bruteIntersect(const Mesh &mesh, const acc::Ray<glm::vec3> &ray)
+	{
+		float nearest = acc::inf;
+		for (size_t i = 0; i < mesh.indices.size(); i += 3)
+		{
+			const acc::Tri<glm::vec3> tri{mesh.positions[mesh.indices[i]], mesh.positions[mesh.indices[i + 1]], mesh.positions[mesh.indices[i + 2]]};
+			float                     t;
+			glm::vec3                 bcoords;
+			if (acc::intersect(ray, tri, &t, &bcoords))
+				nearest = std::min(nearest, t);
+		}
+		return nearest;
+	}
+
+	auto bruteClosest(const Mesh &mesh, const glm::vec3 &point)
+	{
+		float nearest = acc::inf;
+		for (size_t i = 0; i < mesh.indices.size(); i += 3)
+		{
+			const acc::Tri<glm::vec3> tri{mesh.positions[mesh.indices[i]], mesh.positions[mesh.indices[i + 1]], mesh.positions[mesh.indices[i + 2]]};
+			nearest = std::min(nearest, glm::distance(point, acc::closest_point(point, tri)));
+		}
+		return nearest;
+	}
+}        // namespace
+
+int main(int argc, char **argv)
+{
+	Options options;
+	for (int32_t i = 1; i + 1 < argc; i += 2)
+	{
+		if (strcmp(argv[i], "--triangles") == 0)
+			options.triangles = std::max(1, atoi(argv[i + 1]));
+		else if (strcmp(argv[i], "--queries") == 0)
+			options.queries = std::max(int32_t(Checked), atoi(argv[i + 1]));
+		else
+		{
+			printf("usage : BVHBenchmark [--triangles n] [--queries n]\n");
+			return 2;
+		}
+	}
+
+	const auto mesh = makeMesh(options.triangles);
+
+	auto       begin = clock::now();
+	const Tree tree(mesh.indices, mesh.positions);
+	const auto build = seconds(begin);
+
+	begin = clock::now();
+	const Binary binary(mesh.indices, mesh.positions);
+	const auto   binaryBuild = seconds(begin);
+
+	// origins inside the padded bounds, as the baker places its voxels.
+	std::mt19937                          random(42);
+	std::uniform_real_distribution<float> uniform(-1.3f, 1.3f);
+	auto                                  direction = [&]() {
+		glm::vec3 d;
+		do
+			d = glm::vec3(uniform(random), uniform(random), uniform(random));
+		while (glm::dot(d, d) < 0.01f);
+		return glm::normalize(d);
+	};
+
+	std::vector<acc::Ray<glm::vec3>> rays(options.queries);
+	std::vector<glm::vec3>           points(options.queries);
+	for (uint32_t i = 0; i < options.queries; i++)
+	{
+		points[i] = glm::vec3(uniform(random), uniform(random), uniform(random));
+		// packets share the origin of their first ray.
+		const auto origin = i % PacketSize == 0 ? points[i] : rays[i - i % PacketSize].origin;
+		rays[i]           = {origin, direction(), 0.f, 10.f};
+	}
+
+	std::vector<Tree::Hit> hits(options.queries);
+	uint32_t               hitCount = 0;
+	begin                           = clock::now();
+	for (uint32_t i = 0; i < options.queries; i++)
+	{
+		hits[i].t = acc::inf;
+		hitCount += tree.intersect(rays[i], &hits[i]);
+	}
+	const auto single = seconds(begin);
+
+	std::vector<Tree::Hit> packetHits(options.queries);
+	uint32_t               packetHitCount = 0;
+	begin                                 = clock::now();
+	for (uint32_t i = 0; i < options.queries; i += PacketSize)
+		packetHitCount += uint32_t(tree.intersect(rays.data() + i, std::min(PacketSize, options.queries - i), packetHits.data() + i));
+	const auto packet = seconds(begin);
+
+	std::vector<float> closest(options.queries);
+	begin = clock::now();
+	for (uint32_t i = 0; i < options.queries; i++)
+		closest[i] = glm::distance(points[i], tree.closest_point(points[i]));
+	const auto nearest = seconds(begin);
+
+	std::vector<Binary::Hit> binaryHits(options.queries);
+	uint32_t                 binaryHitCount = 0;
+	begin                                   = clock::now();
+	for (uint32_t i = 0; i < options.queries; i++)
+	{
+		binaryHits[i].t = acc::inf;
+		binaryHitCount += binary.intersect(rays[i], &binaryHits[i]);
+	}
+	const auto binarySingle = seconds(begin);
+
+	std::vector<float> binaryClosest(options.queries);
+	begin = clock::now();
+	for (uint32_t i = 0; i < options.queries; i++)
+		binaryClosest[i] = glm::distance(points[i], binary.closest_point(points[i]));
+	const auto binaryNearest = seconds(begin);
+
+	int32_t errors = 0;
+	if (hitCount != binaryHitCount)
+	{
+		printf("wide nodes hit %u times, binary nodes %u times\n", hitCount, binaryHitCount);
+		errors++;
+	}
+	uint32_t differ = 0;
+	for (uint32_t i = 0; i < options.queries; i++)
+	{
+		if (std::abs(hits[i].t - binaryHits[i].t) > 1e-4f || std::abs(closest[i] - binaryClosest[i]) > 1e-4f)
+			differ++;
+	}
+	if (differ > 0)
+	{
+		printf("%u queries differ between the wide and the binary nodes\n", differ);
+		errors++;
+	}
+	if (hitCount != packetHitCount)
+	{
+		printf("single rays hit %u times, packets %u times\n", hitCount, packetHitCount);
+		errors++;
+	}
+	for (uint32_t i = 0; i < Checked; i++)
+	{
+		const float t = bruteIntersect(mesh, rays[i]);
+		if ((t == acc::inf) != (hits[i].t == acc::inf) || (t != acc::inf && (std::abs(t - hits[i].t) > 1e-4f || std::abs(t - packetHits[i].t) > 1e-4f)))
+		{
+			printf("ray %u : brute force %f, single %f, packet %f\n", i, t, hits[i].t, packetHits[i].t);
+			errors++;
+		}
+		const float d = bruteClosest(mesh, points[i]);
+		if (std::abs(d - closest[i]) > 1e-4f)
+		{
+			printf("point %u : brute force %f, tree %f\n", i, d, closest[i]);
+			errors++;
+		}
+	}
+
+	const auto rate = [&](double time) { return options.queries / time / 1e6; };
+	printf("width %d, %zu triangles, %u queries\n", ACC_BVH_WIDTH, mesh.indices.size() / 3, options.queries);
+	printf("%-14s %12s %12s %8s\n", "", "binary", "wide", "speedup");
+	printf("%-14s %9.2f ms %9.2f ms %7.2fx\n", "build", binaryBuild * 1e3, build * 1e3, binaryBuild / build);
+	printf("%-14s %8.2f M/s %8.2f M/s %7.2fx\n", "ray", rate(binarySingle), rate(single), binarySingle / single);
+	printf("%-14s %8.2f M/s %8.2f M/s %7.2fx\n", "ray packet", rate(binarySingle), rate(packet), binarySingle / packet);
+	printf("%-14s %8.2f M/s %8.2f M/s %7.2fx\n", "closest point", rate(binaryNearest), rate(nearest), binaryNearest / nearest);
+	printf("%u of %u checked queries differ from brute force\n", errors, Checked * 2);
+	return errors == 0 ? 0 : 1;
+}
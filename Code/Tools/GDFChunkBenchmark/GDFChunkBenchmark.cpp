@@ -0,0 +1,164 @@
+//////////////////////////////////////////////////////////////////////////////
+// This file is part of the Maple Engine                              		//
+//////////////////////////////////////////////////////////////////////////////
+#include "Engine/DDGI/SDFChunks.h"
+#include "Math/BoundingSphere.h"
+#include "Math/DynamicAABBTree.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <vector>
+
+/**
+ * GDFChunkBenchmark [--objects n] [--frames n] [--moving n] [--budget n]
+ * cpu side of the global sdf cascade updates without the gpu : the view flies through a field of objects,
+ * some of them move every frame, and each cascade scrolls, bins the objects it sees into chunks and plans its dispatches.
+ */
+namespace
+{
+	using namespace maple;
+	using clock = std::chrono::steady_clock;
+
+	// same setup as the renderer at Quality::Test : 192^3 cascades, 6 chunks per axis.
+	constexpr int32_t Resolution    = 192;
+	constexpr int32_t ChunksPerAxis = Resolution / sdf::chunks::ChunkSize;
+	constexpr float   Distance      = 200.f;
+	const float       CascadeScales[] = {1.0f, 2.5f, 5.0f, 10.0f};
+
+	struct Options
+	{
+		uint32_t objects = 10000;
+		uint32_t frames  = 600;
+		uint32_t moving  = 100;        // objects moved per frame
+		uint32_t budget  = 64;         // chunks per cascade update
+	};
+
+	struct Object
+	{
+		BoundingBox bounds;
+		int32_t     proxy;
+	};
+
+	auto milliseconds(clock::time_point begin)
+	{
+		return std::chrono::duration<double, std::milli>(clock::now() - begin).count();
+	}
+}        // namespace
+
+int main(int argc, char **argv)
+{
+	Options options;
+	for (int32_t i = 1; i + 1 < argc; i += 2)
+	{
+		if (strcmp(argv[i], "--objects") == 0)
+			options.objects = std::max(1, atoi(argv[i + 1]));
+		else if (strcmp(argv[i], "--frames") == 0)
+			options.frames = std::max(1, atoi(argv[i + 1]));
+		else if (strcmp(argv[i], "--moving") == 0)
+			options.moving = std::max(0, atoi(argv[i + 1]));
+		else if (strcmp(argv[i], "--budget") == 0)
+			options.budget = std::max(1, atoi(argv[i + 1]));
+		else
+		{
+			printf("usage : GDFChunkBenchmark [--objects n] [--frames n] [--moving n] [--budget n]\n");
+			return 2;
+		}
+	}
+
+	std::mt19937                          random(3);
+	std::uniform_real_distribution<float> position(-Distance * 2, Distance * 2);
+	std::uniform_real_distribution<float> size(0.5f, 8.f);
+	std::uniform_real_distribution<float> step(-1.f, 1.f);
+
+	DynamicAABBTree     tree;
+	std::vector<Object> objects(options.objects);
+	for (uint32_t i = 0; i < options.objects; i++)
+	{
+		const glm::vec3 center(position(random), position(random) * 0.1f, position(random));
+		const glm::vec3 extent(size(random), size(random), size(random));
+		objects[i].bounds = {center - extent * 0.5f, center + extent * 0.5f};
+		objects[i].proxy  = tree.createProxy(sdf::chunks::getObjectBounds(objects[i].bounds), i);
+	}
+
+	constexpr int32_t                     CascadesCount = 4;
+	const float                           distanceExtent = Distance / CascadeScales[CascadesCount - 1];
+	std::vector<sdf::chunks::CascadeData> cascades(CascadesCount);
+	sdf::chunks::ChunkGrid                chunks;
+	std::vector<sdf::chunks::ChunkDispatch> dispatches;
+
+	std::vector<double> frameTimes;
+	uint64_t            rasterized = 0, cleared = 0, deferred = 0, binned = 0;
+	for (uint32_t frame = 0; frame < options.frames; frame++)
+	{
+		const auto begin = clock::now();
+
+		// a few objects move, as the transform system reports them.
+		for (uint32_t i = 0; i < options.moving; i++)
+		{
+			auto &object = objects[random() % objects.size()];
+			sdf::chunks::invalidateChunks(cascades, object.bounds);
+			const glm::vec3 offset(step(random), 0.f, step(random));
+			object.bounds = {object.bounds.min + offset, object.bounds.max + offset};
+			tree.moveProxy(object.proxy, sdf::chunks::getObjectBounds(object.bounds));
+			sdf::chunks::invalidateChunks(cascades, object.bounds);
+		}
+
+		const glm::vec3 view(frame * 0.5f, 0.f, frame * 0.2f);
+		for (int32_t cascadeIndex = 0; cascadeIndex < CascadesCount; cascadeIndex++)
+		{
+			auto &      cascade   = cascades[cascadeIndex];
+			const float extent    = distanceExtent * CascadeScales[cascadeIndex];
+			const float voxelSize = extent * 2 / Resolution;
+			const auto  minChunk  = glm::ivec3(glm::floor(view / (voxelSize * sdf::chunks::ChunkSize))) - ChunksPerAxis / 2;
+			const auto  center    = glm::vec3(minChunk + ChunksPerAxis / 2) * (voxelSize * sdf::chunks::ChunkSize);
+
+			if (frame == 0)
+				sdf::chunks::resetCascade(cascade, minChunk, ChunksPerAxis);
+			else if (cascade.minChunk != minChunk)
+				sdf::chunks::scrollCascade(cascade, minChunk, ChunksPerAxis);
+
+			chunks.reset(ChunksPerAxis, minChunk);
+			cascade.position  = center;
+			cascade.voxelSize = voxelSize;
+			cascade.bounds    = {center - extent, center + extent};
+
+			uint32_t objectIndex = 0;
+			tree.query(cascade.bounds, [&](int32_t proxy) {
+				const auto &         object = objects[tree.getUserData(proxy)];
+				const BoundingSphere sphere = object.bounds;
+				if (cascade.bounds.intersectsWithSphere(sphere))
+				{
+					sdf::chunks::addObjectToChunks(chunks, voxelSize, cascade.bounds, object.bounds, objectIndex++);
+					binned++;
+				}
+				return true;
+			});
+
+			deferred += sdf::chunks::planChunkDispatches(cascade, chunks, ChunksPerAxis, options.budget, dispatches);
+			for (const auto &dispatch : dispatches)
+			{
+				if (dispatch.type == sdf::chunks::ChunkDispatch::Type::Clear)
+					cleared++;
+				else
+					rasterized++;
+			}
+		}
+		frameTimes.emplace_back(milliseconds(begin));
+	}
+
+	std::sort(frameTimes.begin(), frameTimes.end());
+	double total = 0;
+	for (auto time : frameTimes)
+		total += time;
+
+	const auto percentile = [&](double p) { return frameTimes[std::min(frameTimes.size() - 1, size_t(p * frameTimes.size()))]; };
+	printf("%u objects, %u moving, %d cascades of %d^3 chunks, budget %u chunks\n", options.objects, options.moving, CascadesCount, ChunksPerAxis, options.budget);
+	printf("frame ms : mean %.3f, p50 %.3f, p99 %.3f, max %.3f\n", total / frameTimes.size(), percentile(0.5), percentile(0.99), frameTimes.back());
+	printf("per frame : %.1f objects binned, %.1f rasterize, %.1f clear, %.1f deferred dispatches\n",
+	       double(binned) / options.frames, double(rasterized) / options.frames, double(cleared) / options.frames, double(deferred) / options.frames);
+	return 0;
+}
@@ -0,0 +1,342 @@
+//////////////////////////////////////////////////////////////////////////////
+// This file is part of the Maple Engine                              		//
+//////////////////////////////////////////////////////////////////////////////
+#include "Engine/JobSystem.h"
+#include "Others/Console.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+
+/**
+ * JobBenchmark [--threads n] [--jobs n] [--work n]
+ * throughput and submit-to-start latency of the job system against the locked ring buffer it replaced.
+ * JobSystem::init can only run once, so without --threads every worker count is measured in its own process.
+ */
+namespace
+{
+	using namespace maple;
+	using clock = std::chrono::steady_clock;
+
+	// the scheduler before the work stealing queues, kept as a reference.
+	namespace legacy
+	{
+		template <typename T, size_t capacity>
+		class RingBuffer
+		{
+		  public:
+			inline auto push(const T &item) -> bool
+			{
+				std::lock_guard<std::mutex> locker(lock);
+				size_t                      next = (head + 1) % capacity;
+				if (next == tail)
+					return false;
+				data[head] = item;
+				head       = next;
+				return true;
+			}
+
+			inline auto pop(T &item) -> bool
+			{
+				std::lock_guard<std::mutex> locker(lock);
+				if (tail == head)
+					return false;
+				item = data[tail];
+				tail = (tail + 1) % capacity;
+				return true;
+			}
+
+		  private:
+			T          data[capacity];
+			size_t     head = 0;
+			size_t     tail = 0;
+			std::mutex lock;
+		};
+
+		struct Job
+		{
+			JobSystem::Context *                            ctx;
+			std::function<void(JobSystem::JobDispatchArgs)> task;
+			uint32_t                                        groupID;
+			uint32_t                                        groupJobOffset;
+			uint32_t                                        groupJobEnd;
+		};
+
+		class Pool
+		{
+		  public:
+			explicit Pool(uint32_t threadCount)
+			{
+				for (uint32_t i = 0; i < threadCount; i++)
+				{
+					threads.emplace_back([this] {
+						while (!stopped.load())
+						{
+							if (!work())
+							{
+								std::unique_lock<std::mutex> locker(wakeMutex);
+								wakeCondition.wait_for(locker, std::chrono::milliseconds(1));
+							}
+						}
+					});
+				}
+			}
+
+			~Pool()
+			{
+				stopped.store(true);
+				wakeCondition.notify_all();
+				for (auto &thread : threads)
+					thread.join();
+			}
+
+			auto execute(JobSystem::Context &ctx, const std::function<void(JobSystem::JobDispatchArgs)> &task) -> void
+			{
+				dispatch(ctx, 1, 1, task);
+			}
+
+			auto dispatch(JobSystem::Context &ctx, uint32_t jobCount, uint32_t groupSize, const std::function<void(JobSystem::JobDispatchArgs)> &task) -> void
+			{
+				const uint32_t groupCount = JobSystem::dispatchGroupCount(jobCount, groupSize);
+				ctx.counter.fetch_add(groupCount);
+
+				Job job;
+				job.ctx  = &ctx;
+				job.task = task;
+				for (uint32_t groupID = 0; groupID < groupCount; ++groupID)
+				{
+					job.groupID        = groupID;
+					job.groupJobOffset = groupID * groupSize;
+					job.groupJobEnd    = std::min(job.groupJobOffset + groupSize, jobCount);
+					while (!jobQueue.push(job))
+					{
+						wakeCondition.notify_all();
+						work();
+					}
+					wakeCondition.notify_one();
+				}
+			}
+
+			auto wait(const JobSystem::Context &ctx) -> void
+			{
+				wakeCondition.notify_all();
+				while (JobSystem::isBusy(ctx))
+				{
+					if (!work())
+						std::this_thread::yield();
+				}
+			}
+
+		  private:
+			auto work() -> bool
+			{
+				Job job;
+				if (!jobQueue.pop(job))
+					return false;
+
+				JobSystem::JobDispatchArgs args;
+				args.groupID      = job.groupID;
+				args.sharedMemory = nullptr;
+				for (uint32_t i = job.groupJobOffset; i < job.groupJobEnd; ++i)
+				{
+					args.jobIndex          = i;
+					args.groupIndex        = i - job.groupJobOffset;
+					args.isFirstJobInGroup = (i == job.groupJobOffset);
+					args.isLastJobInGroup  = (i == job.groupJobEnd - 1);
+					job.task(args);
+				}
+				job.ctx->counter.fetch_sub(1);
+				return true;
+			}
+
+			RingBuffer<Job, 256>     jobQueue;
+			std::condition_variable  wakeCondition;
+			std::mutex               wakeMutex;
+			std::atomic<bool>        stopped{false};
+			std::vector<std::thread> threads;
+		};
+	}        // namespace legacy
+
+	struct Current
+	{
+		auto execute(JobSystem::Context &ctx, const std::function<void(JobSystem::JobDispatchArgs)> &task) -> void
+		{
+			JobSystem::execute(ctx, task);
+		}
+
+		template <typename Task>
+		auto dispatch(JobSystem::Context &ctx, uint32_t jobCount, uint32_t groupSize, Task &&task) -> void
+		{
+			JobSystem::dispatch(ctx, jobCount, groupSize, std::forward<Task>(task));
+		}
+
+		auto wait(const JobSystem::Context &ctx) -> void
+		{
+			JobSystem::wait(ctx);
+		}
+	};
+
+	struct Options
+	{
+		int32_t  threads = -1;
+		uint32_t jobs    = 100000;
+		uint32_t work    = 256;        //spin iterations per job
+	};
+
+	inline auto spin(uint32_t iterations)
+	{
+		volatile uint32_t sink = 0;
+		for (uint32_t i = 0; i < iterations; i++)
+			sink = sink + i;
+	}
+
+	inline auto nanoseconds(clock::time_point begin, clock::time_point end) -> int64_t
+	{
+		return std::chrono::duration_cast<std::chrono::nanoseconds>(end - begin).count();
+	}
+
+	auto report(const char *scheduler, const char *test, uint32_t threads, uint32_t jobs, int64_t elapsed, std::vector<int64_t> &latency)
+	{
+		auto percentile = [&](double p) {
+			if (latency.empty())
+				return 0.0;
+			auto index = std::min(latency.size() - 1, size_t(p * latency.size()));
+			std::nth_element(latency.begin(), latency.begin() + index, latency.end());
+			return latency[index] / 1000.0;
+		};
+
+		const double jobsPerSecond = elapsed > 0 ? jobs * 1e9 / elapsed : 0;
+		if (latency.empty())
+			printf("%-8s %-9s %7u %14.0f %10s %10s %10s %10s\n", scheduler, test, threads, jobsPerSecond, "-", "-", "-", "-");
+		else
+			printf("%-8s %-9s %7u %14.0f %10.2f %10.2f %10.2f %10.2f\n", scheduler, test, threads, jobsPerSecond,
+			       percentile(0.5), percentile(0.99), percentile(0.999), percentile(1.0));
+		fflush(stdout);
+	}
+
+	// single jobs submitted one by one, the latency is the time from execute to the job starting.
+	template <typename Scheduler>
+	auto benchExecute(Scheduler &scheduler, const char *name, uint32_t threads, const Options &options)
+	{
+		std::vector<int64_t> latency(options.jobs);
+		JobSystem::Context   ctx;
+		const auto           begin = clock::now();
+		for (uint32_t i = 0; i < options.jobs; i++)
+		{
+			const auto submitted = clock::now();
+			scheduler.execute(ctx, [&latency, i, submitted, work = options.work](JobSystem::JobDispatchArgs) {
+				latency[i] = nanoseconds(submitted, clock::now());
+				spin(work);
+			});
+		}
+		scheduler.wait(ctx);
+		report(name, "execute", threads, options.jobs, nanoseconds(begin, clock::now()), latency);
+	}
+
+	// frame-like bursts of parallel-for, the latency is the time from dispatch to each job starting.
+	template <typename Scheduler>
+	auto benchDispatch(Scheduler &scheduler, const char *name, uint32_t threads, const Options &options)
+	{
+		constexpr uint32_t   BurstSize = 1024;
+		const uint32_t       bursts    = std::max(1u, options.jobs / BurstSize);
+		std::vector<int64_t> latency(size_t(bursts) * BurstSize);
+		const auto           begin = clock::now();
+		for (uint32_t burst = 0; burst < bursts; burst++)
+		{
+			JobSystem::Context ctx;
+			const auto         submitted = clock::now();
+			auto *             out       = latency.data() + size_t(burst) * BurstSize;
+			scheduler.dispatch(ctx, BurstSize, 1, [out, submitted, work = options.work](JobSystem::JobDispatchArgs args) {
+				out[args.jobIndex] = nanoseconds(submitted, clock::now());
+				spin(work);
+			});
+			scheduler.wait(ctx);
+		}
+		report(name, "dispatch", threads, bursts * BurstSize, nanoseconds(begin, clock::now()), latency);
+	}
+
+	// jobs spawning jobs, every root submits its children from a worker thread.
+	template <typename Scheduler>
+	auto benchNested(Scheduler &scheduler, const char *name, uint32_t threads, const Options &options)
+	{
+		constexpr uint32_t Children = 64;
+		const uint32_t     roots    = std::max(1u, options.jobs / Children);
+		JobSystem::Context ctx;
+		const auto         begin = clock::now();
+		scheduler.dispatch(ctx, roots, 1, [&scheduler, &ctx, work = options.work](JobSystem::JobDispatchArgs) {
+			scheduler.dispatch(ctx, Children, 1, [work](JobSystem::JobDispatchArgs) {
+				spin(work);
+			});
+		});
+		scheduler.wait(ctx);
+		std::vector<int64_t> latency;
+		report(name, "nested", threads, roots * Children, nanoseconds(begin, clock::now()), latency);
+	}
+
+	auto run(const Options &options)
+	{
+		Console::init();
+		JobSystem::init(options.threads);
+		const auto threads = JobSystem::getThreadCount();
+		if (threads != uint32_t(options.threads))
+		{
+			printf("%-8s %-9s %7d skipped, only %u workers available\n", "-", "-", options.threads, threads);
+			return;
+		}
+
+		{
+			legacy::Pool pool(threads);
+			benchExecute(pool, "ring", threads, options);
+			benchDispatch(pool, "ring", threads, options);
+			benchNested(pool, "ring", threads, options);
+		}
+
+		Current current;
+		benchExecute(current, "stealing", threads, options);
+		benchDispatch(current, "stealing", threads, options);
+		benchNested(current, "stealing", threads, options);
+	}
+}        // namespace
+
+int main(int argc, char **argv)
+{
+	Options options;
+	for (int32_t i = 1; i + 1 < argc; i += 2)
+	{
+		if (strcmp(argv[i], "--threads") == 0)
+			options.threads = atoi(argv[i + 1]);
+		else if (strcmp(argv[i], "--jobs") == 0)
+			options.jobs = std::max(1, atoi(argv[i + 1]));
+		else if (strcmp(argv[i], "--work") == 0)
+			options.work = std::max(0, atoi(argv[i + 1]));
+		else
+		{
+			printf("usage : JobBenchmark [--threads n] [--jobs n] [--work n]\n");
+			return 2;
+		}
+	}
+
+	if (options.threads > 0)
+	{
+		run(options);
+		// the job system workers never stop, leave before the static destructors pull the queues from under them.
+		fflush(stdout);
+		std::_Exit(0);
+	}
+
+	printf("%-8s %-9s %7s %14s %10s %10s %10s %10s\n", "queue", "test", "threads", "jobs/s", "p50 us", "p99 us", "p99.9 us", "max us");
+	fflush(stdout);
+	for (int32_t threads : {1, 2, 4, 8, 16, 32, 64})
+	{
+		const auto command = "\"" + std::string(argv[0]) + "\" --threads " + std::to_string(threads) +
+		                     " --jobs " + std::to_string(options.jobs) + " --work " + std::to_string(options.work);
+		if (std::system(command.c_str()) != 0)
+			return 1;
+	}
+	return 0;
+}
@@ -0,0 +1,189 @@
+//////////////////////////////////////////////////////////////////////////////
+// This file is part of the Maple Engine                              		//
+//////////////////////////////////////////////////////////////////////////////
+#include "Engine/DDGI/MeshDistanceField.h"
+#include "Engine/DDGI/SDFBaker.h"
+#include "Engine/DDGI/SDFCache.h"
+#include "Engine/JobSystem.h"
+#include "Engine/Mesh.h"
+#include "IO/Loader.h"
+#include "IO/MeshResource.h"
+#include "Others/Console.h"
+#include "Others/StringUtils.h"
+#include "Others/Timer.h"
+
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace
+{
+	struct BakeItem
+	{
+		std::string                 file;
+		std::shared_ptr<maple::Mesh> mesh;
+	};
+
+	auto usage() -> int
+	{
+		printf("usage : SDFBake [options] <model | directory>...\n"
+		       "  --root <dir>              asset root, baked fields go to <dir>/sdf (default: working directory)\n"
+		       "  --threads <n>             worker threads (default: all cores)\n"
+		       "  --max-resolution <n>      largest volume dimension (default 128)\n"
+		       "  --min-resolution <n>      smallest volume dimension (default 32)\n"
+		       "  --texel-per-meter <f>     see SDFBakerConfig::targetTexelPerMeter (default 3)\n"
+		       "  --brick-band <f>          also store narrow band bricks (default 0, off)\n"
+		       "  --mip-floor <n>           smallest mip dimension (default 8)\n"
+		       "  --ray-vote <samples>      rays per axis when voting the sign (default 4)\n"
+		       "  --winding-number          determine the sign by the winding number instead of ray voting\n");
+		return 2;
+	}
+}        // namespace
+
+/**
+ * SDFBake [options] <model | directory>...
+ * bakes the mesh distance fields of every supported model (obj, gltf, fbx ...) into the sdf cache
+ * without a graphics context, so assets can be pre-baked on machines without a gpu.
+ * the output is the same cache the engine reads at runtime : sdf/<key>.sdf and sdf/manifest.json.
+ * the io loaders build engine meshes and materials, so the tool links MapleEngine and is only built on windows.
+ */
+int main(int argc, char **argv)
+{
+	using namespace maple;
+
+	sdf::baker::SDFBakerConfig config;
+	std::string                root;
+	uint32_t                   threads = std::max(std::thread::hardware_concurrency(), 1u);
+	std::vector<std::string>   inputs;
+
+	for (int32_t i = 1; i < argc; i++)
+	{
+		const std::string arg   = argv[i];
+		const bool        value = i + 1 < argc;
+
+		if (arg == "--root" && value)
+			root = argv[++i];
+		else if (arg == "--threads" && value)
+			threads = std::max(std::atoi(argv[++i]), 1);
+		else if (arg == "--max-resolution" && value)
+			config.maxResolution = std::atoi(argv[++i]);
+		else if (arg == "--min-resolution" && value)
+			config.minResolution = std::atoi(argv[++i]);
+		else if (arg == "--texel-per-meter" && value)
+			config.targetTexelPerMeter = std::atof(argv[++i]);
+		else if (arg == "--brick-band" && value)
+			config.brickBand = std::atof(argv[++i]);
+		else if (arg == "--mip-floor" && value)
+			config.mipFloor = std::atoi(argv[++i]);
+		else if (arg == "--ray-vote" && value)
+		{
+			config.signMethod  = sdf::baker::SignMethod::RayVote;
+			config.sampleCount = std::atoi(argv[++i]);
+		}
+		else if (arg == "--winding-number")
+			config.signMethod = sdf::baker::SignMethod::WindingNumber;
+		else if (arg.rfind("--", 0) == 0)
+			return usage();
+		else
+			inputs.emplace_back(arg);
+	}
+
+	if (inputs.empty())
+		return usage();
+
+	Console::init();
+	JobSystem::init(threads);
+	io::init();
+	io::setHeadless(true);
+
+	// inputs are resolved before moving to the asset root, the cache paths are relative to it.
+	std::vector<std::string> files;
+	const auto &             extensions = io::getSupportExtensions();
+	for (auto &input : inputs)
+	{
+		std::error_code error;
+		const auto      path = std::filesystem::absolute(input, error);
+		if (std::filesystem::is_directory(path, error))
+		{
+			for (auto &entry : std::filesystem::recursive_directory_iterator(path, error))
+			{
+				if (entry.is_regular_file() && extensions.count(StringUtils::getExtension(entry.path().string())) != 0)
+					files.emplace_back(entry.path().string());
+			}
+		}
+		else
+		{
+			files.emplace_back(path.string());
+		}
+	}
+
+	if (!root.empty())
+	{
+		std::error_code error;
+		std::filesystem::current_path(root, error);
+		if (error)
+		{
+			LOGE("can not use {} as asset root : {}", root, error.message());
+			return 1;
+		}
+	}
+
+	// loaders are not thread safe, only the bakes run in parallel.
+	std::vector<BakeItem> items;
+	uint32_t              failed = 0;
+	for (auto &file : files)
+	{
+		try
+		{
+			for (auto &resource : io::load(file))
+			{
+				if (auto meshes = std::dynamic_pointer_cast<MeshResource>(resource))
+				{
+					for (auto &mesh : meshes->getMeshes())
+					{
+						if (mesh.second != nullptr && !mesh.second->getIndex().empty())
+							items.push_back({file, mesh.second});
+					}
+				}
+			}
+		}
+		catch (const std::exception &e)
+		{
+			LOGE("failed to load {} : {}", file, e.what());
+			failed++;
+		}
+	}
+
+	LOGI("baking {} meshes from {} files on {} threads", items.size(), files.size(), JobSystem::getThreadCount());
+
+	Timer                 timer;
+	std::atomic<uint32_t> baked{0};
+	std::atomic<uint32_t> errors{0};
+
+	JobSystem::Context context;
+	JobSystem::dispatch(context, static_cast<uint32_t>(items.size()), 1, [&](JobSystem::JobDispatchArgs args) {
+		auto &item = items[args.jobIndex];
+
+		sdf::component::MeshDistanceField field;
+		if (sdf::baker::bake(sdf::baker::makeGeometry(item.mesh->getName(), item.mesh->getVertex(), item.mesh->getIndex()), config, field))
+		{
+			LOGI("[{}/{}] {} : {} -> {}", ++baked, items.size(), item.file, item.mesh->getName(), field.bakedPath);
+		}
+		else
+		{
+			LOGE("failed to bake {} : {}", item.file, item.mesh->getName());
+			errors++;
+		}
+	});
+	JobSystem::wait(context);
+
+	sdf::cache::save();
+
+	LOGI("baked {} meshes in {} ms, {} failed", baked.load(), timer.stop() / 1000.f, failed + errors.load());
+	return failed + errors.load() == 0 ? 0 : 1;
+}
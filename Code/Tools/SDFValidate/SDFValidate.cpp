@@ -0,0 +1,64 @@
+//////////////////////////////////////////////////////////////////////////////
+// This file is part of the Maple Engine                              		//
+//////////////////////////////////////////////////////////////////////////////
+#include "Engine/DDGI/SDFContainer.h"
+
+#include <cstdio>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+/**
+ * SDFValidate <file.sdf | directory>...
+ * checks every baked mesh distance field against the container layout, exits with 1 if any is broken.
+ */
+int main(int argc, char **argv)
+{
+	using namespace maple::sdf;
+
+	if (argc < 2)
+	{
+		printf("usage : SDFValidate <file.sdf | directory>...\n");
+		return 2;
+	}
+
+	std::vector<std::string> files;
+	for (int32_t i = 1; i < argc; i++)
+	{
+		std::error_code error;
+		if (std::filesystem::is_directory(argv[i], error))
+		{
+			for (auto &entry : std::filesystem::recursive_directory_iterator(argv[i], error))
+			{
+				if (entry.is_regular_file() && entry.path().extension() == ".sdf")
+					files.emplace_back(entry.path().string());
+			}
+		}
+		else
+		{
+			files.emplace_back(argv[i]);
+		}
+	}
+
+	uint32_t broken = 0;
+	for (auto &file : files)
+	{
+		container::MappedFile mapped;
+		std::string           error;
+		if (!mapped.open(file, error))
+		{
+			printf("FAIL %s : %s\n", file.c_str(), error.c_str());
+			broken++;
+			continue;
+		}
+
+		const auto &header = mapped.getHeader();
+		printf("OK   %s : %ux%ux%u, %u mips, max distance %f", file.c_str(), header.width, header.height, header.depth, header.mipCount, header.maxDistance);
+		if (mapped.hasBricks())
+			printf(", mip0 in %llu bricks, band %f", (unsigned long long) (header.sparse.brickSize / (bricks::BrickVoxels * sizeof(uint16_t))), header.sparse.band);
+		printf("\n");
+	}
+
+	printf("%zu files, %u broken\n", files.size(), broken);
+	return broken == 0 ? 0 : 1;
+}